@@ -0,0 +1,79 @@
+// ActivationArena.cpp
+
+#include "ActivationArena.h"
+#include <new>
+
+namespace hint_map {
+
+    ActivationArena::ActivationArena(size_t chunkBytes) : chunkBytes(chunkBytes ? chunkBytes : 4096) {}
+
+    ActivationArena::~ActivationArena() {
+        ReleaseChunks();
+    }
+
+    void ActivationArena::ReleaseChunks() {
+        for (const Chunk& c : chunks) ::operator delete(c.data);
+        chunks.clear();
+        current = 0;
+        offset = 0;
+        stats.capacity = 0;
+    }
+
+    uint8_t* ActivationArena::AllocateFrom(size_t chunk, size_t bytes, size_t alignment) {
+        const Chunk& c = chunks[chunk];
+        const size_t start = chunk == current ? offset : 0;
+        const uintptr_t base = (uintptr_t)c.data;
+        const uintptr_t aligned = (base + start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        const size_t used = (size_t)(aligned - base);
+        if (used > c.size || c.size - used < bytes) return nullptr;
+
+        stats.bytesInUse += (used - start) + bytes;
+        current = chunk;
+        offset = used + bytes;
+        return reinterpret_cast<uint8_t*>(aligned);
+    }
+
+    void* ActivationArena::Allocate(size_t bytes, size_t alignment) {
+        if (alignment == 0 || (alignment & (alignment - 1))) alignment = alignof(std::max_align_t);
+        if (bytes == 0) bytes = 1;
+        ++stats.allocations;
+
+        // The current chunk, then any later ones left over from a bigger activation
+        for (size_t k = current; k < chunks.size(); ++k) {
+            if (uint8_t* p = AllocateFrom(k, bytes, alignment)) return p;
+        }
+
+        // operator new's memory is aligned for max_align_t; ask for slack beyond that
+        const size_t slack = alignment > alignof(std::max_align_t) ? alignment : 0;
+        Chunk chunk;
+        chunk.size = bytes + slack > chunkBytes ? bytes + slack : chunkBytes;
+        chunk.data = static_cast<uint8_t*>(::operator new(chunk.size));
+        chunks.push_back(chunk);
+        ++stats.heapAllocations;
+        stats.capacity += chunk.size;
+        return AllocateFrom(chunks.size() - 1, bytes, alignment);
+    }
+
+    void ActivationArena::Reset() {
+        if (stats.bytesInUse > stats.peakBytes) stats.peakBytes = stats.bytesInUse;
+
+        // Several chunks: replace them with one that holds them all, so the next activation
+        // of this size fits without going back to the heap
+        if (chunks.size() > 1) {
+            const size_t total = stats.capacity;
+            ReleaseChunks();
+            Chunk chunk;
+            chunk.size = total;
+            chunk.data = static_cast<uint8_t*>(::operator new(total));
+            chunks.push_back(chunk);
+            stats.capacity = total;
+        }
+
+        current = 0;
+        offset = 0;
+        stats.allocations = 0;
+        stats.bytesInUse = 0;
+        stats.heapAllocations = 0;
+    }
+
+}
@@ -0,0 +1,93 @@
+// ActivationArena.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hint_map {
+
+    // Monotonic arena for data that lives exactly as long as one hint activation. Allocation
+    // bumps a pointer; nothing is freed until Reset, which drops everything at once. Reset
+    // keeps the memory, merging chunks into one, so once an activation of a given size has
+    // run, the next one takes nothing from the general heap.
+    class ActivationArena {
+    public:
+        struct Stats {
+            size_t allocations = 0;         // since the last Reset
+            size_t bytesInUse = 0;          // since the last Reset, including alignment
+            size_t peakBytes = 0;           // highest bytesInUse seen at any Reset
+            size_t heapAllocations = 0;     // chunks taken from the heap since the last Reset
+            size_t capacity = 0;            // bytes held in chunks
+        };
+
+        explicit ActivationArena(size_t chunkBytes = 64 * 1024);
+        ~ActivationArena();
+
+        ActivationArena(const ActivationArena&) = delete;
+        ActivationArena& operator=(const ActivationArena&) = delete;
+
+        void* Allocate(size_t bytes, size_t alignment);
+        // Invalidates everything allocated so far; callers must drop their pointers first
+        void Reset();
+
+        const Stats& GetStats() const { return stats; }
+
+    private:
+        struct Chunk {
+            uint8_t* data;
+            size_t size;
+        };
+
+        uint8_t* AllocateFrom(size_t chunk, size_t bytes, size_t alignment);
+        void ReleaseChunks();
+
+        std::vector<Chunk> chunks;
+        size_t current = 0;                 // chunk being filled
+        size_t offset = 0;                  // bytes used in it
+        size_t chunkBytes;
+        Stats stats;
+    };
+
+    // std allocator over an ActivationArena; deallocate is a no-op. Containers using it must
+    // be emptied with a swap (not clear, which keeps the buffer) before the arena resets.
+    template <typename T>
+    class ArenaAllocator {
+    public:
+        typedef T value_type;
+
+        explicit ArenaAllocator(ActivationArena& arena) : arena(&arena) {}
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.Arena()) {}
+
+        T* allocate(size_t n) { return static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T))); }
+        void deallocate(T*, size_t) {}
+
+        ActivationArena* Arena() const { return arena; }
+
+    private:
+        ActivationArena* arena;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.Arena() == b.Arena(); }
+    template <typename T, typename U>
+    bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.Arena() != b.Arena(); }
+
+    template <typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+    using ArenaWString = std::basic_string<wchar_t, std::char_traits<wchar_t>, ArenaAllocator<wchar_t>>;
+
+    // Gives back v's buffer (to the arena, i.e. nowhere) so the arena can be reset
+    template <typename T>
+    void ReleaseArenaVector(ArenaVector<T>& v) {
+        ArenaVector<T>(v.get_allocator()).swap(v);
+    }
+
+    inline void ReleaseArenaString(ArenaWString& s) {
+        ArenaWString(s.get_allocator()).swap(s);
+    }
+
+}
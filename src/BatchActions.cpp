@@ -0,0 +1,160 @@
+// BatchActions.cpp
+
+#include "BatchActions.h"
+#include <UIAutomation.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "InputBatch.h"
+#include "ScanWorker.h"
+#include "TrayIcon.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace hint_map {
+
+    static std::thread batchThread;
+    static std::mutex batchMutex;
+    static std::condition_variable batchReady;
+    struct Batch {
+        HWND window = nullptr;
+        std::vector<BatchAction> actions;
+    };
+
+    static std::deque<Batch> pendingBatches;    // guarded by batchMutex
+    static bool batchStopping = false;          // guarded by batchMutex
+    static ComPtr<IUIAutomation> batchAutomation;   // worker thread (or the caller, with no worker)
+
+    // The pattern that fits the element: a checkbox toggles, an item joins the selection
+    // (or replaces it in a single-select container), anything else is invoked
+    static HRESULT RunAction(const BatchAction& action, IUIAutomationElement* root) {
+        ComPtr<IUIAutomationElement> element = action.element;
+        if (!element && !action.runtimeId.empty()) {
+            element = FindElementByRuntimeId(batchAutomation.Get(), root, action.runtimeId);
+            if (!element) return UIA_E_ELEMENTNOTAVAILABLE;
+        }
+        if (!element) {
+            const bool sent = shortcut::InputBatch().ClickAt((action.rect.left + action.rect.right) / 2,
+                (action.rect.top + action.rect.bottom) / 2).Send();
+            return sent ? S_OK : E_FAIL;
+        }
+
+        ComPtr<IUIAutomationTogglePattern> toggle;
+        if (SUCCEEDED(element->GetCurrentPatternAs(UIA_TogglePatternId, IID_PPV_ARGS(&toggle))) && toggle) {
+            return toggle->Toggle();
+        }
+
+        ComPtr<IUIAutomationSelectionItemPattern> item;
+        if (SUCCEEDED(element->GetCurrentPatternAs(UIA_SelectionItemPatternId, IID_PPV_ARGS(&item))) && item) {
+            HRESULT hr = item->AddToSelection();
+            return SUCCEEDED(hr) ? hr : item->Select();
+        }
+
+        ComPtr<IUIAutomationInvokePattern> invoke;
+        if (SUCCEEDED(element->GetCurrentPatternAs(UIA_InvokePatternId, IID_PPV_ARGS(&invoke))) && invoke) {
+            return invoke->Invoke();
+        }
+
+        ComPtr<IUIAutomationLegacyIAccessiblePattern> legacy;
+        if (SUCCEEDED(element->GetCurrentPatternAs(UIA_LegacyIAccessiblePatternId, IID_PPV_ARGS(&legacy))) && legacy) {
+            return legacy->DoDefaultAction();
+        }
+        return E_NOINTERFACE;
+    }
+
+    static void RunBatch(const Batch& batch) {
+        const auto start = std::chrono::steady_clock::now();
+        int failed = 0;
+        std::wstring firstFailure;
+
+        // One root for every runtime id lookup in the batch
+        ComPtr<IUIAutomationElement> root;
+        if (!batchAutomation) {
+            CoCreateInstance(__uuidof(CUIAutomation), nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&batchAutomation));
+        }
+        if (batchAutomation && batch.window) batchAutomation->ElementFromHandle(batch.window, &root);
+
+        for (const BatchAction& action : batch.actions) {
+            const HRESULT hr = RunAction(action, root.Get());
+            if (SUCCEEDED(hr)) continue;
+            if (!failed) firstFailure = action.name.empty() ? L"(unnamed)" : action.name;
+            ++failed;
+            wchar_t buf[256];
+            swprintf_s(buf, L"[hint_map] Batch: \"%.120s\" failed (0x%08X).\n", action.name.c_str(), (unsigned)hr);
+            OutputDebugString(buf);
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        wchar_t buf[128];
+        swprintf_s(buf, L"[hint_map] Batch: %zu actions, %d failed, %.1f ms.\n", batch.actions.size(), failed, ms);
+        OutputDebugString(buf);
+
+        if (failed) {
+            wchar_t text[256];
+            swprintf_s(text, L"%d of %zu actions failed, starting with \"%.80s\".", failed, batch.actions.size(), firstFailure.c_str());
+            ShowTrayNotification(L"Multi-select", text);
+        }
+    }
+
+    static void BatchThreadMain() {
+        // Elements from the UI thread's scan are MTA objects; use them from the MTA here
+        const bool comInitialized = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+        if (!comInitialized) OutputDebugStringW(L"[hint_map] CoInitializeEx failed in batch worker\n");
+
+        for (;;) {
+            Batch batch;
+            {
+                std::unique_lock<std::mutex> lock(batchMutex);
+                batchReady.wait(lock, []() { return batchStopping || !pendingBatches.empty(); });
+                if (batchStopping) break;
+                batch = std::move(pendingBatches.front());
+                pendingBatches.pop_front();
+            }
+            RunBatch(batch);
+        }
+
+        // Whatever wasn't run still holds element references; release them on this apartment
+        {
+            std::lock_guard<std::mutex> lock(batchMutex);
+            pendingBatches.clear();
+        }
+        batchAutomation.Reset();
+        if (comInitialized) CoUninitialize();
+    }
+
+    void StartBatchWorker() {
+        if (batchThread.joinable()) return;
+        batchStopping = false;
+        batchThread = std::thread(BatchThreadMain);
+    }
+
+    void StopBatchWorker() {
+        if (!batchThread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(batchMutex);
+            batchStopping = true;
+        }
+        batchReady.notify_one();
+        batchThread.join();
+    }
+
+    void RunBatchActions(HWND window, std::vector<BatchAction> actions) {
+        if (actions.empty()) return;
+        Batch batch;
+        batch.window = window;
+        batch.actions = std::move(actions);
+        if (!batchThread.joinable()) {
+            // Not started (or already stopped): run here rather than drop the batch
+            RunBatch(batch);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(batchMutex);
+            pendingBatches.push_back(std::move(batch));
+        }
+        batchReady.notify_one();
+    }
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Windows.h>
+#include <UIAutomationClient.h>
+#include <wrl/client.h>
+#include <string>
+#include <vector>
+
+namespace hint_map {
+
+    // One queued pick from multi-select mode, copied out of the hint snapshot
+    struct BatchAction {
+        Microsoft::WRL::ComPtr<IUIAutomationElement> element;   // null: found by runtimeId, else click rect
+        std::vector<int> runtimeId;                             // for targets from the scan worker
+        RECT rect = {};
+        std::wstring name;                                      // for the failure report
+    };
+
+    // Worker thread that runs batches off the UI thread, so the overlay closes as soon as
+    // the batch is handed over instead of after N cross-process calls
+    void StartBatchWorker();
+    void StopBatchWorker();
+
+    // Queues the actions to run in order: toggle checkboxes, add list/tree items to the
+    // selection, invoke the rest. Elements given by runtime id are looked up under window
+    // on the worker. A failed action is logged and counted in a tray notification at the
+    // end; the rest of the batch still runs.
+    void RunBatchActions(HWND window, std::vector<BatchAction> actions);
+
+}
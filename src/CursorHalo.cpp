@@ -1,8 +1,9 @@
 #include <windows.h>
-#include <ShellScalingApi.h>
-#include <math.h>
+#include <limits.h>
+#include <map>
+#include "CursorHalo.h"
+#include "MonitorCache.h"
 
-#pragma comment(lib, "Shcore.lib")
 
 // ============================================================
 // Globals
@@ -10,49 +11,137 @@
 
 static HWND   haloHwnd = nullptr;
 static HDC    haloDC = nullptr;
-static HBITMAP haloBmp = nullptr;
+static HGDIOBJ haloDCDefaultBmp = nullptr;
 
 static const UINT BASE_SIZE = 36;   // halo diameter
-static const float HALO_ALPHA = 0.8f;
+static const DWORD PULSE_PERIOD_MS = 1200;
+
+static HaloStyle haloStyle = HaloStyle::Glow;
+
+// Sprite sheets keyed by halo size. The size only changes with the DPI of the
+// monitor under the cursor, so in practice this holds one or two entries.
+static std::map<UINT, HBITMAP> haloSheets;
+
+// What the layered window currently shows, so frames that only move skip the blend
+static UINT  shownSize = 0;
+static int   shownFrame = -1;
+static POINT shownPos = { LONG_MIN, LONG_MIN };
+
+// Monitor under the cursor at the last frame, with its DPI scale and refresh interval.
+// Only looked up again when the cursor crosses to another monitor or the topology changes.
+static const hint_map::MonitorTopology* cachedTopology = nullptr;
+static int      cachedMonitor = -1;
+static float    cachedScale = 1.0f;
+static LONGLONG frameIntervalQpc = 0;
+
+// Frame pacing: mouse movement arrives as WM_INPUT, a frame is presented at most once
+// per refresh interval, and a one-shot timer picks up the trailing movement.
+static const UINT_PTR FRAME_TIMER = 1;
+static const UINT_PTR PULSE_TIMER = 2;
+static bool     framePending = false;
+static LONGLONG lastPresentQpc = 0;
+static LONGLONG oldestMoveQpc = 0;     // first movement not yet on screen, 0 if none
+static POINT    presentedCursor = { LONG_MIN, LONG_MIN };  // cursor position at the last present
+
+// Metrics over a rolling one-second window
+static LONGLONG metricsWindowStart = 0;
+static unsigned windowWakeups = 0;
+static unsigned windowFrames = 0;
+static double   windowLagSumMs = 0.0;
+static double   windowLagMaxMs = 0.0;
+static CursorHaloMetrics lastMetrics;
 
 // ============================================================
 // Helpers
 // ============================================================
 
-static float GetCursorScale()
+static LONGLONG QpcNow()
 {
-    POINT pt;
-    GetCursorPos(&pt);
-
-    HMONITOR mon = MonitorFromPoint(pt, MONITOR_DEFAULTTONEAREST);
-    UINT dpiX = 96, dpiY = 96;
-    GetDpiForMonitor(mon, MDT_EFFECTIVE_DPI, &dpiX, &dpiY);
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return t.QuadPart;
+}
 
-    return dpiX / 96.0f;
+static LONGLONG QpcFrequency()
+{
+    static LONGLONG freq = 0;
+    if (!freq) {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        freq = f.QuadPart;
+    }
+    return freq;
 }
 
-static void CleanupBitmap()
+static float GetCursorScale(POINT pt)
 {
-    if (haloBmp) {
-        DeleteObject(haloBmp);
-        haloBmp = nullptr;
+    const hint_map::MonitorTopology& topology = hint_map::CurrentMonitorTopology();
+    int mon = topology.FindNearestMonitor(pt.x, pt.y);
+    if (&topology == cachedTopology && mon == cachedMonitor)
+        return cachedScale;
+
+    cachedTopology = &topology;
+    cachedMonitor = mon;
+
+    // Pace frames to the refresh rate of the monitor the cursor is on
+    unsigned hz = 60;
+    cachedScale = 1.0f;
+    if (mon >= 0) {
+        cachedScale = topology.Monitors()[mon].Scale();
+        hz = topology.Monitors()[mon].refreshHz;
     }
+    frameIntervalQpc = QpcFrequency() / hz;
+
+    return cachedScale;
 }
 
 // ============================================================
-// Halo Rendering (REAL TRANSPARENCY)
+// Metrics
 // ============================================================
 
-static void DrawHaloBitmap(UINT size)
+static void RollMetrics(LONGLONG now)
 {
-    CleanupBitmap();
+    if (!metricsWindowStart) {
+        metricsWindowStart = now;
+        return;
+    }
 
-    if (!haloDC)
-        haloDC = CreateCompatibleDC(nullptr);
+    LONGLONG elapsed = now - metricsWindowStart;
+    if (elapsed < QpcFrequency())
+        return;
+
+    double seconds = (double)elapsed / QpcFrequency();
+    lastMetrics.wakeupsPerSecond = windowWakeups / seconds;
+    lastMetrics.framesPerSecond = windowFrames / seconds;
+    lastMetrics.avgLagMs = windowFrames ? windowLagSumMs / windowFrames : 0.0;
+    lastMetrics.maxLagMs = windowLagMaxMs;
+
+    metricsWindowStart = now;
+    windowWakeups = 0;
+    windowFrames = 0;
+    windowLagSumMs = 0.0;
+    windowLagMaxMs = 0.0;
+}
+
+static void CountWakeup()
+{
+    RollMetrics(QpcNow());
+    windowWakeups++;
+}
+
+// ============================================================
+// Halo Sprite Sheets (REAL TRANSPARENCY)
+// ============================================================
+
+static HBITMAP GetHaloSheet(UINT size)
+{
+    auto it = haloSheets.find(size);
+    if (it != haloSheets.end())
+        return it->second;
 
     BITMAPINFO bmi = {};
     bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = size;
+    bmi.bmiHeader.biWidth = size * HALO_SHEET_FRAMES;
     bmi.bmiHeader.biHeight = -((LONG)size); // top-down
     bmi.bmiHeader.biPlanes = 1;
     bmi.bmiHeader.biBitCount = 32;
@@ -60,8 +149,8 @@ static void DrawHaloBitmap(UINT size)
 
     void* bits = nullptr;
 
-    haloBmp = CreateDIBSection(
-        haloDC,
+    HBITMAP sheet = CreateDIBSection(
+        nullptr,
         &bmi,
         DIB_RGB_COLORS,
         &bits,
@@ -69,47 +158,52 @@ static void DrawHaloBitmap(UINT size)
         0
     );
 
-    SelectObject(haloDC, haloBmp);
-    ZeroMemory(bits, size * size * 4);
-
-    float cx = size / 2.0f;
-    float cy = size / 2.0f;
-    float radius = size * 0.35f;
-
-    for (UINT y = 0; y < size; y++) {
-        for (UINT x = 0; x < size; x++) {
+    if (!sheet || !bits)
+        return nullptr;
 
-            float dx = x - cx;
-            float dy = y - cy;
-            float dist = sqrtf(dx * dx + dy * dy);
+    // Premultiplied BGRA, every style and animation frame side by side
+    RenderHaloSpriteSheet((uint32_t*)bits, (int)size);
 
-            if (dist > radius)
-                continue;
-
-            float t = 1.0f - (dist / radius);
-            BYTE a = (BYTE)(255 * t * HALO_ALPHA);
-
-            UINT32* px = (UINT32*)bits + (y * size + x);
-            *px =
-                (a << 24) |   // A
-                (255 << 16) | // R
-                (40 << 8) | // G
-                (40);         // B
-        }
-    }
+    haloSheets[size] = sheet;
+    return sheet;
 }
 
-static void UpdateHaloWindow(HWND hwnd, POINT pt, UINT size)
+static int CurrentHaloFrame()
 {
-    DrawHaloBitmap(size);
+    DWORD frameMs = PULSE_PERIOD_MS / HALO_PULSE_FRAMES;
+    return HaloFrameIndex(haloStyle, (int)(GetTickCount() / frameMs));
+}
 
-    SIZE wndSize = { (LONG)size, (LONG)size };
-    POINT src = { 0, 0 };
+static void UpdateHaloWindow(HWND hwnd, POINT pt, UINT size, int frame)
+{
     POINT dst = {
         pt.x - (int)size / 2,
         pt.y - (int)size / 2
     };
 
+    // Same image: just move the window
+    if (size == shownSize && frame == shownFrame) {
+        if (dst.x != shownPos.x || dst.y != shownPos.y) {
+            SetWindowPos(hwnd, nullptr, dst.x, dst.y, 0, 0, SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE);
+            shownPos = dst;
+        }
+        return;
+    }
+
+    HBITMAP sheet = GetHaloSheet(size);
+    if (!sheet)
+        return;
+
+    if (!haloDC)
+        haloDC = CreateCompatibleDC(nullptr);
+
+    HGDIOBJ previous = SelectObject(haloDC, sheet);
+    if (!haloDCDefaultBmp)
+        haloDCDefaultBmp = previous;
+
+    SIZE wndSize = { (LONG)size, (LONG)size };
+    POINT src = { frame * (LONG)size, 0 };
+
     BLENDFUNCTION blend = {};
     blend.BlendOp = AC_SRC_OVER;
     blend.SourceConstantAlpha = 255;
@@ -126,6 +220,106 @@ static void UpdateHaloWindow(HWND hwnd, POINT pt, UINT size)
         &blend,
         ULW_ALPHA
     );
+
+    shownSize = size;
+    shownFrame = frame;
+    shownPos = dst;
+}
+
+// ============================================================
+// Frame Pacing
+// ============================================================
+
+static void PresentHaloFrame(HWND hwnd)
+{
+    POINT pt;
+    GetCursorPos(&pt);
+    presentedCursor = pt;
+
+    UINT size = (UINT)(BASE_SIZE * GetCursorScale(pt));
+    UpdateHaloWindow(hwnd, pt, size, CurrentHaloFrame());
+
+    LONGLONG now = QpcNow();
+    if (oldestMoveQpc) {
+        double lagMs = (now - oldestMoveQpc) * 1000.0 / QpcFrequency();
+        windowLagSumMs += lagMs;
+        if (lagMs > windowLagMaxMs)
+            windowLagMaxMs = lagMs;
+        windowFrames++;
+        oldestMoveQpc = 0;
+    }
+    lastPresentQpc = now;
+}
+
+// False for reports that can't have moved the cursor: button-only and wheel reports, and
+// relative motion of zero (some high-rate mice send those between real ones)
+static bool RawInputMoves(LPARAM lParam)
+{
+    RAWINPUT input;
+    UINT bytes = sizeof(input);
+    if (GetRawInputData((HRAWINPUT)lParam, RID_INPUT, &input, &bytes, sizeof(RAWINPUTHEADER)) == (UINT)-1)
+        return true;    // can't tell; OnCursorMoved still checks the position
+    if (input.header.dwType != RIM_TYPEMOUSE)
+        return false;
+
+    const RAWMOUSE& mouse = input.data.mouse;
+    if (mouse.usFlags & MOUSE_MOVE_ABSOLUTE)
+        return true;    // tablets and remote sessions report positions, not deltas
+    return mouse.lLastX != 0 || mouse.lLastY != 0;
+}
+
+static void OnCursorMoved(HWND hwnd)
+{
+    // Pushing against a screen edge, or motion the pointer speed rounds away
+    if (!framePending) {
+        POINT pt;
+        if (GetCursorPos(&pt) && pt.x == presentedCursor.x && pt.y == presentedCursor.y)
+            return;
+    }
+
+    LONGLONG now = QpcNow();
+    if (!oldestMoveQpc)
+        oldestMoveQpc = now;
+
+    // Already waiting for the next frame: this movement rides along
+    if (framePending)
+        return;
+
+    LONGLONG due = lastPresentQpc + frameIntervalQpc;
+    if (now >= due) {
+        PresentHaloFrame(hwnd);
+        return;
+    }
+
+    UINT waitMs = (UINT)((due - now) * 1000 / QpcFrequency());
+    if (waitMs < USER_TIMER_MINIMUM)
+        waitMs = USER_TIMER_MINIMUM;
+    SetTimer(hwnd, FRAME_TIMER, waitMs, nullptr);
+    framePending = true;
+}
+
+static void UpdatePulseTimer(HWND hwnd)
+{
+    // Only the pulse animation needs ticks while the cursor is still
+    if (haloStyle == HaloStyle::Pulse)
+        SetTimer(hwnd, PULSE_TIMER, PULSE_PERIOD_MS / HALO_PULSE_FRAMES, nullptr);
+    else
+        KillTimer(hwnd, PULSE_TIMER);
+}
+
+static void RegisterMouseInput(HWND hwnd, bool enable)
+{
+    RAWINPUTDEVICE rid{};
+    rid.usUsagePage = 0x01;     // Generic desktop controls
+    rid.usUsage = 0x02;         // Mouse
+    rid.dwFlags = enable ? RIDEV_INPUTSINK : RIDEV_REMOVE;
+    rid.hwndTarget = enable ? hwnd : nullptr;
+
+    if (!RegisterRawInputDevices(&rid, 1, sizeof(rid))) {
+        wchar_t buf[128];
+        swprintf(buf, 128, L"RegisterRawInputDevices (mouse) failed, error=%lu\n", GetLastError());
+        OutputDebugString(buf);
+    }
 }
 
 // ============================================================
@@ -137,25 +331,43 @@ LRESULT CALLBACK HaloWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     switch (msg) {
 
     case WM_CREATE:
-        SetTimer(hwnd, 1, 16, nullptr); // ~60 FPS
+        // Driven by mouse movement; nothing runs while the cursor is idle
+        RegisterMouseInput(hwnd, true);
+        UpdatePulseTimer(hwnd);
         return 0;
 
-    case WM_TIMER: {
-        POINT pt;
-        GetCursorPos(&pt);
-
-        UINT size = (UINT)(BASE_SIZE * GetCursorScale());
-        UpdateHaloWindow(hwnd, pt, size);
+    case WM_INPUT:
+        CountWakeup();
+        if (RawInputMoves(lParam))
+            OnCursorMoved(hwnd);
+        break; // DefWindowProc releases the raw input buffer
+
+    case WM_TIMER:
+        CountWakeup();
+        if (wParam == FRAME_TIMER) {
+            KillTimer(hwnd, FRAME_TIMER);
+            framePending = false;
+        }
+        PresentHaloFrame(hwnd);
         return 0;
-    }
 
     case WM_DESTROY:
-        KillTimer(hwnd, 1);
-        CleanupBitmap();
+        RegisterMouseInput(hwnd, false);
+        KillTimer(hwnd, FRAME_TIMER);
+        KillTimer(hwnd, PULSE_TIMER);
+        framePending = false;
+        oldestMoveQpc = 0;
         if (haloDC) {
+            if (haloDCDefaultBmp)
+                SelectObject(haloDC, haloDCDefaultBmp);
             DeleteDC(haloDC);
             haloDC = nullptr;
+            haloDCDefaultBmp = nullptr;
         }
+        shownSize = 0;
+        shownFrame = -1;
+        shownPos = { LONG_MIN, LONG_MIN };
+        presentedCursor = { LONG_MIN, LONG_MIN };
         return 0;
     }
 
@@ -212,6 +424,30 @@ void ShowCursorHalo()
     );
 
     ShowWindow(haloHwnd, SW_SHOW);
+    PresentHaloFrame(haloHwnd);
+}
+
+HaloStyle GetCursorHaloStyle()
+{
+    return haloStyle;
+}
+
+void SetCursorHaloStyle(HaloStyle style)
+{
+    haloStyle = style;
+    shownFrame = -1; // force the next frame to blend the new style
+
+    if (haloHwnd) {
+        UpdatePulseTimer(haloHwnd);
+        PresentHaloFrame(haloHwnd);
+    }
+}
+
+CursorHaloMetrics GetCursorHaloMetrics()
+{
+    // Close out a window that went quiet, so an idle cursor reads as idle
+    RollMetrics(QpcNow());
+    return lastMetrics;
 }
 
 void HideCursorHalo()
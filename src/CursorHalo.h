@@ -1,8 +1,21 @@
 #include <windows.h>
 #include <d2d1.h>
 #include <ShellScalingApi.h>
+#include "HaloSprite.h"
 
 #pragma once
 
 void ShowCursorHalo();
 void HideCursorHalo();
+void SetCursorHaloStyle(HaloStyle style);
+HaloStyle GetCursorHaloStyle();
+
+struct CursorHaloMetrics {
+    double wakeupsPerSecond = 0.0;  // messages the halo handled (input + timers)
+    double framesPerSecond = 0.0;   // frames that carried cursor movement
+    double avgLagMs = 0.0;          // first movement received -> halo moved
+    double maxLagMs = 0.0;
+};
+
+// Figures for the last completed one-second window
+CursorHaloMetrics GetCursorHaloMetrics();
@@ -0,0 +1,148 @@
+// FocusTracker.cpp
+
+#include "FocusTracker.h"
+#include <UIAutomation.h>
+#include <UIAutomationClient.h>
+#include <wrl/client.h>
+#include <atomic>
+#include <thread>
+
+using Microsoft::WRL::ComPtr;
+
+namespace hint_map {
+
+    // controlType in the low 32 bits, editable in bit 32, sequence above; one load reads all three consistently
+    static std::atomic<uint64_t> packedFocus{ 0 };
+
+    static std::thread trackerThread;
+    static HANDLE stopEvent = nullptr;
+
+    static uint64_t Pack(int controlType, bool editable, unsigned sequence) {
+        return (uint64_t)(uint32_t)controlType | ((uint64_t)(editable ? 1 : 0) << 32) | ((uint64_t)sequence << 33);
+    }
+
+    FocusState CurrentFocus() {
+        uint64_t v = packedFocus.load(std::memory_order_acquire);
+        FocusState state;
+        state.controlType = (int)(uint32_t)v;
+        state.editable = ((v >> 32) & 1) != 0;
+        state.sequence = (unsigned)(v >> 33);
+        return state;
+    }
+
+    static void PublishFocus(IUIAutomationElement* element) {
+        int controlType = 0;
+        bool editable = false;
+
+        if (element && SUCCEEDED(element->get_CachedControlType(&controlType))) {
+            VARIANT hasValue, readOnly;
+            VariantInit(&hasValue);
+            VariantInit(&readOnly);
+            element->GetCachedPropertyValue(UIA_IsValuePatternAvailablePropertyId, &hasValue);
+            element->GetCachedPropertyValue(UIA_ValueIsReadOnlyPropertyId, &readOnly);
+            const bool valueWritable = hasValue.vt == VT_BOOL && hasValue.boolVal == VARIANT_TRUE
+                && !(readOnly.vt == VT_BOOL && readOnly.boolVal == VARIANT_TRUE);
+
+            // Edit fields count unless explicitly read-only; documents only with a writable value
+            if (controlType == UIA_EditControlTypeId) {
+                editable = !(readOnly.vt == VT_BOOL && readOnly.boolVal == VARIANT_TRUE);
+            }
+            else if (controlType == UIA_DocumentControlTypeId) {
+                editable = valueWritable;
+            }
+            VariantClear(&hasValue);
+            VariantClear(&readOnly);
+        }
+
+        unsigned sequence = (unsigned)(packedFocus.load(std::memory_order_relaxed) >> 33) + 1;
+        packedFocus.store(Pack(controlType, editable, sequence), std::memory_order_release);
+    }
+
+    class FocusChangedHandler : public IUIAutomationFocusChangedEventHandler {
+    public:
+        ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&refCount); }
+        ULONG STDMETHODCALLTYPE Release() override {
+            ULONG count = InterlockedDecrement(&refCount);
+            if (count == 0) delete this;
+            return count;
+        }
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override {
+            if (riid == __uuidof(IUnknown) || riid == __uuidof(IUIAutomationFocusChangedEventHandler)) {
+                *ppv = static_cast<IUIAutomationFocusChangedEventHandler*>(this);
+                AddRef();
+                return S_OK;
+            }
+            *ppv = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        // Sender arrives with the registration's cache request already applied
+        HRESULT STDMETHODCALLTYPE HandleFocusChangedEvent(IUIAutomationElement* sender) override {
+            PublishFocus(sender);
+            return S_OK;
+        }
+
+    private:
+        LONG refCount = 1;
+    };
+
+    static void TrackerThreadMain() {
+        // UIA event handlers must live on an MTA thread that isn't pumping UI
+        HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        if (FAILED(hr)) {
+            OutputDebugStringW(L"[hint_map] CoInitializeEx failed in focus tracker\n");
+            return;
+        }
+
+        {
+            ComPtr<IUIAutomation> automation;
+            if (FAILED(CoCreateInstance(__uuidof(CUIAutomation), nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&automation))) || !automation) {
+                OutputDebugStringW(L"[hint_map] CoCreateInstance for CUIAutomation failed in focus tracker\n");
+                CoUninitialize();
+                return;
+            }
+
+            ComPtr<IUIAutomationCacheRequest> cacheRequest;
+            automation->CreateCacheRequest(&cacheRequest);
+            if (cacheRequest) {
+                cacheRequest->AddProperty(UIA_ControlTypePropertyId);
+                cacheRequest->AddProperty(UIA_IsValuePatternAvailablePropertyId);
+                cacheRequest->AddProperty(UIA_ValueIsReadOnlyPropertyId);
+            }
+
+            // Seed with whatever has focus right now
+            ComPtr<IUIAutomationElement> focused;
+            if (cacheRequest && SUCCEEDED(automation->GetFocusedElementBuildCache(cacheRequest.Get(), &focused))) {
+                PublishFocus(focused.Get());
+            }
+
+            FocusChangedHandler* handler = new FocusChangedHandler();
+            hr = automation->AddFocusChangedEventHandler(cacheRequest.Get(), handler);
+            if (FAILED(hr)) {
+                OutputDebugStringW(L"[hint_map] AddFocusChangedEventHandler failed\n");
+            }
+
+            WaitForSingleObject(stopEvent, INFINITE);
+
+            if (SUCCEEDED(hr)) automation->RemoveFocusChangedEventHandler(handler);
+            handler->Release();
+        }
+
+        CoUninitialize();
+    }
+
+    void StartFocusTracker() {
+        if (trackerThread.joinable()) return;
+        stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        trackerThread = std::thread(TrackerThreadMain);
+    }
+
+    void StopFocusTracker() {
+        if (!trackerThread.joinable()) return;
+        SetEvent(stopEvent);
+        trackerThread.join();
+        CloseHandle(stopEvent);
+        stopEvent = nullptr;
+    }
+
+}
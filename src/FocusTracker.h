@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Windows.h>
+
+namespace hint_map {
+
+    struct FocusState {
+        int controlType = 0;        // UIA control type id of the focused element, 0 if unknown
+        bool editable = false;      // focus is in a writable text field
+        unsigned sequence = 0;      // bumped on every focus change
+    };
+
+    // Subscribes to UIA focus-changed events on a background MTA thread and caches what
+    // the key path needs to know about the focused element.
+    void StartFocusTracker();
+    void StopFocusTracker();
+
+    // Lock-free; safe from any thread. One atomic load, no COM calls.
+    FocusState CurrentFocus();
+
+}
@@ -0,0 +1,51 @@
+// Geometry.h
+#pragma once
+
+// Plain screen-space geometry shared by the portable (non-Windows) parts of hint mode.
+// Layout matches RECT so Windows code can convert field by field.
+
+namespace hint_map {
+
+    struct Rect {
+        int left = 0;
+        int top = 0;
+        int right = 0;
+        int bottom = 0;
+
+        int Width() const { return right - left; }
+        int Height() const { return bottom - top; }
+        bool Empty() const { return right <= left || bottom <= top; }
+        bool Contains(int x, int y) const { return x >= left && x < right && y >= top && y < bottom; }
+    };
+
+    struct Size {
+        int width = 0;
+        int height = 0;
+    };
+
+    inline Rect MakeRect(int left, int top, int right, int bottom) {
+        Rect r;
+        r.left = left; r.top = top; r.right = right; r.bottom = bottom;
+        return r;
+    }
+
+    inline bool Intersects(const Rect& a, const Rect& b) {
+        return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+    }
+
+    inline Rect Intersection(const Rect& a, const Rect& b) {
+        Rect r;
+        r.left = a.left > b.left ? a.left : b.left;
+        r.top = a.top > b.top ? a.top : b.top;
+        r.right = a.right < b.right ? a.right : b.right;
+        r.bottom = a.bottom < b.bottom ? a.bottom : b.bottom;
+        if (r.Empty()) return Rect{};
+        return r;
+    }
+
+    inline long long OverlapArea(const Rect& a, const Rect& b) {
+        Rect r = Intersection(a, b);
+        return (long long)r.Width() * r.Height();
+    }
+
+}
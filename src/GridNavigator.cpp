@@ -0,0 +1,55 @@
+// GridNavigator.cpp
+
+#include "GridNavigator.h"
+
+namespace hint_map {
+
+    static const char CELL_KEYS[GridNavigator::CELLS + 1] = "QWEASDZXC";
+
+    void GridNavigator::Reset(const Rect& area, int minSize) {
+        stack[0] = area;
+        depth = 0;
+        minCellSize = minSize > 1 ? minSize : 1;
+    }
+
+    Rect GridNavigator::Cell(int index) const {
+        if (index < 0 || index >= CELLS) return Rect();
+        const Rect& a = Area();
+        const int col = index % COLUMNS;
+        const int row = index / COLUMNS;
+
+        // Edge k sits at floor(k * size / n): neighbours share edges exactly
+        Rect r;
+        r.left = a.left + (int)((long long)a.Width() * col / COLUMNS);
+        r.right = a.left + (int)((long long)a.Width() * (col + 1) / COLUMNS);
+        r.top = a.top + (int)((long long)a.Height() * row / ROWS);
+        r.bottom = a.top + (int)((long long)a.Height() * (row + 1) / ROWS);
+        return r;
+    }
+
+    char GridNavigator::CellKey(int index) {
+        return (index >= 0 && index < CELLS) ? CELL_KEYS[index] : 0;
+    }
+
+    int GridNavigator::CellForKey(char key) {
+        for (int i = 0; i < CELLS; ++i) {
+            if (CELL_KEYS[i] == key) return i;
+        }
+        return -1;
+    }
+
+    bool GridNavigator::Select(int index) {
+        if (index < 0 || index >= CELLS || depth >= MAX_DEPTH) return false;
+        Rect cell = Cell(index);
+        if (cell.Width() < minCellSize || cell.Height() < minCellSize) return false;
+        stack[++depth] = cell;
+        return true;
+    }
+
+    bool GridNavigator::Back() {
+        if (depth == 0) return false;
+        --depth;
+        return true;
+    }
+
+}
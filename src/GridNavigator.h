@@ -0,0 +1,51 @@
+// GridNavigator.h
+#pragma once
+
+#include "Geometry.h"
+
+namespace hint_map {
+
+    // Keyboard grid for apps with no usable UIA tree: the area is split into 3x3 cells,
+    // each keypress descends into one cell, and the final area's centre is the click point.
+    // Every operation is O(1); the ancestry is a fixed-size stack.
+    class GridNavigator {
+    public:
+        static const int COLUMNS = 3;
+        static const int ROWS = 3;
+        static const int CELLS = COLUMNS * ROWS;
+        static const int MAX_DEPTH = 16;
+
+        GridNavigator() = default;
+        explicit GridNavigator(const Rect& area, int minCellSize = 4) { Reset(area, minCellSize); }
+
+        void Reset(const Rect& area, int minCellSize = 4);
+
+        const Rect& Area() const { return stack[depth]; }
+        int Depth() const { return depth; }
+
+        // Cell 0..CELLS-1 in row-major order. Edges are distributed so cells tile Area()
+        // exactly with no gaps or overlaps, even when the size doesn't divide by 3.
+        Rect Cell(int index) const;
+
+        // Key for each cell, laid out like the keyboard: Q W E / A S D / Z X C
+        static char CellKey(int index);
+        // Cell for an upper-case letter, or -1
+        static int CellForKey(char key);
+
+        // Descend into a cell. False (and no change) if it is out of range, the stack is
+        // full, or the cell would be smaller than the minimum size.
+        bool Select(int index);
+        // Back to the parent area. False at the root.
+        bool Back();
+
+        // Click point: centre of the current area
+        int CenterX() const { return Area().left + Area().Width() / 2; }
+        int CenterY() const { return Area().top + Area().Height() / 2; }
+
+    private:
+        Rect stack[MAX_DEPTH + 1];
+        int depth = 0;
+        int minCellSize = 4;
+    };
+
+}
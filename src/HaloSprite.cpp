@@ -0,0 +1,122 @@
+// HaloSprite.cpp
+
+#include "HaloSprite.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HALO_SSE2 1
+#endif
+
+static const float HALO_ALPHA = 0.8f;
+static const float HALO_RADIUS = 0.35f;   // fraction of the sprite size
+static const uint8_t HALO_R = 255, HALO_G = 40, HALO_B = 40;
+
+int HaloFrameCount(HaloStyle style)
+{
+    return style == HaloStyle::Pulse ? HALO_PULSE_FRAMES : 1;
+}
+
+int HaloFrameIndex(HaloStyle style, int animationFrame)
+{
+    switch (style) {
+    case HaloStyle::Glow: return 0;
+    case HaloStyle::Ring: return 1;
+    case HaloStyle::Pulse: return 2 + (animationFrame % HALO_PULSE_FRAMES);
+    }
+    return 0;
+}
+
+// ============================================================
+// Kernel
+// ============================================================
+
+static inline uint32_t PackPixel(float alpha, float r, float g, float b)
+{
+    // Alpha is truncated like the original per-pixel loop; colour is premultiplied
+    int a = (int)alpha;
+    int pr = (int)std::nearbyint(a * r);
+    int pg = (int)std::nearbyint(a * g);
+    int pb = (int)std::nearbyint(a * b);
+    return ((uint32_t)a << 24) | ((uint32_t)pr << 16) | ((uint32_t)pg << 8) | (uint32_t)pb;
+}
+
+void RenderHaloSprite(uint32_t* dst, int stride, int size, const HaloProfile& profile, uint8_t r, uint8_t g, uint8_t b)
+{
+    const float c = size / 2.0f;
+    const float invWidth = 1.0f / profile.width;
+    const float scale = 255.0f * profile.peak;
+    const float rf = r / 255.0f, gf = g / 255.0f, bf = b / 255.0f;
+
+    for (int y = 0; y < size; y++) {
+        uint32_t* row = dst + (size_t)y * stride;
+        const float dy = y - c;
+        int x = 0;
+
+#ifdef HALO_SSE2
+        const __m128 vdy2 = _mm_set1_ps(dy * dy);
+        const __m128 vc = _mm_set1_ps(profile.center);
+        const __m128 vinv = _mm_set1_ps(invWidth);
+        const __m128 vscale = _mm_set1_ps(scale);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        const __m128 vr = _mm_set1_ps(rf), vg = _mm_set1_ps(gf), vb = _mm_set1_ps(bf);
+
+        for (; x + 4 <= size; x += 4) {
+            __m128 dx = _mm_sub_ps(_mm_setr_ps((float)x, (float)(x + 1), (float)(x + 2), (float)(x + 3)), _mm_set1_ps(c));
+            __m128 d = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), vdy2));
+            __m128 t = _mm_sub_ps(one, _mm_mul_ps(_mm_and_ps(_mm_sub_ps(d, vc), absMask), vinv));
+            t = _mm_max_ps(t, zero);
+
+            __m128i a = _mm_cvttps_epi32(_mm_mul_ps(t, vscale));
+            __m128 af = _mm_cvtepi32_ps(a);
+            __m128i pr = _mm_cvtps_epi32(_mm_mul_ps(af, vr));
+            __m128i pg = _mm_cvtps_epi32(_mm_mul_ps(af, vg));
+            __m128i pb = _mm_cvtps_epi32(_mm_mul_ps(af, vb));
+
+            __m128i px = _mm_or_si128(
+                _mm_or_si128(_mm_slli_epi32(a, 24), _mm_slli_epi32(pr, 16)),
+                _mm_or_si128(_mm_slli_epi32(pg, 8), pb));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), px);
+        }
+#endif
+        for (; x < size; x++) {
+            const float dx = x - c;
+            const float d = std::sqrt(dx * dx + dy * dy);
+            float t = 1.0f - std::fabs(d - profile.center) * invWidth;
+            if (t < 0.0f) t = 0.0f;
+            row[x] = PackPixel(t * scale, rf, gf, bf);
+        }
+    }
+}
+
+void RenderHaloSpriteSheet(uint32_t* dst, int size)
+{
+    const int stride = size * HALO_SHEET_FRAMES;
+    const float radius = size * HALO_RADIUS;
+
+    // Glow: alpha falls off linearly from the centre
+    HaloProfile glow;
+    glow.center = 0.0f;
+    glow.width = radius;
+    glow.peak = HALO_ALPHA;
+    RenderHaloSprite(dst + HaloFrameIndex(HaloStyle::Glow, 0) * size, stride, size, glow, HALO_R, HALO_G, HALO_B);
+
+    // Ring: a band near the outer edge
+    HaloProfile ring;
+    ring.center = radius * 0.8f;
+    ring.width = radius * 0.25f;
+    ring.peak = 0.9f;
+    RenderHaloSprite(dst + HaloFrameIndex(HaloStyle::Ring, 0) * size, stride, size, ring, HALO_R, HALO_G, HALO_B);
+
+    // Pulse: glow whose radius and strength follow one cosine period over the frames
+    for (int f = 0; f < HALO_PULSE_FRAMES; f++) {
+        const float phase = 0.5f - 0.5f * std::cos(2.0f * 3.14159265f * f / HALO_PULSE_FRAMES);
+        HaloProfile pulse;
+        pulse.center = 0.0f;
+        pulse.width = radius * (0.7f + 0.3f * phase);
+        pulse.peak = HALO_ALPHA * (0.6f + 0.4f * phase);
+        RenderHaloSprite(dst + HaloFrameIndex(HaloStyle::Pulse, f) * size, stride, size, pulse, HALO_R, HALO_G, HALO_B);
+    }
+}
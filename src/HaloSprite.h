@@ -0,0 +1,34 @@
+// HaloSprite.h
+#pragma once
+
+#include <cstdint>
+
+// Cursor halo artwork, generated once per size into a sprite sheet of premultiplied
+// BGRA frames laid out left to right. No Windows dependency.
+
+enum class HaloStyle {
+    Glow,   // soft filled disc (the original halo)
+    Ring,   // thin ring around the cursor
+    Pulse   // animated glow that breathes in and out
+};
+
+static const int HALO_PULSE_FRAMES = 12;
+static const int HALO_SHEET_FRAMES = 2 + HALO_PULSE_FRAMES;   // glow, ring, pulse frames
+
+// Radial alpha profile: alpha = peak * max(0, 1 - |d - center| / width), d measured from the sprite centre.
+struct HaloProfile {
+    float center = 0.0f;
+    float width = 1.0f;
+    float peak = 1.0f;
+};
+
+int HaloFrameCount(HaloStyle style);
+
+// Column of the given animation frame in the sprite sheet.
+int HaloFrameIndex(HaloStyle style, int animationFrame);
+
+// Renders one size x size sprite into dst (stride in pixels).
+void RenderHaloSprite(uint32_t* dst, int stride, int size, const HaloProfile& profile, uint8_t r, uint8_t g, uint8_t b);
+
+// Renders all HALO_SHEET_FRAMES frames; dst must hold size * HALO_SHEET_FRAMES x size pixels.
+void RenderHaloSpriteSheet(uint32_t* dst, int size);
@@ -0,0 +1,74 @@
+// HeapCounter.cpp
+
+#include "HeapCounter.h"
+#include <cstdlib>
+#include <new>
+
+namespace hint_map {
+
+    // Zero-initialised, so it's usable before any constructor on the thread has run
+    static thread_local uint64_t t_allocations = 0;
+
+    uint64_t ThreadHeapAllocations() {
+        return t_allocations;
+    }
+
+    static void* CountedAllocate(size_t bytes) {
+        ++t_allocations;
+        return std::malloc(bytes ? bytes : 1);
+    }
+
+}
+
+// Replacements for the global allocation functions. Over-aligned (C++17) new isn't
+// replaced and isn't counted.
+
+void* operator new(size_t bytes) {
+    for (;;) {
+        if (void* p = hint_map::CountedAllocate(bytes)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new[](size_t bytes) {
+    return operator new(bytes);
+}
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept {
+    try {
+        return operator new(bytes);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept {
+    return operator new(bytes, std::nothrow);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
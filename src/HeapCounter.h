@@ -0,0 +1,13 @@
+// HeapCounter.h
+#pragma once
+
+#include <cstdint>
+
+namespace hint_map {
+
+    // Calls to the global operator new made by the calling thread since it started: every
+    // std container, string and function growth. Allocations that skip it (malloc, COM's
+    // task allocator, HeapAlloc inside UIA) aren't seen.
+    uint64_t ThreadHeapAllocations();
+
+}
@@ -5,20 +5,25 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <unordered_map>
-#include <set>
-#include <d2d1.h>
-#include <dwrite.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <math.h>
 #include "UIElementScanner.h"
-#include <ShellScalingApi.h>
-#pragma comment(lib, "Shcore.lib")
-#pragma comment(lib, "d2d1")
-#pragma comment(lib, "dwrite")
+#include "LabelPlacement.h"
+#include "LabelRasterizer.h"
+#include "MonitorCache.h"
+#include "LatencyStats.h"
+#include "TraceRecorder.h"
 
 namespace hint_map {
 
     static HWND overlayWnd = nullptr;
 
+    // Posted by the render worker once the label image is ready to present
+    static const UINT WM_OVERLAY_READY = WM_APP + 1;
+
     COLORREF GetColorForControlType(LONG controlTypeId) {
         switch (controlTypeId) {
         case UIA_ButtonControlTypeId:         return RGB(255, 220, 220); // Light red
@@ -30,216 +35,297 @@ namespace hint_map {
         }
     }
 
-    LRESULT CALLBACK OverlayWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
-        // Static shared D2D/DWrite objects
-        static ID2D1Factory* d2dFactory = nullptr;
-        static IDWriteFactory* dwriteFactory = nullptr;
-        static ID2D1HwndRenderTarget* renderTarget = nullptr;
-        static IDWriteTextFormat* textFormat = nullptr;
-        static std::unordered_map<LONG, ID2D1SolidColorBrush*> brushCache;
-        int virtualWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
-        int virtualHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
-        int virtualLeft = GetSystemMetrics(SM_XVIRTUALSCREEN);
-        int virtualTop = GetSystemMetrics(SM_YVIRTUALSCREEN);
-
-        switch (msg) {
-        case WM_PAINT: {
-            PAINTSTRUCT ps;
-            HDC hdc = BeginPaint(hwnd, &ps);
-
-            HMONITOR hMon = MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST);
+    // Everything the render worker needs, copied so it never touches UIA elements
+    struct OverlayJob {
+        std::vector<Rect> targets;          // screen coordinates
+        std::vector<LONG> controlTypes;
+        std::vector<std::wstring> labels;
+        Rect screen;                        // virtual screen
+        float dpiScale = 1.0f;
+        bool centered = false;              // label sits in the middle of its target (grid cells)
+        int selected = -1;                  // label drawn highlighted, -1 for none
+        std::vector<char> marked;           // per target: queued in multi-select; may be empty
+    };
+
+    // Finished label image: a premultiplied 32bpp DIB covering only the labels
+    struct OverlayImage {
+        HBITMAP bitmap = nullptr;
+        Rect bounds;                        // screen coordinates
+    };
+
+    // One render thread, newest job wins. Every submitted job gets the next generation;
+    // the worker drops what it renders for an older one, and the UI thread only presents
+    // the newest, so it never waits on a render.
+    struct RenderRequest {
+        OverlayJob job;
+        HWND hwnd = nullptr;
+        uint64_t generation = 0;
+    };
+
+    static std::thread renderThread;
+    static std::mutex renderMutex;
+    static std::condition_variable renderWake;
+    static bool renderStopping = false;         // guarded by renderMutex
+    static bool hasRequest = false;             // guarded by renderMutex
+    static RenderRequest pendingRequest;        // guarded by renderMutex
+    static uint64_t latestGeneration = 0;       // guarded by renderMutex; newest submitted job
+    static OverlayImage readyImage;             // guarded by renderMutex; finished, not yet presented
+    static uint64_t readyGeneration = 0;        // guarded by renderMutex; 0 when readyImage is empty
+
+    // Last hint job, kept so a selection change re-renders without touching UIA again
+    static OverlayJob hintJob;
+
+    // Glyph atlases per font pixel size. Only the render thread touches this.
+    static std::map<int, GlyphAtlas> atlasCache;
+
+    static uint32_t ToArgb(COLORREF c) {
+        return 0xFF000000u | ((uint32_t)GetRValue(c) << 16) | ((uint32_t)GetGValue(c) << 8) | GetBValue(c);
+    }
 
-            MONITORINFO mi = { sizeof(mi) };
-            GetMonitorInfo(hMon, &mi);
-            RECT monitorRect = mi.rcMonitor;
+    // Rasterise A-Z once per size with GDI's 65-level grayscale glyph bitmaps
+    static const GlyphAtlas& GetGlyphAtlas(int pixelSize) {
+        auto it = atlasCache.find(pixelSize);
+        if (it != atlasCache.end()) return it->second;
+
+        GlyphAtlas& atlas = atlasCache[pixelSize];
+        atlas.first = L'A';
+
+        HDC dc = CreateCompatibleDC(nullptr);
+        HFONT font = CreateFontW(-pixelSize, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
+            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY,
+            DEFAULT_PITCH | FF_DONTCARE, L"Segoe UI");
+        HGDIOBJ oldFont = SelectObject(dc, font);
+
+        TEXTMETRICW tm = {};
+        GetTextMetricsW(dc, &tm);
+        atlas.ascent = tm.tmAscent;
+        atlas.lineHeight = tm.tmHeight;
+
+        const MAT2 identity = { {0, 1}, {0, 0}, {0, 0}, {0, 1} };
+        std::vector<BYTE> raw;
+
+        for (wchar_t ch = L'A'; ch <= L'Z'; ++ch) {
+            GlyphMask glyph;
+            GLYPHMETRICS gm = {};
+            DWORD bytes = GetGlyphOutlineW(dc, ch, GGO_GRAY8_BITMAP, &gm, 0, nullptr, &identity);
+            glyph.advance = gm.gmCellIncX;
+
+            if (bytes != GDI_ERROR && bytes > 0) {
+                raw.resize(bytes);
+                GetGlyphOutlineW(dc, ch, GGO_GRAY8_BITMAP, &gm, bytes, raw.data(), &identity);
+
+                glyph.width = (int)gm.gmBlackBoxX;
+                glyph.height = (int)gm.gmBlackBoxY;
+                glyph.offsetX = gm.gmptGlyphOrigin.x;
+                glyph.offsetY = -gm.gmptGlyphOrigin.y;
+                glyph.coverage.resize((size_t)glyph.width * glyph.height);
+
+                // Rows are DWORD aligned, levels run 0..64
+                const int pitch = (glyph.width + 3) & ~3;
+                for (int y = 0; y < glyph.height; ++y) {
+                    for (int x = 0; x < glyph.width; ++x) {
+                        BYTE v = raw[(size_t)y * pitch + x];
+                        glyph.coverage[(size_t)y * glyph.width + x] = (uint8_t)(v >= 64 ? 255 : v * 4);
+                    }
+                }
+            }
+            atlas.glyphs.push_back(std::move(glyph));
+        }
 
-            // DPI scaling
-            UINT dpiX, dpiY;
-            GetDpiForMonitor(hMon, MDT_EFFECTIVE_DPI, &dpiX, &dpiY);
-            float dpiScale = dpiX / 96.0f;
+        SelectObject(dc, oldFont);
+        DeleteObject(font);
+        DeleteDC(dc);
+        return atlas;
+    }
 
+    // Runs on the render worker: measure, place and rasterise every label
+    static OverlayImage RenderOverlay(const OverlayJob& job) {
+        ScopedLatencyTimer timer(LatencyMetric::RenderOverlay);
+        ScopedTrace trace("Render labels");
+        OverlayImage image;
+
+        const float dpiScale = job.dpiScale;
+        const GlyphAtlas& atlas = GetGlyphAtlas((int)(11.0f * dpiScale + 0.5f));
+
+        LabelStyle style;
+        style.padX = (int)(2.0f * dpiScale + 0.5f);
+        style.padY = (int)(1.0f * dpiScale + 0.5f);
+        style.radius = 4.0f * dpiScale;
+        style.borderWidth = 1;
+
+        const size_t count = (std::min)(job.targets.size(), job.labels.size());
+        std::vector<Size> boxSizes(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (!job.labels[i].empty()) boxSizes[i] = MeasureLabel(job.labels[i], atlas, style.padX, style.padY);
+        }
 
-            // Initialize factories/render target if not yet (same as before)...
-            if (!d2dFactory) {
-                D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &d2dFactory);
+        std::vector<Rect> boxes;
+        if (job.centered) {
+            boxes.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                const Rect& t = job.targets[i];
+                int left = t.left + (t.Width() - boxSizes[i].width) / 2;
+                int top = t.top + (t.Height() - boxSizes[i].height) / 2;
+                boxes[i] = MakeRect(left, top, left + boxSizes[i].width, top + boxSizes[i].height);
             }
-            if (!dwriteFactory) {
-                DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED, __uuidof(IDWriteFactory), reinterpret_cast<IUnknown**>(&dwriteFactory));
-            }
-            if (!renderTarget) {
-                RECT rc;
-                GetClientRect(hwnd, &rc);
-                D2D1_SIZE_U size = D2D1::SizeU(rc.right - rc.left, rc.bottom - rc.top);
-                D2D1_RENDER_TARGET_PROPERTIES props = D2D1::RenderTargetProperties();
-                D2D1_HWND_RENDER_TARGET_PROPERTIES hwndProps = D2D1::HwndRenderTargetProperties(hwnd, size);
-                d2dFactory->CreateHwndRenderTarget(props, hwndProps, &renderTarget);
+        }
+        else {
+            PlacementParams placement;
+            placement.bounds = job.screen;
+            placement.gap = (int)(6.0f * dpiScale);
+            placement.insetX = 8;
+            boxes = PlaceLabels(job.targets, boxSizes, placement);
+        }
+
+        // Only the area the labels cover gets a bitmap
+        bool any = false;
+        Rect bounds;
+        for (size_t i = 0; i < count; ++i) {
+            if (boxSizes[i].width <= 0) continue;
+            if (!any) { bounds = boxes[i]; any = true; continue; }
+            bounds.left = (std::min)(bounds.left, boxes[i].left);
+            bounds.top = (std::min)(bounds.top, boxes[i].top);
+            bounds.right = (std::max)(bounds.right, boxes[i].right);
+            bounds.bottom = (std::max)(bounds.bottom, boxes[i].bottom);
+        }
+        if (!any) return image;
+
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = bounds.Width();
+        bmi.bmiHeader.biHeight = -bounds.Height(); // top-down
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        void* bits = nullptr;
+        image.bitmap = CreateDIBSection(nullptr, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+        if (!image.bitmap || !bits) {
+            OutputDebugString(L"[hint_map] CreateDIBSection failed for overlay.\n");
+            image.bitmap = nullptr;
+            return image;
+        }
+        image.bounds = bounds;
+
+        Canvas canvas;
+        canvas.pixels = static_cast<uint32_t*>(bits);
+        canvas.width = bounds.Width();
+        canvas.height = bounds.Height();
+        canvas.stride = canvas.width;
+        ClearCanvas(canvas);
+
+        for (size_t i = 0; i < count; ++i) {
+            if (boxSizes[i].width <= 0) continue;
+            LabelStyle labelStyle = style;
+            labelStyle.fill = ToArgb(GetColorForControlType(job.controlTypes[i]));
+            if (i < job.marked.size() && job.marked[i]) {
+                labelStyle.fill = 0xFF2E9E4A;
+                labelStyle.text = 0xFFFFFFFF;
             }
-            if (!textFormat) {
-                dwriteFactory->CreateTextFormat(
-                    L"Segoe UI",
-                    nullptr,
-                    DWRITE_FONT_WEIGHT_BOLD,
-                    DWRITE_FONT_STYLE_NORMAL,
-                    DWRITE_FONT_STRETCH_NORMAL,
-                    11.0f * dpiScale,                  
-                    L"",
-                    &textFormat
-                );
-                textFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_LEADING);
-                textFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_NEAR);
+            if ((int)i == job.selected) {
+                labelStyle.fill = 0xFF1E64C8;
+                labelStyle.text = 0xFFFFFFFF;
+                labelStyle.borderWidth = 2;
             }
+            const Rect& b = boxes[i];
+            DrawLabel(canvas, MakeRect(b.left - bounds.left, b.top - bounds.top, b.right - bounds.left, b.bottom - bounds.top),
+                job.labels[i], atlas, labelStyle);
+        }
 
+        return image;
+    }
 
+    // One UpdateLayeredWindow call puts the whole image on screen with per-pixel alpha
+    static void PresentOverlayImage(HWND hwnd, const OverlayImage& image) {
+        ScopedTrace trace("First paint");
+        HDC memDC = CreateCompatibleDC(nullptr);
+        HGDIOBJ oldBmp = SelectObject(memDC, image.bitmap);
 
-            // Begin draw
-            renderTarget->BeginDraw();
-
-            // Clear to magenta (color-keyed transparent)
-            renderTarget->Clear(D2D1::ColorF(1.0f, 0.0f, 1.0f)); // magenta
-
-			// Create brushes
-            ID2D1SolidColorBrush* borderBrush = nullptr;
-            renderTarget->CreateSolidColorBrush(D2D1::ColorF(0, 0, 0), &borderBrush);
-
-            ID2D1SolidColorBrush* blackTextBrush = nullptr;
-            renderTarget->CreateSolidColorBrush(D2D1::ColorF(0, 0, 0), &blackTextBrush);
-
-            auto* hintTargets = reinterpret_cast<std::vector<HintTarget>*>(GetProp(hwnd, L"HINTTARGETS"));
-            auto* labels = reinterpret_cast<std::vector<std::wstring>*>(GetProp(hwnd, L"LABELS"));
-
-            if (hintTargets && labels) {
-                /*const float padX = 2.0f;
-                const float padY = 1.0f;
-                const float cornerRadius = 4.0f;*/
-                const float BASE_PAD_X = 2.0f;
-                const float BASE_PAD_Y = 1.0f;
-                const float BASE_RADIUS = 4.0f;
-                const float BASE_GAP = 6.0f;
-
-                float padX = BASE_PAD_X * dpiScale;
-                float padY = BASE_PAD_Y * dpiScale;
-                float cornerRadius = BASE_RADIUS * dpiScale;
-
-
-                for (size_t i = 0; i < hintTargets->size(); ++i) {
-                    const HintTarget& target = (*hintTargets)[i];
-                    const std::wstring& label = labels->at(i);
-                    int controlTypeId = target.controlTypeId;
-
-                    if (label.empty()) continue;
-
-                    // Layout text
-                    IDWriteTextLayout* textLayout = nullptr;
-                    dwriteFactory->CreateTextLayout(
-                        label.c_str(),
-                        (UINT32)label.size(),
-                        textFormat,
-                        1000.0f,
-                        100.0f,
-                        &textLayout
-                    );
-
-                    DWRITE_TEXT_METRICS metrics{};
-                    if (SUCCEEDED(textLayout->GetMetrics(&metrics))) {
-                        float boxW = metrics.width + padX * 2;
-                        float boxH = metrics.height + padY * 2;
-
-                        float gap = BASE_GAP * dpiScale;
-
-                        //const float gap = 6.0f; // space between target and label
-						// Base virtual position on target rect
-                        float boxX = static_cast<float>(target.rect.left - virtualLeft) + 8.0f;
-                        float boxY = static_cast<float>(target.rect.top - virtualTop) - gap; // above rect
-
-                        if ((target.rect.top - gap) < 0) {
-                            boxY = static_cast<float>(target.rect.top - virtualTop) + gap - 2.0f;
-                        }
-
-                        D2D1_ROUNDED_RECT roundedRect = D2D1::RoundedRect(
-                            D2D1::RectF(boxX, boxY, boxX + boxW, boxY + boxH),
-                            cornerRadius,
-                            cornerRadius
-                        );
-
-                        // Get background color for this control type
-                        //COLORREF bgColor = GetColorForControlType(target.controlTypeId);
-                        ID2D1SolidColorBrush* bgBrush = nullptr;
-
-                        auto it = brushCache.find(controlTypeId);
-
-                        if (it != brushCache.end()) {
-                            bgBrush = it->second; // Use cached
-                        }
-                        else {
-                            COLORREF bgColor = GetColorForControlType(controlTypeId);
-
-                            float r = ((bgColor >> 0) & 0xFF) / 255.0f;
-                            float g = ((bgColor >> 8) & 0xFF) / 255.0f;
-                            float b = ((bgColor >> 16) & 0xFF) / 255.0f;
-                            if (SUCCEEDED(renderTarget->CreateSolidColorBrush(D2D1::ColorF(r, g, b), &bgBrush))) {
-                                brushCache[controlTypeId] = bgBrush; // Cache for future use
-                            }
-                            else {
-                                bgBrush = nullptr; // Failed to create brush
-							}
-                        }
-
-                        // Draw background and border
-                        renderTarget->FillRoundedRectangle(roundedRect, bgBrush);
-
-                        renderTarget->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
-                        //renderTarget->SetAntialiasMode(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE);
-                        renderTarget->DrawRoundedRectangle(roundedRect, borderBrush, 1.2f);
-                        renderTarget->SetAntialiasMode(D2D1_ANTIALIAS_MODE_PER_PRIMITIVE);
-
-                        // Draw text
-                        renderTarget->DrawTextLayout(D2D1::Point2F(boxX + padX, boxY + padY), textLayout, blackTextBrush);
-                    }
+        POINT dst = { image.bounds.left, image.bounds.top };
+        SIZE size = { image.bounds.Width(), image.bounds.Height() };
+        POINT src = { 0, 0 };
 
-                    if (textLayout) {
-                        textLayout->Release();
-                    }
-                }
-            }
+        BLENDFUNCTION blend = {};
+        blend.BlendOp = AC_SRC_OVER;
+        blend.SourceConstantAlpha = 255;
+        blend.AlphaFormat = AC_SRC_ALPHA;
 
-            if (borderBrush) borderBrush->Release();
-            if (blackTextBrush) blackTextBrush->Release();
-            renderTarget->EndDraw();
-            EndPaint(hwnd, &ps);
-            return 0;
-        }
+        UpdateLayeredWindow(hwnd, nullptr, &dst, &size, memDC, &src, 0, &blend, ULW_ALPHA);
 
-        case WM_DESTROY:
-            RemoveProp(hwnd, L"HINTTARGETS");
-            RemoveProp(hwnd, L"LABELS");
+        SelectObject(memDC, oldBmp);
+        DeleteDC(memDC);
 
-            for (auto& pair : brushCache) {
-                if (pair.second) {
-                    pair.second->Release();
-                    pair.second = nullptr;
-                }
+        ShowWindow(hwnd, SW_SHOWNOACTIVATE);
+    }
+
+    static void RenderThreadMain() {
+        for (;;) {
+            RenderRequest request;
+            {
+                std::unique_lock<std::mutex> lock(renderMutex);
+                renderWake.wait(lock, []() { return renderStopping || hasRequest; });
+                if (renderStopping) return;
+                request = std::move(pendingRequest);
+                hasRequest = false;
             }
-            brushCache.clear();
 
-            if (renderTarget) { renderTarget->Release(); renderTarget = nullptr; }
-            if (textFormat) { textFormat->Release(); textFormat = nullptr; }
-            if (dwriteFactory) { dwriteFactory->Release(); dwriteFactory = nullptr; }
-            if (d2dFactory) { d2dFactory->Release(); d2dFactory = nullptr; }
-            break;
+            OverlayImage image = RenderOverlay(request.job);
+
+            std::lock_guard<std::mutex> lock(renderMutex);
+            if (request.generation != latestGeneration) {
+                // Superseded or closed while it rendered
+                if (image.bitmap) DeleteObject(image.bitmap);
+                continue;
+            }
+            if (readyImage.bitmap) DeleteObject(readyImage.bitmap);
+            readyImage = image;
+            readyGeneration = request.generation;
+            PostMessage(request.hwnd, WM_OVERLAY_READY, 0, 0);
         }
+    }
 
-        return DefWindowProc(hwnd, msg, wParam, lParam);
+    // Drops the queued job and any unpresented image; a render in flight is dropped when it
+    // finishes. Doesn't wait.
+    static void DiscardPendingImage() {
+        std::lock_guard<std::mutex> lock(renderMutex);
+        ++latestGeneration;
+        hasRequest = false;
+        pendingRequest = RenderRequest();
+        if (readyImage.bitmap) DeleteObject(readyImage.bitmap);
+        readyImage = OverlayImage();
+        readyGeneration = 0;
     }
 
+    LRESULT CALLBACK OverlayWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+        switch (msg) {
+        case WM_OVERLAY_READY: {
+            OverlayImage image;
+            {
+                std::lock_guard<std::mutex> lock(renderMutex);
+                const bool current = readyGeneration != 0 && readyGeneration == latestGeneration;
+                if (!current && readyImage.bitmap) DeleteObject(readyImage.bitmap);
+                if (current) image = readyImage;
+                readyImage = OverlayImage();
+                readyGeneration = 0;
+                // Already presented by an earlier message, or stale
+                if (!current) return 0;
+            }
+            if (image.bitmap) {
+                PresentOverlayImage(hwnd, image);
+                DeleteObject(image.bitmap);
+            }
+            else {
+                ShowWindow(hwnd, SW_HIDE);
+            }
+            return 0;
+        }
+        }
 
-    void ShowHintOverlay(HINSTANCE hInstance, const std::vector<HintTarget>& hintTargets, const std::vector<std::wstring>& labels) {
-        if (overlayWnd) return;
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+    }
 
-        int virtualWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
-        int virtualHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
-        int virtualLeft = GetSystemMetrics(SM_XVIRTUALSCREEN);
-        int virtualTop = GetSystemMetrics(SM_YVIRTUALSCREEN);
 
+    static HWND CreateOverlayWindow(HINSTANCE hInstance, const Rect& screen) {
         const wchar_t CLASS_NAME[] = L"HintOverlayWindow";
 
         WNDCLASS wc = {};
@@ -249,36 +335,173 @@ namespace hint_map {
         wc.hbrBackground = (HBRUSH)GetStockObject(NULL_BRUSH);
         RegisterClass(&wc);
 
+        // Stays hidden until the render worker has produced the label image
         HWND hwnd = CreateWindowEx(
             WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOPMOST,
             CLASS_NAME,
             NULL,
             WS_POPUP,
-            virtualLeft, virtualTop, virtualWidth, virtualHeight,
+            screen.left, screen.top, screen.Width(), screen.Height(),
             NULL, NULL, hInstance, NULL
         );
 
         if (!hwnd) {
             MessageBox(NULL, L"Failed to create overlay window!", L"Error", MB_OK | MB_ICONERROR);
-            return;
 		}
-        SetLayeredWindowAttributes(hwnd, RGB(255, 0, 255), 0, LWA_COLORKEY);
-        SetProp(hwnd, L"HINTTARGETS", (HANDLE)&hintTargets);
-        SetProp(hwnd, L"LABELS", (HANDLE)&labels);
+        return hwnd;
+    }
+
+    // Hands a job to the render thread; the window presents the result when it's ready.
+    // It replaces a job that hasn't started, and a render in flight is dropped when it ends.
+    static void SubmitOverlayJob(HWND hwnd, OverlayJob job) {
+        if (!renderThread.joinable()) {
+            renderStopping = false;
+            renderThread = std::thread(RenderThreadMain);
+        }
+        {
+            std::lock_guard<std::mutex> lock(renderMutex);
+            pendingRequest.job = std::move(job);
+            pendingRequest.hwnd = hwnd;
+            pendingRequest.generation = ++latestGeneration;
+            hasRequest = true;
+        }
+        renderWake.notify_one();
+    }
+
+    void ShowHintOverlay(HINSTANCE hInstance, const std::vector<HintTarget>& hintTargets, const std::vector<std::wstring>& labels) {
+        if (overlayWnd) return;
+        ScopedLatencyTimer timer(LatencyMetric::ShowOverlay);
+        ScopedTrace trace("Create overlay");
+
+        const MonitorTopology& topology = CurrentMonitorTopology();
+        const Rect& screen = topology.VirtualScreen();
+
+        HWND hwnd = CreateOverlayWindow(hInstance, screen);
+        if (!hwnd) return;
+
+        OverlayJob job;
+        job.screen = screen;
+        job.labels = labels;
+        job.targets.reserve(hintTargets.size());
+        job.controlTypes.reserve(hintTargets.size());
+
+        Rect targetBounds;
+        for (const auto& t : hintTargets) {
+            Rect r = MakeRect(t.rect.left, t.rect.top, t.rect.right, t.rect.bottom);
+            if (job.targets.empty()) targetBounds = r;
+            targetBounds.left = (std::min)(targetBounds.left, r.left);
+            targetBounds.top = (std::min)(targetBounds.top, r.top);
+            targetBounds.right = (std::max)(targetBounds.right, r.right);
+            targetBounds.bottom = (std::max)(targetBounds.bottom, r.bottom);
+            job.targets.push_back(r);
+            job.controlTypes.push_back(t.controlTypeId);
+        }
+
+        // Labels are sized for the monitor the targets are on
+        int monitor = topology.FindMonitorForRect(targetBounds);
+        job.dpiScale = (monitor >= 0) ? topology.Monitors()[monitor].Scale() : 1.0f;
 
-        ShowWindow(hwnd, SW_SHOWNOACTIVATE);
-        UpdateWindow(hwnd);
         overlayWnd = hwnd;
+        hintJob = job;
+        SubmitOverlayJob(hwnd, std::move(job));
+    }
+
+    void SetHintSelection(int index) {
+        if (!overlayWnd || hintJob.targets.empty() || hintJob.selected == index) return;
+        hintJob.selected = index;
+        SubmitOverlayJob(overlayWnd, hintJob);
+    }
+
+    // Into the job's own strings, reusing their storage
+    static void CopyLabels(const ArenaVector<ArenaWString>& labels, std::vector<std::wstring>& out) {
+        out.resize(labels.size());
+        for (size_t i = 0; i < labels.size(); ++i) out[i].assign(labels[i].data(), labels[i].size());
+    }
+
+    void SetHintLabels(const ArenaVector<ArenaWString>& labels, int selected) {
+        if (!overlayWnd || hintJob.targets.empty()) return;
+        CopyLabels(labels, hintJob.labels);
+        hintJob.selected = selected;
+        SubmitOverlayJob(overlayWnd, hintJob);
+    }
+
+    void SetHintMarks(const ArenaVector<char>& marked) {
+        if (!overlayWnd || hintJob.targets.empty()) return;
+        hintJob.marked.assign(marked.begin(), marked.end());
+        SubmitOverlayJob(overlayWnd, hintJob);
+    }
+
+    void UpdateHintTargets(const std::vector<HintTarget>& hintTargets, const ArenaVector<ArenaWString>& labels,
+        const ArenaVector<char>& marked) {
+        if (!overlayWnd || hintJob.targets.empty()) return;
+        CopyLabels(labels, hintJob.labels);
+        hintJob.selected = -1;
+        hintJob.marked.assign(marked.begin(), marked.end());
+        hintJob.targets.clear();
+        hintJob.controlTypes.clear();
+        for (const auto& t : hintTargets) {
+            hintJob.targets.push_back(MakeRect(t.rect.left, t.rect.top, t.rect.right, t.rect.bottom));
+            hintJob.controlTypes.push_back(t.controlTypeId);
+        }
+        SubmitOverlayJob(overlayWnd, hintJob);
+    }
+
+    void ShowGridOverlay(HINSTANCE hInstance, const std::vector<Rect>& cells, const std::vector<std::wstring>& labels) {
+        ScopedTrace trace("Grid overlay");
+        const MonitorTopology& topology = CurrentMonitorTopology();
+        const Rect& screen = topology.VirtualScreen();
+
+        // Reuse the window between levels; only the label image changes
+        if (!overlayWnd) {
+            overlayWnd = CreateOverlayWindow(hInstance, screen);
+            if (!overlayWnd) return;
+        }
+
+        OverlayJob job;
+        job.screen = screen;
+        job.labels = labels;
+        job.targets = cells;
+        job.controlTypes.assign(cells.size(), 0);
+        job.centered = true;
+
+        Rect area = cells.empty() ? Rect() : cells.front();
+        for (const Rect& c : cells) {
+            area.left = (std::min)(area.left, c.left);
+            area.top = (std::min)(area.top, c.top);
+            area.right = (std::max)(area.right, c.right);
+            area.bottom = (std::max)(area.bottom, c.bottom);
+        }
+        int monitor = topology.FindMonitorForRect(area);
+        job.dpiScale = (monitor >= 0) ? topology.Monitors()[monitor].Scale() : 1.0f;
+
+        SubmitOverlayJob(overlayWnd, std::move(job));
     }
 
     void CloseHintOverlay() {
+        DiscardPendingImage();
+        hintJob = OverlayJob();
         if (overlayWnd) {
             DestroyWindow(overlayWnd);
             overlayWnd = nullptr;
         }
     }
 
+    void ShutdownHintOverlay() {
+        CloseHintOverlay();
+        if (!renderThread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(renderMutex);
+            renderStopping = true;
+        }
+        renderWake.notify_one();
+        renderThread.join();
+        // The last render may have finished after the close
+        DiscardPendingImage();
+    }
+
     std::vector<std::wstring> GenerateHintLabels(int count) {
+        ScopedLatencyTimer timer(LatencyMetric::GenerateLabels);
+        ScopedTrace trace("Generate labels");
         const std::wstring singles = L"EMCGHWLP";    // single-letter hints, used first
         const std::wstring doubles = L"ASDFJKIO";      // prefixes for two-letter hints
 
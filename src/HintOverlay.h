@@ -4,11 +4,33 @@
 #include <vector>
 #include <string>
 #include "UIElementScanner.h"
+#include "Geometry.h"
+#include "ActivationArena.h"
 
 namespace hint_map {
 
 	void ShowHintOverlay(HINSTANCE hInstance, const std::vector<HintTarget>& hintTargets, const std::vector<std::wstring>& labels);
 	void CloseHintOverlay();
+	// Closes the overlay and stops the render thread (at exit)
+	void ShutdownHintOverlay();
+
+	// Highlights one hint label (walk mode); -1 clears the highlight
+	void SetHintSelection(int index);
+
+	// Replaces the hint labels in place (empty hides a target) and sets the highlight.
+	// Labels and marks come from the input handler's activation arena; the overlay copies them.
+	void SetHintLabels(const ArenaVector<ArenaWString>& labels, int selected);
+
+	// Draws the marked labels as queued (multi-select); empty clears every mark
+	void SetHintMarks(const ArenaVector<char>& marked);
+
+	// Replaces the targets, labels and marks of the open hint overlay (after a partial rescan)
+	void UpdateHintTargets(const std::vector<HintTarget>& hintTargets, const ArenaVector<ArenaWString>& labels,
+		const ArenaVector<char>& marked);
+
+	// Labels centred in each cell; opens the overlay or updates it in place
+	void ShowGridOverlay(HINSTANCE hInstance, const std::vector<Rect>& cells, const std::vector<std::wstring>& labels);
+
 	std::vector<std::wstring> GenerateHintLabels(int count);
 
 }
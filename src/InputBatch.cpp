@@ -0,0 +1,142 @@
+// InputBatch.cpp
+
+#include "InputBatch.h"
+#include <algorithm>
+
+namespace shortcut {
+
+    // Keys whose scan code needs the E0 prefix
+    static bool IsExtendedKey(WORD vk) {
+        switch (vk) {
+        case VK_RMENU: case VK_RCONTROL:
+        case VK_INSERT: case VK_DELETE: case VK_HOME: case VK_END: case VK_PRIOR: case VK_NEXT:
+        case VK_LEFT: case VK_RIGHT: case VK_UP: case VK_DOWN:
+        case VK_NUMLOCK: case VK_DIVIDE: case VK_SNAPSHOT:
+        case VK_LWIN: case VK_RWIN: case VK_APPS:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void InputBatch::AddKey(WORD vk, WORD scan, DWORD flags) {
+        INPUT input = {};
+        input.type = INPUT_KEYBOARD;
+        input.ki.wVk = vk;
+        input.ki.wScan = scan;
+        input.ki.dwFlags = flags;
+        inputs.push_back(input);
+    }
+
+    InputBatch& InputBatch::KeyDown(WORD vk) {
+        AddKey(vk, (WORD)MapVirtualKey(vk, MAPVK_VK_TO_VSC), IsExtendedKey(vk) ? KEYEVENTF_EXTENDEDKEY : 0);
+        return *this;
+    }
+
+    InputBatch& InputBatch::KeyUp(WORD vk) {
+        AddKey(vk, (WORD)MapVirtualKey(vk, MAPVK_VK_TO_VSC), KEYEVENTF_KEYUP | (IsExtendedKey(vk) ? KEYEVENTF_EXTENDEDKEY : 0));
+        return *this;
+    }
+
+    InputBatch& InputBatch::Tap(WORD vk, int count) {
+        inputs.reserve(inputs.size() + 2 * (size_t)(std::max)(count, 0));
+        for (int i = 0; i < count; ++i) {
+            KeyDown(vk);
+            KeyUp(vk);
+        }
+        return *this;
+    }
+
+    InputBatch& InputBatch::Text(const std::wstring& text) {
+        inputs.reserve(inputs.size() + 2 * text.size());
+        for (wchar_t ch : text) {
+            if (ch == L'\r') continue;
+            if (ch == L'\n') { Tap(VK_RETURN); continue; }
+            if (ch == L'\t') { Tap(VK_TAB); continue; }
+
+            // Surrogate pairs go through as two UTF-16 units, which is what KEYEVENTF_UNICODE expects
+            AddKey(0, (WORD)ch, KEYEVENTF_UNICODE);
+            AddKey(0, (WORD)ch, KEYEVENTF_UNICODE | KEYEVENTF_KEYUP);
+        }
+        return *this;
+    }
+
+    InputBatch& InputBatch::MoveTo(int x, int y) {
+        // Absolute coordinates are normalised to 0..65535 across the virtual desktop
+        const int left = GetSystemMetrics(SM_XVIRTUALSCREEN);
+        const int top = GetSystemMetrics(SM_YVIRTUALSCREEN);
+        const int width = (std::max)(GetSystemMetrics(SM_CXVIRTUALSCREEN) - 1, 1);
+        const int height = (std::max)(GetSystemMetrics(SM_CYVIRTUALSCREEN) - 1, 1);
+
+        INPUT input = {};
+        input.type = INPUT_MOUSE;
+        input.mi.dx = (LONG)(((long long)(x - left) * 65535 + width / 2) / width);
+        input.mi.dy = (LONG)(((long long)(y - top) * 65535 + height / 2) / height);
+        input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK;
+        inputs.push_back(input);
+        return *this;
+    }
+
+    InputBatch& InputBatch::ClickAt(int x, int y) {
+        MoveTo(x, y);
+        INPUT input = {};
+        input.type = INPUT_MOUSE;
+        input.mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
+        inputs.push_back(input);
+        input.mi.dwFlags = MOUSEEVENTF_LEFTUP;
+        inputs.push_back(input);
+        return *this;
+    }
+
+    bool InputBatch::Send() {
+        if (inputs.empty()) return true;
+
+        UINT sent = SendInput((UINT)inputs.size(), inputs.data(), sizeof(INPUT));
+        if (sent == inputs.size()) return true;
+
+        // Partial send: release whatever the inserted prefix left held down
+        std::vector<INPUT> release;
+        bool leftButtonDown = false;
+        for (UINT i = 0; i < sent; ++i) {
+            if (inputs[i].type == INPUT_MOUSE) {
+                if (inputs[i].mi.dwFlags & MOUSEEVENTF_LEFTDOWN) leftButtonDown = true;
+                if (inputs[i].mi.dwFlags & MOUSEEVENTF_LEFTUP) leftButtonDown = false;
+                continue;
+            }
+            if (inputs[i].type != INPUT_KEYBOARD) continue;
+
+            const KEYBDINPUT& k = inputs[i].ki;
+            const bool up = (k.dwFlags & KEYEVENTF_KEYUP) != 0;
+            auto same = [&k](const INPUT& in) {
+                return in.ki.wVk == k.wVk && (k.wVk != 0 || in.ki.wScan == k.wScan);
+            };
+            auto held = std::find_if(release.begin(), release.end(), same);
+            if (up) {
+                if (held != release.end()) release.erase(held);
+            }
+            else if (held == release.end()) {
+                INPUT r = inputs[i];
+                r.ki.dwFlags |= KEYEVENTF_KEYUP;
+                release.push_back(r);
+            }
+        }
+
+        if (leftButtonDown) {
+            INPUT up = {};
+            up.type = INPUT_MOUSE;
+            up.mi.dwFlags = MOUSEEVENTF_LEFTUP;
+            release.insert(release.begin(), up);
+        }
+
+        if (!release.empty()) {
+            std::reverse(release.begin(), release.end());
+            SendInput((UINT)release.size(), release.data(), sizeof(INPUT));
+        }
+
+        wchar_t buf[96];
+        swprintf(buf, 96, L"[shortcut] SendInput inserted %u of %u events.\n", sent, (UINT)inputs.size());
+        OutputDebugString(buf);
+        return false;
+    }
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+
+namespace shortcut {
+
+    // Builds one INPUT array for a synthetic action and submits it with a single SendInput,
+    // so the whole sequence is inserted atomically and nothing sleeps between events.
+    class InputBatch {
+    public:
+        InputBatch& KeyDown(WORD vk);
+        InputBatch& KeyUp(WORD vk);
+        InputBatch& Tap(WORD vk, int count = 1);
+
+        // Types text as KEYEVENTF_UNICODE events; '\n' and '\t' become Enter and Tab
+        InputBatch& Text(const std::wstring& text);
+
+        // Absolute cursor move in virtual-screen pixels, and a left click at that point
+        InputBatch& MoveTo(int x, int y);
+        InputBatch& ClickAt(int x, int y);
+
+        size_t Size() const { return inputs.size(); }
+        void Clear() { inputs.clear(); }
+
+        // Returns true if every event was inserted. If SendInput stops part-way (UIPI or
+        // another thread's input), keys and buttons this batch left pressed are released.
+        bool Send();
+
+    private:
+        void AddKey(WORD vk, WORD scan, DWORD flags);
+
+        std::vector<INPUT> inputs;
+    };
+
+}
@@ -0,0 +1,131 @@
+// InputCore.cpp
+
+#include "InputCore.h"
+#include <cstring>
+
+namespace hint_map {
+
+    static const char INPUT_LOG_MAGIC[8] = { 'N', 'K', 'I', 'N', 'P', 'U', 'T', '1' };
+    static const size_t INPUT_LOG_RECORD = 6;
+
+    int InputCore::AddChord(const std::vector<uint32_t>& chordKeys) {
+        if (chords.size() >= MAX_CHORDS) return -1;
+        Chord chord;
+        for (uint32_t vk : chordKeys) {
+            if (vk < 256) chord.mask.set(vk);
+        }
+        chords.push_back(chord);
+        return (int)chords.size() - 1;
+    }
+
+    void InputCore::ClearChords() {
+        chords.clear();
+    }
+
+    void InputCore::SetKey(uint32_t vk, bool down) {
+        if (vk < 256) keys.set(vk, down);
+    }
+
+    void InputCore::ClearKeys() {
+        keys.reset();
+    }
+
+    InputStep InputCore::Step(uint32_t vk, bool down, bool overlayActive) {
+        InputStep step;
+
+        // Insert-mode toggle by Ctrl tap
+        if (vk == KEY_LCONTROL || vk == KEY_RCONTROL || vk == KEY_CONTROL) {
+            if (down) { ctrlDown = true; ctrlUsedWithOtherKey = false; }
+            else {
+                if (!ctrlUsedWithOtherKey) {
+                    insertMode = !insertMode;
+                    step.modeToggled = true;
+                }
+                ctrlDown = false;
+            }
+        }
+        else if (down && ctrlDown) {
+            ctrlUsedWithOtherKey = true;
+        }
+        step.insertMode = insertMode;
+
+        // Shortcuts only in command mode
+        if (insertMode) return step;
+
+        for (size_t i = 0; i < chords.size(); ++i) {
+            Chord& chord = chords[i];
+            const bool pressed = (keys & chord.mask) == chord.mask;
+            if (pressed && !chord.lastPressed) step.firedChords |= (uint64_t)1 << i;
+            chord.lastPressed = pressed;
+        }
+
+        // Continuous scrolling is blocked while the hint overlay is up
+        if (!overlayActive && keys.count() == 2) {
+            if (keys['D'] && keys['F']) step.scroll = -1;
+            if (keys['J'] && keys['K']) step.scroll = +1;
+        }
+
+        return step;
+    }
+
+    void KeyEventHistory::Push(const KeyEvent& e) {
+        if (events.empty()) return;
+        events[next] = e;
+        next = (next + 1) % events.size();
+        if (count < events.size()) ++count;
+    }
+
+    std::vector<KeyEvent> KeyEventHistory::Snapshot() const {
+        std::vector<KeyEvent> out;
+        out.reserve(count);
+        size_t start = (next + events.size() - count) % (events.empty() ? 1 : events.size());
+        for (size_t i = 0; i < count; ++i) {
+            out.push_back(events[(start + i) % events.size()]);
+        }
+        return out;
+    }
+
+    std::vector<uint8_t> EncodeInputLog(const std::vector<KeyEvent>& events) {
+        std::vector<uint8_t> out(sizeof(INPUT_LOG_MAGIC) + events.size() * INPUT_LOG_RECORD);
+        memcpy(out.data(), INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC));
+
+        uint8_t* p = out.data() + sizeof(INPUT_LOG_MAGIC);
+        uint64_t previous = events.empty() ? 0 : events.front().timestampUs;
+        for (const KeyEvent& e : events) {
+            uint64_t delta64 = e.timestampUs >= previous ? e.timestampUs - previous : 0;
+            uint32_t delta = delta64 > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)delta64;
+            previous = e.timestampUs;
+
+            p[0] = (uint8_t)delta;
+            p[1] = (uint8_t)(delta >> 8);
+            p[2] = (uint8_t)(delta >> 16);
+            p[3] = (uint8_t)(delta >> 24);
+            p[4] = (uint8_t)e.vk;
+            p[5] = e.flags;
+            p += INPUT_LOG_RECORD;
+        }
+        return out;
+    }
+
+    bool DecodeInputLog(const uint8_t* data, size_t size, std::vector<KeyEvent>& events) {
+        events.clear();
+        if (size < sizeof(INPUT_LOG_MAGIC) || memcmp(data, INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC)) != 0) return false;
+        if ((size - sizeof(INPUT_LOG_MAGIC)) % INPUT_LOG_RECORD != 0) return false;
+
+        const uint8_t* p = data + sizeof(INPUT_LOG_MAGIC);
+        const size_t n = (size - sizeof(INPUT_LOG_MAGIC)) / INPUT_LOG_RECORD;
+        events.reserve(n);
+
+        uint64_t t = 0;
+        for (size_t i = 0; i < n; ++i, p += INPUT_LOG_RECORD) {
+            t += (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+            KeyEvent e;
+            e.timestampUs = t;
+            e.vk = p[4];
+            e.flags = p[5];
+            events.push_back(e);
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,104 @@
+// InputCore.h
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hint_map {
+
+    // Virtual-key codes the core needs, so it builds without Windows headers
+    static const uint32_t KEY_CONTROL = 0x11;   // VK_CONTROL
+    static const uint32_t KEY_LCONTROL = 0xA2;  // VK_LCONTROL
+    static const uint32_t KEY_RCONTROL = 0xA3;  // VK_RCONTROL
+
+    enum KeyEventFlags : uint8_t {
+        KEY_EVENT_DOWN = 1 << 0,
+        KEY_EVENT_SWALLOWED = 1 << 1,   // the hook kept the key from the foreground app
+        KEY_EVENT_OVERLAY = 1 << 2,     // the hint overlay was taking input at the time
+        KEY_EVENT_CONSUMED = 1 << 3,    // the overlay took the key (label letter, Esc, grid keys)
+    };
+
+    struct KeyEvent {
+        uint64_t timestampUs = 0;       // steady clock, microseconds
+        uint32_t vk = 0;
+        uint8_t flags = 0;
+
+        bool IsDown() const { return (flags & KEY_EVENT_DOWN) != 0; }
+    };
+
+    // What one key event did to the mode/shortcut state
+    struct InputStep {
+        bool modeToggled = false;
+        bool insertMode = true;
+        uint64_t firedChords = 0;       // bit i: chord i became fully pressed on this event
+        int scroll = 0;                 // +1 up, -1 down while a scroll chord is held
+    };
+
+    // Platform-neutral key processing: the pressed-key set, the Ctrl-tap insert/command
+    // mode toggle and chord edge detection. The platform layer feeds it events in order
+    // and acts on the returned InputStep; a recorded log can be replayed through it offline.
+    class InputCore {
+    public:
+        static const size_t MAX_CHORDS = 64;
+
+        // Returns the chord index used in InputStep::firedChords, or -1 when full.
+        int AddChord(const std::vector<uint32_t>& keys);
+        void ClearChords();
+
+        void SetKey(uint32_t vk, bool down);
+        void ClearKeys();
+        bool IsKeyDown(uint32_t vk) const { return vk < 256 && keys[vk]; }
+        size_t KeysDownCount() const { return keys.count(); }
+
+        bool IsInsertMode() const { return insertMode; }
+
+        // Mode toggle and chord matching for an event whose key state was already applied
+        // with SetKey and that the overlay did not consume.
+        InputStep Step(uint32_t vk, bool down, bool overlayActive);
+
+    private:
+        struct Chord {
+            std::bitset<256> mask;
+            bool lastPressed = false;
+        };
+
+        std::bitset<256> keys;
+        std::vector<Chord> chords;
+        bool insertMode = true;
+        bool ctrlDown = false;
+        bool ctrlUsedWithOtherKey = false;
+    };
+
+    // Keeps the most recent events, overwriting the oldest.
+    class KeyEventHistory {
+    public:
+        explicit KeyEventHistory(size_t capacity = 4096) : events(capacity) {}
+
+        void Push(const KeyEvent& e);
+        std::vector<KeyEvent> Snapshot() const;   // oldest first
+
+    private:
+        std::vector<KeyEvent> events;
+        size_t next = 0;
+        size_t count = 0;
+    };
+
+    // Compact binary log: an 8-byte magic, then 6 bytes per event
+    // (u32 microseconds since the previous event, u8 vk, u8 flags), little endian.
+    std::vector<uint8_t> EncodeInputLog(const std::vector<KeyEvent>& events);
+    bool DecodeInputLog(const uint8_t* data, size_t size, std::vector<KeyEvent>& events);
+
+    // Feeds a recorded session through core the way the live consumer does.
+    // fn(const KeyEvent&, const InputStep&) is called for events the overlay did not take.
+    template <typename Fn>
+    void ReplayInputLog(InputCore& core, const std::vector<KeyEvent>& events, Fn fn) {
+        for (const KeyEvent& e : events) {
+            core.SetKey(e.vk, e.IsDown());
+            if (e.flags & KEY_EVENT_CONSUMED) continue;
+            fn(e, core.Step(e.vk, e.IsDown(), (e.flags & KEY_EVENT_OVERLAY) != 0));
+        }
+    }
+
+}
@@ -13,38 +13,157 @@
 #include <map>
 #include <algorithm>
 #include <unordered_set>
-#include "global.h"
+#include <bitset>
+#include "InputCore.h"
+#include "KeyEventRing.h"
+#include "LatencyStats.h"
+#include "TraceRecorder.h"
+#include "ScrollEngine.h"
+#include "InputBatch.h"
+#include "FocusTracker.h"
+#include "WindowSwitcher.h"
+#include "GridNavigator.h"
+#include "MonitorCache.h"
+#include "VisionTargets.h"
+#include "SpatialIndex.h"
+#include "NameIndex.h"
+#include "TargetBuckets.h"
+#include "Occlusion.h"
+#include "ScanWorker.h"
+#include "LabelDiff.h"
+#include "ActivationArena.h"
+#include "HeapCounter.h"
+#include "TextNavigator.h"
+#include "BatchActions.h"
 
 static std::vector<hint_map::HintTarget> currentTargets;
 static std::vector<std::wstring> currentLabels;
 static bool overlayActive = false;
 
-// Global key-state set (already declared in global.h)
-std::unordered_set<UINT> keysDown;
-
 namespace hint_map {
 
     // --- Raw Input sink window state ---
     static HWND s_inputWnd = nullptr;
     static HINSTANCE s_hInst = nullptr;
 
+    // Posted to the sink window when the hook thread queues the first key of a burst
+    static const UINT WM_DRAIN_KEYS = WM_APP + 2;
+
+    // Hook thread -> UI thread key events. The hook only decides swallow/pass and pushes;
+    // shortcuts, overlay typing and UIA calls all run when the UI thread drains the ring.
+    static SpscRing<KeyEvent, 1024> s_keyQueue;
+    static std::atomic<bool> s_drainPosted{ false };
+    static std::atomic<unsigned> s_droppedKeys{ 0 };
+
+    // Key state, mode toggle and chord matching (UI thread only)
+    static InputCore s_core;
+    // Mode tracking on the hook thread, fed the same events so its swallow decision
+    // never waits for the UI thread to catch up
+    static InputCore s_hookCore;
+    // Recent events for the input log (UI thread only)
+    static KeyEventHistory s_history;
+
+    // Per-activation scratch (UI thread), dropped in one step when the overlay closes
+    static ActivationArena s_arena;
+
     // Overlay input state (reusing your earlier fields but without hooks)
-    static std::wstring typedBuffer;
+    static ArenaWString typedBuffer{ ArenaAllocator<wchar_t>(s_arena) };
     static std::vector<HintTarget> g_targets;
-    static std::vector<std::wstring> g_labels;
+    static ArenaVector<ArenaWString> g_labels{ ArenaAllocator<ArenaWString>(s_arena) };
     static std::function<void()> g_onCancel;
     static std::atomic<bool> overlayInputActive{ false };
 
-    // App mode state (moved here from main.cpp)
-    static bool insertMode = true;
-    static bool ctrlDown = false;
-    static bool ctrlUsedWithOtherKey = false;
+    // Grid fallback (UI thread); the flag tells the hook to also claim Enter/Space/Backspace
+    static GridNavigator g_grid;
+    static std::atomic<bool> gridInputActive{ false };
+    // Keys already down when the grid opened (the chord's own S or D among them): their
+    // autorepeat must not pick a cell. Each bit clears on that key's release.
+    static std::bitset<256> s_gridHeld;
+
+    // What the arena doesn't hold: operator new calls on this thread from the activation's
+    // shortcut until the overlay closes
+    static uint64_t s_heapAtActivation = 0;
+    static bool s_countingHeap = false;
+
+    // Walk mode (UI thread): Tab over the hints, then h/j/k/l or arrows move the selection
+    static SpatialIndex s_walkIndex;
+    static ArenaVector<Rect> s_targetRects{ ArenaAllocator<Rect>(s_arena) };   // per target, to rebuild the index for a subset
+    static ArenaVector<int> s_walkTargets{ ArenaAllocator<int>(s_arena) };     // walk index item -> target
+    static ArenaVector<int> s_walkItem{ ArenaAllocator<int>(s_arena) };        // target -> walk index item, -1 if filtered out
+    static bool walkMode = false;
+    static int walkSelection = -1;              // target index
+
+    // Text mode (UI thread): the targets are word and line starts of the focused text, and
+    // picking one moves the caret there; Shift + label extends the selection instead
+    static bool textMode = false;
+
+    // Multi-select (UI thread): after Space, labels queue their targets instead of acting,
+    // and Enter runs the queue as one batch on the batch worker. Entries are copies, so one
+    // a scroll rescan drops from view still runs.
+    static bool multiSelect = false;
+    static ArenaVector<HintTarget> s_queue{ ArenaAllocator<HintTarget>(s_arena) };   // in the order picked
+    static ArenaVector<int> s_queueTarget{ ArenaAllocator<int>(s_arena) };   // per entry: its target index, -1 while scrolled away
+    static ArenaVector<char> s_marked{ ArenaAllocator<char>(s_arena) };      // per target: queued
+
+    // Scrolled lists (UI thread): while hints are up, scrolling in the hinted window rescans
+    // only the container under the cursor, once the scrolling settles
+    static HWINEVENTHOOK s_scrollHook = nullptr;
+    static HWND s_hintWindow = nullptr;
+    static const UINT_PTR SCROLL_RESCAN_TIMER = 1;
+    static const UINT SCROLL_SETTLE_MS = 80;
+
+    // Type filter (UI thread): Shift + letter keeps only one family of control types
+    static TargetBuckets s_buckets;
+    static uint64_t typeFilter = TargetBuckets::ALL;
+
+    // Search mode (UI thread): "/" then text narrows the hints to targets whose name matches.
+    // The index is built on the first "/" of an activation, so plain label use pays nothing.
+    static NameIndex s_nameIndex;
+    static bool searchMode = false;
+    static ArenaWString searchQuery{ ArenaAllocator<wchar_t>(s_arena) };
+    static ArenaVector<int> searchResults{ ArenaAllocator<int>(s_arena) };
+    static int searchRank = 0;
+
+    // Back to plain label typing, dropping per-activation walk and search state
+    static void ResetHintSubModes() {
+        walkMode = false;
+        walkSelection = -1;
+        searchMode = false;
+        searchQuery.clear();
+        searchResults.clear();
+        searchRank = 0;
+    }
+
+    // App mode state, published for the hook thread
+    static std::atomic<bool> insertMode{ true };
 
-    bool IsInsertMode() { return insertMode; }
+    bool IsInsertMode() { return insertMode.load(); }
 
     // Add (next to the existing state):
     static bool g_useLowLevelHook = true; // when true, WM_INPUT won't double-process
 
+    static uint64_t NowMicroseconds() {
+        static LARGE_INTEGER freq = []() { LARGE_INTEGER f; QueryPerformanceFrequency(&f); return f; }();
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000ull
+            + (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000ull / (uint64_t)freq.QuadPart;
+    }
+
+    // Keys the overlay takes while it is up. Walk keys are claimed whether or not walk mode
+    // is on yet, so a Tab followed quickly by an arrow never leaks the arrow to the app.
+    static bool IsOverlayKey(UINT vk, bool grid) {
+        if (vk == VK_ESCAPE || (vk >= 'A' && vk <= 'Z')) return true;
+        if (grid) return vk == VK_RETURN || vk == VK_SPACE || vk == VK_BACK;
+        // Walk keys, then search keys ("/" on US layouts, then text)
+        if (vk == VK_TAB || vk == VK_RETURN || (vk >= VK_LEFT && vk <= VK_DOWN)) return true;
+        return vk == VK_OEM_2 || vk == VK_SPACE || vk == VK_BACK || (vk >= '0' && vk <= '9');
+    }
+
+    static bool IsCtrlKey(UINT vk) {
+        return vk == VK_LCONTROL || vk == VK_RCONTROL || vk == VK_CONTROL;
+    }
+
     bool IsOverlayActive() { return overlayInputActive.load(); }
 
 
@@ -94,39 +213,430 @@ namespace hint_map {
 
         return false;
     }*/
+    static void ShowGridLevel() {
+        std::vector<Rect> cells;
+        std::vector<std::wstring> labels;
+        for (int i = 0; i < GridNavigator::CELLS; ++i) {
+            cells.push_back(g_grid.Cell(i));
+            labels.emplace_back(1, (wchar_t)GridNavigator::CellKey(i));
+        }
+        ShowGridOverlay(s_hInst, cells, labels);
+    }
+
+    static void FinishGridMode() {
+        gridInputActive.store(false);
+        overlayInputActive.store(false);
+        CloseHintOverlay();
+        if (g_onCancel) g_onCancel();
+    }
+
+    // Q-C descend into a cell, Backspace goes up a level, Enter clicks the centre,
+    // Space only moves the cursor there, Esc cancels
+    static bool ProcessGridKey(UINT vk) {
+        if (vk == VK_ESCAPE) {
+            FinishGridMode();
+            return true;
+        }
+        if (vk == VK_BACK) {
+            if (g_grid.Back()) ShowGridLevel();
+            return true;
+        }
+        if (vk == VK_RETURN || vk == VK_SPACE) {
+            const int x = g_grid.CenterX(), y = g_grid.CenterY();
+            FinishGridMode();
+            if (vk == VK_RETURN) shortcut::InputBatch().ClickAt(x, y).Send();
+            else SetCursorPos(x, y);
+            return true;
+        }
+
+        const int cell = GridNavigator::CellForKey((char)vk);
+        if (cell < 0) return true;
+        if (g_grid.Select(cell)) {
+            ShowGridLevel();
+        }
+        else {
+            // Too small to split again: the cell itself is the answer
+            Rect r = g_grid.Cell(cell);
+            FinishGridMode();
+            shortcut::InputBatch().ClickAt(r.left + r.Width() / 2, r.top + r.Height() / 2).Send();
+        }
+        return true;
+    }
+
+    static bool IsShiftDown() {
+        return s_core.IsKeyDown(VK_SHIFT) || s_core.IsKeyDown(VK_LSHIFT) || s_core.IsKeyDown(VK_RSHIFT);
+    }
+
+    // Runs target index's action: activate a window, click a vision region, invoke via UIA,
+    // or in text mode move the caret
+    static void ActivateTarget(int index) {
+        if (textMode) {
+            SelectTextStop(index, IsShiftDown());
+            return;
+        }
+
+        const HintTarget& target = g_targets[index];
+        const Microsoft::WRL::ComPtr<IUIAutomationElement>& element = target.element;
+
+        if (target.hwnd) {
+            ScopedTrace trace("Activate window");
+            ActivateWindow(target.hwnd);
+        }
+        else if (!element) {
+            ScopedLatencyTimer invokeTimer(LatencyMetric::Invoke);
+            // Targets from the scan worker name their element by runtime id
+            if (!target.runtimeId.empty()) {
+                ScopedTrace trace("Invoke via worker");
+                if (InvokeWorkerTarget(target)) return;
+            }
+            // Vision target, or one that's gone since the scan: click where it was seen
+            ScopedTrace trace("Click region");
+            shortcut::InputBatch().ClickAt((target.rect.left + target.rect.right) / 2,
+                (target.rect.top + target.rect.bottom) / 2).Send();
+        }
+        else {
+            ScopedLatencyTimer invokeTimer(LatencyMetric::Invoke);
+            ScopedTrace trace("Invoke");
+            Microsoft::WRL::ComPtr<IUIAutomationInvokePattern> invoke;
+            if (SUCCEEDED(element->GetCurrentPattern(UIA_InvokePatternId, (IUnknown**)&invoke)) && invoke) {
+                invoke->Invoke();
+            }
+            else {
+                Microsoft::WRL::ComPtr<IUIAutomationLegacyIAccessiblePattern> legacy;
+                if (SUCCEEDED(element->GetCurrentPattern(UIA_LegacyIAccessiblePatternId, (IUnknown**)&legacy)) && legacy) {
+                    legacy->DoDefaultAction();
+                }
+            }
+        }
+    }
+
+    static void FinishHintMode() {
+        overlayInputActive.store(false);
+        ResetHintSubModes();
+        CloseHintOverlay();
+        if (g_onCancel) g_onCancel();
+        typedBuffer.clear();
+    }
+
+    static void ClearMultiSelect() {
+        multiSelect = false;
+        s_queue.clear();
+        s_queueTarget.clear();
+        s_marked.clear();
+    }
+
+    // Space: on with an empty queue, or off dropping it. Window and text targets have
+    // nothing to batch.
+    static void ToggleMultiSelect() {
+        if (textMode || g_targets.empty() || g_targets.front().hwnd) return;
+        const bool on = !multiSelect;
+        ClearMultiSelect();
+        multiSelect = on;
+        if (on) s_marked.assign(g_targets.size(), 0);
+        typedBuffer.clear();
+        SetHintMarks(s_marked);
+        OutputDebugString(on ? L"[hint_map] Multi-select on.\n" : L"[hint_map] Multi-select off.\n");
+    }
+
+    // Queues target index, or takes it back out of the queue
+    static void ToggleQueued(int index) {
+        auto it = std::find(s_queueTarget.begin(), s_queueTarget.end(), index);
+        if (it != s_queueTarget.end()) {
+            s_queue.erase(s_queue.begin() + (it - s_queueTarget.begin()));
+            s_queueTarget.erase(it);
+            s_marked[index] = 0;
+        }
+        else {
+            s_queue.push_back(g_targets[index]);
+            s_queueTarget.push_back(index);
+            s_marked[index] = 1;
+        }
+        SetHintMarks(s_marked);
+    }
+
+    // Acts on target index and closes the overlay, or in multi-select queues it and keeps it up
+    static void PickTarget(int index) {
+        if (multiSelect) {
+            ToggleQueued(index);
+            return;
+        }
+        ActivateTarget(index);
+        FinishHintMode();
+    }
+
+    // Enter in multi-select: hands the queue to the batch worker and closes the overlay
+    // without waiting for it
+    static void RunQueuedBatch() {
+        if (s_queue.empty()) return;
+        ScopedTrace trace("Queue batch");
+        std::vector<BatchAction> batch;
+        batch.reserve(s_queue.size());
+        for (const HintTarget& t : s_queue) {
+            BatchAction action;
+            action.element = t.element;
+            action.runtimeId = t.runtimeId;
+            action.rect = t.rect;
+            action.name = t.name;
+            batch.push_back(std::move(action));
+        }
+        wchar_t buf[96];
+        swprintf_s(buf, L"[hint_map] Multi-select: running %zu queued targets.\n", batch.size());
+        OutputDebugString(buf);
+
+        RunBatchActions(GetForegroundWindow(), std::move(batch));
+        FinishHintMode();
+    }
+
+    // Walk only over the targets that currently have a label
+    static void BuildWalkIndex(const int* visible, size_t count) {
+        ArenaVector<Rect> rects{ ArenaAllocator<Rect>(s_arena) };
+        rects.reserve(count);
+        s_walkTargets.assign(visible, visible + count);
+        s_walkItem.assign(s_targetRects.size(), -1);
+        for (size_t k = 0; k < count; ++k) {
+            rects.push_back(s_targetRects[visible[k]]);
+            s_walkItem[visible[k]] = (int)k;
+        }
+        s_walkIndex.Build(rects.data(), rects.size());
+    }
+
+    static void BeginActivationHeapCount() {
+        s_heapAtActivation = ThreadHeapAllocations();
+        s_countingHeap = true;
+    }
+
+    // Logs the general heap allocations of the activation that's ending
+    static void ReportActivationHeap() {
+        if (!s_countingHeap) return;
+        s_countingHeap = false;
+        wchar_t buf[128];
+        swprintf_s(buf, L"[hint_map] Activation heap: %llu allocations on the UI thread outside the arena.\n",
+            (unsigned long long)(ThreadHeapAllocations() - s_heapAtActivation));
+        OutputDebugString(buf);
+    }
+
+    // Logs what the activation used, then hands all of it back at once
+    static void ResetActivationArena() {
+        const ActivationArena::Stats& stats = s_arena.GetStats();
+        if (stats.allocations) {
+            wchar_t buf[160];
+            swprintf_s(buf, L"[hint_map] Activation arena: %zu allocations, %zu bytes, %zu heap chunks (peak %zu bytes).\n",
+                stats.allocations, stats.bytesInUse, stats.heapAllocations,
+                (std::max)(stats.peakBytes, stats.bytesInUse));
+            OutputDebugString(buf);
+        }
+        ReleaseArenaVector(s_targetRects);
+        ReleaseArenaVector(s_walkTargets);
+        ReleaseArenaVector(s_walkItem);
+        ReleaseArenaVector(g_labels);
+        ReleaseArenaVector(s_queue);
+        ReleaseArenaVector(s_queueTarget);
+        ReleaseArenaVector(s_marked);
+        ReleaseArenaVector(searchResults);
+        ReleaseArenaString(typedBuffer);
+        ReleaseArenaString(searchQuery);
+        s_arena.Reset();
+    }
+
+    // Tab switches between typing labels and walking; walking starts at the target nearest the cursor
+    static void ToggleWalkMode() {
+        typedBuffer.clear();
+        if (walkMode || s_walkIndex.Size() == 0) {
+            walkMode = false;
+            walkSelection = -1;
+            SetHintSelection(-1);
+            return;
+        }
+        POINT pt = {};
+        GetCursorPos(&pt);
+        walkMode = true;
+        walkSelection = s_walkTargets[s_walkIndex.NearestToPoint(pt.x, pt.y)];
+        SetHintSelection(walkSelection);
+    }
+
+    // Control types each Shift + letter keeps; Shift+A shows everything again
+    static uint64_t TypeFilterForKey(UINT vk) {
+        switch (vk) {
+        case 'A': return TargetBuckets::ALL;
+        case 'B': return TargetBuckets::Bit(UIA_ButtonControlTypeId) | TargetBuckets::Bit(UIA_SplitButtonControlTypeId);
+        case 'E': return TargetBuckets::Bit(UIA_EditControlTypeId) | TargetBuckets::Bit(UIA_ComboBoxControlTypeId) |
+                         TargetBuckets::Bit(UIA_SpinnerControlTypeId);
+        case 'L': return TargetBuckets::Bit(UIA_HyperlinkControlTypeId);
+        case 'I': return TargetBuckets::Bit(UIA_ListItemControlTypeId) | TargetBuckets::Bit(UIA_TreeItemControlTypeId) |
+                         TargetBuckets::Bit(UIA_DataItemControlTypeId) | TargetBuckets::Bit(UIA_TabItemControlTypeId) |
+                         TargetBuckets::Bit(UIA_MenuItemControlTypeId);
+        case 'C': return TargetBuckets::Bit(UIA_CheckBoxControlTypeId) | TargetBuckets::Bit(UIA_RadioButtonControlTypeId);
+        }
+        return 0;
+    }
+
+    // Relabels just the targets of the chosen types; fewer targets means shorter labels.
+    // A filter that would leave nothing is ignored.
+    static void ApplyTypeFilter(uint64_t mask) {
+        if (mask == typeFilter) return;
+        std::vector<int> visible = s_buckets.Select(mask);
+        if (visible.empty()) return;
+
+        typeFilter = mask;
+        std::vector<std::wstring> labels = GenerateHintLabels((int)visible.size());
+        g_labels.assign(g_targets.size(), ArenaWString(g_labels.get_allocator()));
+        for (size_t k = 0; k < visible.size(); ++k) g_labels[visible[k]].assign(labels[k].begin(), labels[k].end());
+
+        typedBuffer.clear();
+        ResetHintSubModes();
+        BuildWalkIndex(visible.data(), visible.size());
+        SetHintLabels(g_labels, -1);
+    }
+
+    // Shows only the matching targets' labels, the current pick highlighted
+    static void ShowSearchResults() {
+        const std::vector<int> found = s_nameIndex.Search(std::wstring(searchQuery.begin(), searchQuery.end()));
+        searchResults.assign(found.begin(), found.end());
+        if (searchRank >= (int)searchResults.size()) searchRank = 0;
+
+        if (searchQuery.empty()) {
+            SetHintLabels(g_labels, -1);
+            return;
+        }
+        ArenaVector<ArenaWString> labels(g_labels.size(), ArenaWString(g_labels.get_allocator()), g_labels.get_allocator());
+        for (int t : searchResults) labels[t] = g_labels[t];
+        SetHintLabels(labels, searchResults.empty() ? -1 : searchResults[searchRank]);
+    }
+
+    static void EnterSearchMode() {
+        if (s_nameIndex.Empty()) {
+            ScopedTrace trace("Build name index");
+            std::vector<std::wstring> names;
+            names.reserve(g_targets.size());
+            for (const auto& t : g_targets) {
+                names.push_back(t.automationId.empty() ? t.name : t.name + L" " + t.automationId);
+            }
+            s_nameIndex.Build(names);
+        }
+        typedBuffer.clear();
+        walkMode = false;
+        walkSelection = -1;
+        searchMode = true;
+        searchQuery.clear();
+        searchRank = 0;
+        ShowSearchResults();
+    }
+
+    // Letters, digits and space extend the query, Backspace shortens it (and leaves search
+    // mode when empty), Up/Down step through the ranking, Enter activates the pick.
+    // Returns false for keys search mode doesn't claim.
+    static bool ProcessSearchKey(UINT vk) {
+        if (vk == VK_RETURN) {
+            if (!searchResults.empty()) {
+                PickTarget(searchResults[searchRank]);
+            }
+            return true;
+        }
+        if (vk == VK_BACK) {
+            if (searchQuery.empty()) {
+                ResetHintSubModes();
+                SetHintLabels(g_labels, -1);
+                return true;
+            }
+            searchQuery.pop_back();
+            searchRank = 0;
+            ShowSearchResults();
+            return true;
+        }
+        if (vk == VK_UP || vk == VK_DOWN) {
+            if (searchResults.empty()) return true;
+            const int count = (int)searchResults.size();
+            searchRank = (searchRank + (vk == VK_DOWN ? 1 : count - 1)) % count;
+            ShowSearchResults();
+            return true;
+        }
+
+        wchar_t c = 0;
+        if (vk >= 'A' && vk <= 'Z') c = (wchar_t)(vk - 'A' + 'a');
+        else if (vk >= '0' && vk <= '9') c = (wchar_t)vk;
+        else if (vk == VK_SPACE) c = L' ';
+        if (c) {
+            searchQuery += c;
+            searchRank = 0;
+            ShowSearchResults();
+            return true;
+        }
+        return IsOverlayKey(vk, false);
+    }
+
     // Add: shared key processing for both LL hook and WM_INPUT
     static bool ProcessKeyCommonAndMaybeConsume(UINT vk, bool isDown) {
-        // Update global set
-        if (isDown) keysDown.insert(vk); else keysDown.erase(vk);
+        ScopedLatencyTimer timer(LatencyMetric::ProcessKey);
+        s_core.SetKey(vk, isDown);
+
+        if (gridInputActive.load() && vk < 256 && s_gridHeld[vk]) {
+            if (!isDown) s_gridHeld.reset(vk);
+            return isDown;   // swallow the repeats, let the release through
+        }
+        if (gridInputActive.load() && isDown && IsOverlayKey(vk, true)) {
+            return ProcessGridKey(vk);
+        }
 
         // Overlay label typing (ESC / AZ)  consume when overlay is active
         if (overlayInputActive.load()) {
             if (isDown && vk == VK_ESCAPE) {
-                overlayInputActive.store(false);
-                CloseHintOverlay();
-                if (g_onCancel) g_onCancel();
-                typedBuffer.clear();
+                FinishHintMode();
                 return true; // consumed
             }
-            if (isDown && vk >= 'A' && vk <= 'Z') {
+            if (isDown && searchMode && ProcessSearchKey(vk)) {
+                return true;
+            }
+            if (isDown && vk == VK_OEM_2 && !walkMode) {
+                EnterSearchMode();
+                return true;
+            }
+            if (isDown && vk == VK_TAB) {
+                ToggleWalkMode();
+                return true;
+            }
+            if (isDown && vk == VK_SPACE && !walkMode) {
+                ToggleMultiSelect();
+                return true;
+            }
+            if (isDown && vk == VK_RETURN && multiSelect && !walkMode) {
+                RunQueuedBatch();
+                return true;
+            }
+            if (walkMode) {
+                if (isDown && vk == VK_RETURN) {
+                    if (walkSelection >= 0 && walkSelection < (int)g_targets.size()) {
+                        PickTarget(walkSelection);
+                    }
+                    return true;
+                }
+                int direction = -1;
+                switch (vk) {
+                case 'H': case VK_LEFT:  direction = SpatialIndex::LEFT; break;
+                case 'L': case VK_RIGHT: direction = SpatialIndex::RIGHT; break;
+                case 'K': case VK_UP:    direction = SpatialIndex::UP; break;
+                case 'J': case VK_DOWN:  direction = SpatialIndex::DOWN; break;
+                }
+                if (isDown && direction >= 0) {
+                    int next = s_walkIndex.Nearest(s_walkItem[walkSelection], (SpatialIndex::Direction)direction);
+                    if (next >= 0) {
+                        walkSelection = s_walkTargets[next];
+                        SetHintSelection(walkSelection);
+                    }
+                }
+                // Letters are directions here, not labels
+                if (isDown && IsOverlayKey(vk, false)) return true;
+            }
+            else if (isDown && vk >= 'A' && vk <= 'Z' && IsShiftDown() && !textMode) {
+                const uint64_t mask = TypeFilterForKey(vk);
+                if (mask) ApplyTypeFilter(mask);
+                return true;
+            }
+            else if (isDown && vk >= 'A' && vk <= 'Z') {
                 typedBuffer += (wchar_t)vk;
 
                 for (size_t i = 0; i < g_labels.size(); ++i) {
                     if (_wcsicmp(g_labels[i].c_str(), typedBuffer.c_str()) == 0) {
-                        auto& target = g_targets[i];
-                        Microsoft::WRL::ComPtr<IUIAutomationInvokePattern> invoke;
-                        if (SUCCEEDED(target.element->GetCurrentPattern(UIA_InvokePatternId, (IUnknown**)&invoke)) && invoke) {
-                            invoke->Invoke();
-                        }
-                        else {
-                            Microsoft::WRL::ComPtr<IUIAutomationLegacyIAccessiblePattern> legacy;
-                            if (SUCCEEDED(target.element->GetCurrentPattern(UIA_LegacyIAccessiblePatternId, (IUnknown**)&legacy)) && legacy) {
-                                legacy->DoDefaultAction();
-                            }
-                        }
-                        overlayInputActive.store(false);
-                        CloseHintOverlay();
-                        if (g_onCancel) g_onCancel();
+                        PickTarget((int)i);
                         typedBuffer.clear();
                         return true; // consumed
                     }
@@ -134,40 +644,89 @@ namespace hint_map {
                 if (typedBuffer.length() > 3) typedBuffer.clear();
                 return true; // letters are for overlay while active
             }
+            else if (isDown && IsOverlayKey(vk, false)) {
+                return true; // claimed by the hook for walk and search mode
+            }
         }
 
-        // Insert-mode toggle by Ctrl tap
-        if (vk == VK_LCONTROL || vk == VK_RCONTROL || vk == VK_CONTROL) {
-            if (isDown) { ctrlDown = true; ctrlUsedWithOtherKey = false; }
+        // Insert-mode toggle by Ctrl tap, then shortcuts (command mode only)
+        InputStep step = s_core.Step(vk, isDown, overlayActive);
+        if (!g_useLowLevelHook) insertMode.store(step.insertMode);
+
+        if (step.modeToggled) {
+            if (step.insertMode) {
+                HideCursorHalo();   // INSERT MODE
+            }
             else {
-                if (!ctrlUsedWithOtherKey) {
-                    insertMode = !insertMode;
-                    if (insertMode) {
-                        HideCursorHalo();   // INSERT MODE
-                    }
-                    else {
-                        ShowCursorHalo();   // COMMAND MODE
-                    }
-                    OutputDebugString(insertMode ? L"[Insert Mode ON]\n" : L"[Insert Mode OFF]\n");
-                }
-                ctrlDown = false;
+                ShowCursorHalo();   // COMMAND MODE
             }
-        }
-        else if (isDown && ctrlDown) {
-            ctrlUsedWithOtherKey = true;
+            OutputDebugString(step.insertMode ? L"[Insert Mode ON]\n" : L"[Insert Mode OFF]\n");
         }
 
-        // Shortcuts only in command mode
-        if (!insertMode) {
-            shortcut::ProcessShortcuts(keysDown);
-        }
+        shortcut::ProcessShortcuts(step);
 
         return false; // not consumed here
     }
 
-    // Add: entry point used by the low-level hook
+    static void DrainKeyQueue() {
+        // Clear first so a push racing with this drain posts a fresh wake-up
+        s_drainPosted.store(false);
+
+        unsigned dropped = s_droppedKeys.exchange(0);
+        if (dropped) {
+            wchar_t buf[96];
+            swprintf(buf, 96, L"[hint_map] Key queue full, dropped %u events.\n", dropped);
+            OutputDebugString(buf);
+        }
+
+        KeyEvent e;
+        while (s_keyQueue.TryPop(e)) {
+            const uint64_t now = NowMicroseconds();
+            RecordLatency(LatencyMetric::KeyQueueDelay, now > e.timestampUs ? (now - e.timestampUs) * 1000 : 0);
+            s_history.Push(e);
+            TraceInstant(e.IsDown() ? "Key down" : "Key up");
+            (void)ProcessKeyCommonAndMaybeConsume(e.vk, e.IsDown());
+        }
+    }
+
+    // Entry point used by the low-level hook, on the hook thread. Decides from atomics and
+    // the hook's own mode tracking only, queues the event and returns immediately.
     bool HandleKeyFromHook(UINT vk, bool isDown) {
-        return ProcessKeyCommonAndMaybeConsume(vk, isDown);
+        const bool overlay = overlayInputActive.load();
+        const bool consumed = overlay && isDown && IsOverlayKey(vk, gridInputActive.load());
+
+        // Mode as it was before this event: only a Ctrl release can flip it, and Ctrl is never swallowed
+        const bool commandMode = !s_hookCore.IsInsertMode();
+        s_hookCore.SetKey(vk, isDown);
+        if (!consumed) insertMode.store(s_hookCore.Step(vk, isDown, overlay).insertMode);
+
+        KeyEvent e;
+        e.timestampUs = NowMicroseconds();
+        e.vk = vk;
+        e.flags = (uint8_t)((isDown ? KEY_EVENT_DOWN : 0)
+            | (consumed || (commandMode && !IsCtrlKey(vk)) ? KEY_EVENT_SWALLOWED : 0)
+            | (overlay ? KEY_EVENT_OVERLAY : 0)
+            | (consumed ? KEY_EVENT_CONSUMED : 0));
+
+        if (!s_keyQueue.TryPush(e)) {
+            s_droppedKeys.fetch_add(1);
+            return consumed;
+        }
+        if (!s_drainPosted.exchange(true)) {
+            PostMessage(s_inputWnd, WM_DRAIN_KEYS, 0, 0);
+        }
+        return consumed;
+    }
+
+    bool SaveInputLog(const wchar_t* path) {
+        std::vector<uint8_t> bytes = EncodeInputLog(s_history.Snapshot());
+
+        HANDLE file = CreateFileW(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        DWORD written = 0;
+        BOOL ok = WriteFile(file, bytes.data(), (DWORD)bytes.size(), &written, nullptr);
+        CloseHandle(file);
+        return ok && written == bytes.size();
     }
 
 
@@ -223,6 +782,115 @@ namespace hint_map {
         UnregisterClass(L"KeyboardInputSinkWindow", s_hInst);
     }
 
+    // Rects, type buckets and walk index for g_targets; search builds its own index lazily
+    static void IndexTargets() {
+        s_nameIndex.Clear();
+        typeFilter = TargetBuckets::ALL;
+
+        ArenaVector<int> controlTypes{ ArenaAllocator<int>(s_arena) };
+        ArenaVector<int> all{ ArenaAllocator<int>(s_arena) };
+        controlTypes.reserve(g_targets.size());
+        all.reserve(g_targets.size());
+        s_targetRects.clear();
+        s_targetRects.reserve(g_targets.size());
+        for (const auto& t : g_targets) {
+            all.push_back((int)controlTypes.size());
+            controlTypes.push_back(t.controlTypeId);
+            s_targetRects.push_back(MakeRect(t.rect.left, t.rect.top, t.rect.right, t.rect.bottom));
+        }
+        s_buckets.Build(controlTypes.data(), controlTypes.size());
+
+        // Tab + h/j/k/l walks all of them until a filter narrows the set
+        BuildWalkIndex(all.data(), all.size());
+    }
+
+    // Relabels the container that just scrolled: its items still on screen keep their labels,
+    // newly realized ones get free labels, and nothing outside it is rescanned
+    static void RescanScrolledContainer() {
+        if (!overlayInputActive.load() || gridInputActive.load() || g_targets.empty()) return;
+        ScopedTrace trace("Scroll rescan");
+
+        POINT pt = {};
+        GetCursorPos(&pt);
+        std::vector<HintTarget> fresh;
+        RECT viewport = {};
+        if (!ScanContainerAt(s_hintWindow, pt, fresh, viewport)) return;
+        const Rect area = MakeRect(viewport.left, viewport.top, viewport.right, viewport.bottom);
+
+        // Targets outside the container stay as they are; the ones inside are matched
+        // against the rescan by runtime id, since scrolling moved them all
+        std::vector<HintTarget> targets;
+        LabelDiff kept;
+        std::vector<LabelKey> before, after;
+        std::vector<int> beforeTarget;
+        for (size_t i = 0; i < g_targets.size(); ++i) {
+            const HintTarget& t = g_targets[i];
+            if (Intersects(MakeRect(t.rect.left, t.rect.top, t.rect.right, t.rect.bottom), area)) {
+                LabelKey key;
+                key.runtimeId = t.runtimeId;
+                before.push_back(std::move(key));
+                beforeTarget.push_back((int)i);
+                continue;
+            }
+            targets.push_back(t);
+            kept.previous.push_back((int)i);
+        }
+        for (const auto& t : fresh) {
+            LabelKey key;
+            key.runtimeId = t.runtimeId;
+            after.push_back(std::move(key));
+        }
+        const LabelDiff diff = DiffLabelKeys(before, after, 2.0);
+        for (size_t j = 0; j < fresh.size(); ++j) {
+            targets.push_back(fresh[j]);
+            kept.previous.push_back(diff.previous[j] >= 0 ? beforeTarget[diff.previous[j]] : -1);
+        }
+
+        ArenaVector<ArenaWString> labels = AssignStableLabels(kept, g_labels, GenerateHintLabels((int)targets.size()));
+
+        // Queued picks follow their targets; one scrolled back into view is found by runtime id
+        if (multiSelect) {
+            std::vector<int> moved(g_targets.size(), -1);
+            for (size_t j = 0; j < kept.previous.size(); ++j) {
+                if (kept.previous[j] >= 0) moved[kept.previous[j]] = (int)j;
+            }
+            s_marked.assign(targets.size(), 0);
+            for (size_t k = 0; k < s_queue.size(); ++k) {
+                int& at = s_queueTarget[k];
+                at = at >= 0 ? moved[at] : -1;
+                for (size_t j = 0; at < 0 && !s_queue[k].runtimeId.empty() && j < targets.size(); ++j) {
+                    if (!s_marked[j] && targets[j].runtimeId == s_queue[k].runtimeId) at = (int)j;
+                }
+                if (at >= 0) s_marked[at] = 1;
+            }
+        }
+
+        wchar_t buf[128];
+        swprintf_s(buf, L"[hint_map] Scroll rescan: %zu items, %d kept, %zu new.\n",
+            fresh.size(), diff.byRuntimeId, fresh.size() - diff.byRuntimeId);
+        OutputDebugString(buf);
+
+        g_targets = std::move(targets);
+        g_labels = std::move(labels);
+        typedBuffer.clear();
+        ResetHintSubModes();
+        IndexTargets();
+        UpdateHintTargets(g_targets, g_labels, s_marked);
+    }
+
+    // Scrolling comes in bursts; rescan once it stops
+    static void CALLBACK ScrollEventProc(HWINEVENTHOOK, DWORD, HWND hwnd, LONG, LONG, DWORD, DWORD) {
+        if (!hwnd || !s_inputWnd || GetAncestor(hwnd, GA_ROOT) != s_hintWindow) return;
+        SetTimer(s_inputWnd, SCROLL_RESCAN_TIMER, SCROLL_SETTLE_MS, nullptr);
+    }
+
+    static void StopScrollTracking() {
+        if (s_scrollHook) UnhookWinEvent(s_scrollHook);
+        s_scrollHook = nullptr;
+        s_hintWindow = nullptr;
+        if (s_inputWnd) KillTimer(s_inputWnd, SCROLL_RESCAN_TIMER);
+    }
+
     // Start overlay input without installing any hooks
     void StartInputHandler(HINSTANCE /*hInstance*/,
         const std::vector<HintTarget>& targets,
@@ -230,24 +898,76 @@ namespace hint_map {
         std::function<void()> onCancel)
     {
         if (overlayInputActive.load()) return;
+        // First, so this activation's arena-backed state starts in an empty arena
+        ResetActivationArena();
         g_targets = targets;
-        g_labels = labels;
+        g_labels.reserve(labels.size());
+        for (const std::wstring& label : labels) g_labels.emplace_back(label.begin(), label.end(), g_labels.get_allocator());
         g_onCancel = onCancel;
         typedBuffer.clear();
+        s_walkIndex.Clear();
+        ResetHintSubModes();
+        ClearMultiSelect();
+        IndexTargets();
+
+        // Window switch targets don't scroll; text stops aren't container items
+        if (!targets.empty() && !targets.front().hwnd && !textMode) {
+            s_hintWindow = GetForegroundWindow();
+            s_scrollHook = SetWinEventHook(EVENT_OBJECT_CONTENTSCROLLED, EVENT_OBJECT_CONTENTSCROLLED, nullptr,
+                ScrollEventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+        }
+
         overlayInputActive.store(true);
         OutputDebugString(L"[hint_map] Overlay input via Raw Input.\n");
     }
 
+    void StartGridMode(HINSTANCE /*hInstance*/, const Rect& area, std::function<void()> onCancel) {
+        if (overlayInputActive.load() || area.Empty()) return;
+        g_grid.Reset(area);
+        g_onCancel = onCancel;
+        typedBuffer.clear();
+        g_targets.clear();
+        g_labels.clear();
+        s_gridHeld.reset();
+        for (UINT vk = 0; vk < 256; ++vk) {
+            if (s_core.IsKeyDown(vk)) s_gridHeld.set(vk);
+        }
+        gridInputActive.store(true);
+        overlayInputActive.store(true);
+        ShowGridLevel();
+    }
+
     void StopInputHandler() {
         if (!overlayInputActive.load()) return;
         overlayInputActive.store(false);
+        gridInputActive.store(false);
         typedBuffer.clear();
+        s_walkIndex.Clear();
+        s_nameIndex.Clear();
+        s_buckets.Clear();
+        StopScrollTracking();
+        ResetHintSubModes();
+        ReportActivationHeap();
+        ResetActivationArena();
+        textMode = false;
+        ClearTextStops();
+        ClearMultiSelect();
         OutputDebugString(L"[hint_map] Overlay Raw Input stopped.\n");
     }
 
-    // Window proc: handles WM_INPUT and updates keysDown, insert mode, and shortcuts
+    // Window proc: drains hook events and handles WM_INPUT, updating key state, insert mode, and shortcuts
     static LRESULT CALLBACK InputWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         switch (msg) {
+        case WM_DRAIN_KEYS:
+            DrainKeyQueue();
+            return 0;
+
+        case WM_TIMER:
+            if (wParam != SCROLL_RESCAN_TIMER) break;
+            KillTimer(hwnd, SCROLL_RESCAN_TIMER);
+            RescanScrolledContainer();
+            return 0;
+
         case WM_INPUT: {
             if (g_useLowLevelHook) {
                 // Low-level keyboard hook is authoritative; skip WM_INPUT to avoid duplicates.
@@ -283,27 +1003,12 @@ namespace shortcut {
     std::vector<ShortcutInternal> registeredShortcuts;
 
     void SendBackspaces(int count) {
-        for (int i = 0; i < count; ++i) {
-            keybd_event(VK_BACK, 0, 0, 0);
-            keybd_event(VK_BACK, 0, KEYEVENTF_KEYUP, 0);
-            Sleep(10);
-        }
+        InputBatch().Tap(VK_BACK, count).Send();
     }
 
+    // Reads the focus tracker's cache: no COM calls on the key path
     bool IsFocusedElementEditable() {
-        Microsoft::WRL::ComPtr<IUIAutomation> automation;
-        if (FAILED(CoCreateInstance(__uuidof(CUIAutomation), NULL, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&automation)))) {
-            return false;
-        }
-        Microsoft::WRL::ComPtr<IUIAutomationElement> focusedElement;
-        if (FAILED(automation->GetFocusedElement(&focusedElement)) || !focusedElement) {
-            return false;
-        }
-        CONTROLTYPEID controlType = 0;
-        if (FAILED(focusedElement->get_CurrentControlType(&controlType))) {
-            return false;
-        }
-        return (controlType == UIA_EditControlTypeId);
+        return hint_map::CurrentFocus().editable;
     }
 
     bool IsPartialMatch(const std::unordered_set<UINT>& keysDown) {
@@ -334,17 +1039,8 @@ namespace shortcut {
         HWND hwnd = GetForegroundWindow();
         SetForegroundWindow(hwnd);
 
-        INPUT inputs[4] = {};
-        int i = 0;
-
-        inputs[i].type = INPUT_KEYBOARD; inputs[i].ki.wVk = VK_MENU; inputs[i].ki.wScan = MapVirtualKey(VK_MENU, MAPVK_VK_TO_VSC); i++;
-        inputs[i].type = INPUT_KEYBOARD; inputs[i].ki.wVk = VK_TAB;  inputs[i].ki.wScan = MapVirtualKey(VK_TAB, MAPVK_VK_TO_VSC); i++;
-        inputs[i].type = INPUT_KEYBOARD; inputs[i].ki.wVk = VK_TAB;  inputs[i].ki.wScan = MapVirtualKey(VK_TAB, MAPVK_VK_TO_VSC); inputs[i].ki.dwFlags = KEYEVENTF_KEYUP; i++;
-        inputs[i].type = INPUT_KEYBOARD; inputs[i].ki.wVk = VK_MENU; inputs[i].ki.wScan = MapVirtualKey(VK_MENU, MAPVK_VK_TO_VSC); inputs[i].ki.dwFlags = KEYEVENTF_KEYUP; i++;
-
-        UINT sent = SendInput(i, inputs, sizeof(INPUT));
-        if (sent != (UINT)i) {
-            INPUT fix = {}; fix.type = INPUT_KEYBOARD; fix.ki.wVk = VK_MENU; fix.ki.dwFlags = KEYEVENTF_KEYUP; SendInput(1, &fix, sizeof(INPUT));
+        // A partial send releases Alt itself, so it can't stay stuck down
+        if (!InputBatch().KeyDown(VK_MENU).Tap(VK_TAB).KeyUp(VK_MENU).Send()) {
             OutputDebugString(L"SendInput for Alt+Tab failed.\n");
         }
         else {
@@ -352,36 +1048,6 @@ namespace shortcut {
         }
     }
 
-    void ScrollForegroundWindow(int direction /* +1 = up, -1 = down */) {
-        HWND hwndForeground = GetForegroundWindow();
-        if (!hwndForeground) return;
-
-        RECT rect;
-        if (!GetWindowRect(hwndForeground, &rect)) return;
-
-        POINT center;
-        center.x = (rect.left + rect.right) / 2;
-        center.y = (rect.top + rect.bottom) / 2;
-        SetCursorPos(center.x, center.y);
-        Sleep(10);
-
-        POINT clientPt = center;
-        ScreenToClient(hwndForeground, &clientPt);
-
-        HWND hwndTarget = ChildWindowFromPointEx(hwndForeground, clientPt, CWP_ALL);
-        if (!hwndTarget) hwndTarget = hwndForeground;
-
-        int delta = (direction > 0) ? 70 : -70;
-        LPARAM lParam = MAKELPARAM(center.x, center.y);
-        WPARAM wParam = MAKEWPARAM(0, delta);
-
-        SendMessage(hwndTarget, WM_MOUSEWHEEL, wParam, lParam);
-    }
-
-    void RegisterShortcut(const std::vector<UINT>& keys, std::function<void()> action) {
-        registeredShortcuts.push_back({ keys, action, false });
-    }
-
     bool AreKeysPressed(const std::vector<UINT>& keys) {
         for (UINT key : keys) {
             if (!(GetAsyncKeyState(key) & 0x8000)) {
@@ -391,78 +1057,197 @@ namespace shortcut {
         return true;
     }
 
-    void ProcessShortcuts(const std::unordered_set<UINT>& keysDown) {
-        for (auto& shortcut : registeredShortcuts) {
-            bool isPressed = std::all_of(shortcut.keys.begin(), shortcut.keys.end(),
-                [&keysDown](UINT key) {
-                    return keysDown.count(key) > 0;
-                });
+    void RegisterShortcut(const std::vector<UINT>& keys, std::function<void()> action) {
+        // Chord indices in the input core match registeredShortcuts indices
+        if (hint_map::s_core.AddChord(std::vector<uint32_t>(keys.begin(), keys.end())) < 0) {
+            OutputDebugString(L"[hint_map] Too many shortcuts, ignoring registration.\n");
+            return;
+        }
+        registeredShortcuts.push_back({ keys, action, false });
+    }
 
-            if (isPressed && !shortcut.lastPressed) {
-                shortcut.action();
+    void ProcessShortcuts(const hint_map::InputStep& step) {
+        for (size_t i = 0; i < registeredShortcuts.size(); ++i) {
+            if (step.firedChords & ((uint64_t)1 << i)) {
+                registeredShortcuts[i].action();
             }
-            shortcut.lastPressed = isPressed;
         }
 
-        // Block continuous scrolling while the hint overlay is up
-        if (overlayActive) return;
+        // Held D+F / J+K drive the scroll engine; any other state releases it.
+        // The core already blocks scrolling while the hint overlay is up.
+        hint_map::SetScrollDirection(step.scroll);
+    }
+
+    void ClearShortcuts() {
+        registeredShortcuts.clear();
+        hint_map::s_core.ClearChords();
+    }
 
-        if (keysDown.size() == 2 && keysDown.count('D') && keysDown.count('F') && !keysDown.count('S')) {
-            ScrollForegroundWindow(-1);
+    // Labels last shown per scanned window, most recent first
+    struct WindowLabels {
+        HWND window = nullptr;
+        std::vector<hint_map::LabelKey> keys;
+        std::vector<std::wstring> labels;
+    };
+    static std::vector<WindowLabels> s_labelHistory;
+    static const size_t LABEL_HISTORY_WINDOWS = 8;
+
+    // Labels for a scan of window that give unchanged targets the label they had last time
+    static std::vector<std::wstring> StableLabelsFor(HWND window, const std::vector<hint_map::HintTarget>& targets) {
+        hint_map::ScopedTrace trace("Label diff");
+        std::vector<std::wstring> pool = hint_map::GenerateHintLabels((int)targets.size());
+
+        RECT wr = {};
+        GetWindowRect(window, &wr);
+        WindowLabels scan;
+        scan.window = window;
+        scan.keys.resize(targets.size());
+        for (size_t i = 0; i < targets.size(); ++i) {
+            const RECT& r = targets[i].rect;
+            scan.keys[i].rect = hint_map::MakeRect(r.left - wr.left, r.top - wr.top, r.right - wr.left, r.bottom - wr.top);
+            scan.keys[i].controlType = targets[i].controlTypeId;
+            scan.keys[i].runtimeId = targets[i].runtimeId;
         }
-        if (keysDown.size() == 2 && keysDown.count('J') && keysDown.count('K')) {
-            ScrollForegroundWindow(+1);
+
+        auto last = std::find_if(s_labelHistory.begin(), s_labelHistory.end(),
+            [window](const WindowLabels& w) { return w.window == window; });
+        if (last == s_labelHistory.end()) {
+            scan.labels = std::move(pool);
         }
+        else {
+            const hint_map::LabelDiff diff = hint_map::DiffLabelKeys(last->keys, scan.keys);
+            scan.labels = hint_map::AssignStableLabels(diff, last->labels, pool);
+            s_labelHistory.erase(last);
+
+            wchar_t buf[128];
+            swprintf_s(buf, L"[hint_map] Labels: reused %d of %d (%d by runtime id, %d by rect), %.0f%%.\n",
+                diff.Reused(), diff.previousCount, diff.byRuntimeId, diff.byRect, diff.ReuseRatio() * 100.0);
+            OutputDebugString(buf);
+        }
+
+        std::vector<std::wstring> labels = scan.labels;
+        s_labelHistory.insert(s_labelHistory.begin(), std::move(scan));
+        if (s_labelHistory.size() > LABEL_HISTORY_WINDOWS) s_labelHistory.pop_back();
+        return labels;
     }
 
-    void ClearShortcuts() {
-        registeredShortcuts.clear();
+    // Labels currentTargets, shows the overlay and routes A-Z to it. With a scanned window,
+    // labels are kept stable against its previous scan.
+    static void OpenHintOverlay(HINSTANCE hInstance, HWND scannedWindow = nullptr) {
+        currentLabels = scannedWindow ? StableLabelsFor(scannedWindow, currentTargets)
+                                      : hint_map::GenerateHintLabels((int)currentTargets.size());
+        OutputDebugString(L"[hint_map] GenerateHintLabels called.\n");
+
+        hint_map::ShowHintOverlay(hInstance, currentTargets, currentLabels);
+        OutputDebugString(L"[hint_map] ShowHintOverlay called.\n");
+
+        overlayActive = true;
+
+        hint_map::StartInputHandler(hInstance, currentTargets, currentLabels, []() {
+            overlayActive = false;
+            hint_map::StopInputHandler();
+            });
+    }
+
+    // Grid over the foreground window, or the monitor under the cursor if there is none
+    static void StartGridOverForeground(HINSTANCE hInstance) {
+        const MonitorTopology& topology = hint_map::CurrentMonitorTopology();
+        hint_map::Rect area;
+
+        RECT r;
+        HWND foreground = GetForegroundWindow();
+        if (foreground && !IsIconic(foreground) && GetWindowRect(foreground, &r)) {
+            area = hint_map::Intersection(hint_map::MakeRect(r.left, r.top, r.right, r.bottom), topology.VirtualScreen());
+        }
+        if (area.Empty()) {
+            POINT pt;
+            GetCursorPos(&pt);
+            int mon = topology.FindNearestMonitor(pt.x, pt.y);
+            if (mon < 0) return;
+            area = topology.Monitors()[mon].bounds;
+        }
+
+        overlayActive = true;
+        hint_map::StartGridMode(hInstance, area, []() {
+            overlayActive = false;
+            hint_map::StopInputHandler();
+            });
     }
 
     void InitShortcuts(HINSTANCE hInstance) {
         shortcut::RegisterShortcut({ 'S', 'D', 'F' }, [hInstance]() {
             OutputDebugString(L"[hint_map] ActivateHintMode called.\n");
+            hint_map::BeginTraceActivation();
+            hint_map::ScopedTrace trace("Activation");
 
             if (overlayActive) {
                 MessageBox(NULL, L"[hint_map] Overlay is still active.\n", L"Debug", MB_OK | MB_ICONINFORMATION);
                 return;
             }
+            hint_map::BeginActivationHeapCount();
 
             // Clear previous keyboard state before opening hints
-            keysDown.clear();
+            hint_map::s_core.ClearKeys();
 
-            currentTargets = hint_map::GetClickableElements();
+            // In the scan worker when it's up, so a hung provider can't stall this thread
+            currentTargets = hint_map::ScanForegroundTargets();
             OutputDebugString(L"[hint_map] GetClickableElements called.\n");
 
+            if (hint_map::IsVisionFallbackEnabled()) {
+                // Add what the pixels show that the UIA tree doesn't
+                std::vector<hint_map::HintTarget> seen = hint_map::DetectVisualTargets(GetForegroundWindow(), currentTargets);
+                currentTargets.insert(currentTargets.end(), seen.begin(), seen.end());
+            }
+
+            // Don't label what other windows (always-on-top ones, mostly) are covering
+            hint_map::CullOccludedTargets(GetForegroundWindow(), currentTargets);
+
             if (currentTargets.empty()) {
-                OutputDebugString(L"[hint_map] currentTargets is empty.\n");
+                // No usable UIA tree (games, canvas apps): fall back to the keyboard grid
+                OutputDebugString(L"[hint_map] currentTargets is empty, using grid mode.\n");
+                StartGridOverForeground(hInstance);
                 return;
             }
 
-            std::vector<RECT> rects;
-            for (const auto& t : currentTargets) rects.push_back(t.rect);
-
-            currentLabels = hint_map::GenerateHintLabels((int)currentTargets.size());
-            OutputDebugString(L"[hint_map] GenerateHintLabels called.\n");
+            OpenHintOverlay(hInstance, GetForegroundWindow());
+            });
 
-            hint_map::ShowHintOverlay(hInstance, currentTargets, currentLabels);
-            OutputDebugString(L"[hint_map] ShowHintOverlay called.\n");
+        // Text mode over the focused edit or document
+        shortcut::RegisterShortcut({ 'S', 'D', 'T' }, [hInstance]() {
+            if (overlayActive) return;
+            hint_map::s_core.ClearKeys();
+            hint_map::BeginTraceActivation();
+            hint_map::BeginActivationHeapCount();
+            hint_map::ScopedTrace trace("Text activation");
 
-            overlayActive = true;
+            currentTargets = hint_map::GetTextStopTargets();
+            if (currentTargets.empty()) {
+                OutputDebugString(L"[hint_map] No visible text in the focused element.\n");
+                return;
+            }
 
-            hint_map::StartInputHandler(hInstance, currentTargets, currentLabels, []() {
-                overlayActive = false;
-                hint_map::StopInputHandler();
-                });
+            hint_map::textMode = true;
+            OpenHintOverlay(hInstance);
             });
 
         shortcut::RegisterShortcut({ 'Q', 'W', 'E' }, []() {
             MessageBox(nullptr, L"QWE shortcut triggered!", L"Info", MB_OK);
             });
 
-        shortcut::RegisterShortcut({ 'G', 'H' }, []() {
-            SendAltTab();
-            OutputDebugString(L"[hint_map] SendAltTab called.\n");
+        // Window switch mode: the list is kept current by WinEvents, so no scan here
+        shortcut::RegisterShortcut({ 'G', 'H' }, [hInstance]() {
+            if (overlayActive) return;
+            hint_map::s_core.ClearKeys();
+            hint_map::BeginActivationHeapCount();
+
+            currentTargets = hint_map::GetWindowTargets();
+            if (currentTargets.empty()) {
+                // Nothing we can label: let the shell's switcher handle it
+                SendAltTab();
+                OutputDebugString(L"[hint_map] SendAltTab called.\n");
+                return;
+            }
+            OpenHintOverlay(hInstance);
             });
     }
 
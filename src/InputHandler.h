@@ -6,6 +6,8 @@
 #include <functional>
 #include <unordered_set>
 #include "UIElementScanner.h"
+#include "InputCore.h"
+#include "Geometry.h"
 
 namespace hint_map {
 
@@ -19,15 +21,21 @@ namespace hint_map {
         const std::vector<std::wstring>& labels,
         std::function<void()> onCancel);
 
+    // Keyboard grid over area for apps with nothing to label; same overlay input routing
+    void StartGridMode(HINSTANCE hInstance, const Rect& area, std::function<void()> onCancel);
+
     void StopInputHandler();
 
     // Query app mode (insert vs command)
     bool IsInsertMode();
 
-    // Add: called by the low-level keyboard hook to feed key activity.
-// Returns true if the key was consumed (e.g., overlay label typing).
+    // Add: called by the low-level keyboard hook (on the hook thread) to queue key activity.
+// Returns true if the key will be consumed (e.g., overlay label typing).
     bool HandleKeyFromHook(UINT vk, bool isDown);
 
+    // Write the recent key events as a binary input log (see InputCore.h) for replay
+    bool SaveInputLog(const wchar_t* path);
+
     // Add: query whether the overlay is currently taking label input
     bool IsOverlayActive();
 
@@ -43,7 +51,7 @@ namespace shortcut {
 
     void InitShortcuts(HINSTANCE hInstance);
     void RegisterShortcut(const std::vector<UINT>& keys, std::function<void()> action);
-    void ProcessShortcuts(const std::unordered_set<UINT>& keysDown);
+    void ProcessShortcuts(const hint_map::InputStep& step);
     void ClearShortcuts();
 
     extern std::vector<ShortcutInternal> registeredShortcuts;
@@ -0,0 +1,46 @@
+// KeyEventRing.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace hint_map {
+
+    // Fixed-size single-producer/single-consumer ring. No allocation after construction and
+    // no locks: the producer only writes head, the consumer only writes tail.
+    // Capacity must be a power of two.
+    template <typename T, size_t Capacity>
+    class SpscRing {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        // Producer side. Returns false (and drops the item) when the ring is full.
+        bool TryPush(const T& item) {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head - tail_.load(std::memory_order_acquire) == Capacity) return false;
+            slots_[head & (Capacity - 1)] = item;
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side.
+        bool TryPop(T& item) {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == head_.load(std::memory_order_acquire)) return false;
+            item = slots_[tail & (Capacity - 1)];
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool Empty() const {
+            return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+        }
+
+    private:
+        // Producer and consumer indices on separate cache lines
+        alignas(64) std::atomic<size_t> head_{ 0 };
+        alignas(64) std::atomic<size_t> tail_{ 0 };
+        alignas(64) T slots_[Capacity];
+    };
+
+}
@@ -0,0 +1,165 @@
+// LabelDiff.cpp
+
+#include "LabelDiff.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+namespace hint_map {
+
+    // Sortable (key, target) pair: runtime id hashes and centre cells are both looked up
+    // by binary search over a sorted array of these
+    struct KeyedIndex {
+        uint64_t key;
+        int index;
+
+        bool operator<(const KeyedIndex& other) const {
+            return key != other.key ? key < other.key : index < other.index;
+        }
+    };
+
+    static uint64_t HashRuntimeId(const std::vector<int>& id) {
+        uint64_t h = 1469598103934665603ull;   // FNV-1a
+        for (int v : id) {
+            h ^= (uint32_t)v;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    // Rects that overlap enough to match have centres in the same or a neighbouring cell,
+    // unless they're much larger than a cell
+    static const int CELL = 64;
+
+    static int CellOf(int v) { return v >= 0 ? v / CELL : -((CELL - 1 - v) / CELL); }
+
+    static uint64_t CellKey(int cx, int cy) { return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy; }
+
+    static double Overlap(const Rect& a, const Rect& b) {
+        const long long shared = OverlapArea(a, b);
+        if (shared <= 0) return 0.0;
+        const long long areaA = (long long)a.Width() * a.Height();
+        const long long areaB = (long long)b.Width() * b.Height();
+        return (double)shared / (double)(areaA + areaB - shared);
+    }
+
+    LabelDiff DiffLabelKeys(const std::vector<LabelKey>& previous, const std::vector<LabelKey>& current,
+        double minOverlap) {
+        LabelDiff diff;
+        diff.previous.assign(current.size(), -1);
+        diff.previousCount = (int)previous.size();
+        std::vector<char> taken(previous.size(), 0);
+
+        // 1. Equal runtime ids
+        std::vector<KeyedIndex> ids;
+        ids.reserve(previous.size());
+        for (size_t i = 0; i < previous.size(); ++i) {
+            if (!previous[i].runtimeId.empty()) ids.push_back({ HashRuntimeId(previous[i].runtimeId), (int)i });
+        }
+        std::sort(ids.begin(), ids.end());
+
+        for (size_t j = 0; j < current.size(); ++j) {
+            if (current[j].runtimeId.empty()) continue;
+            const KeyedIndex probe = { HashRuntimeId(current[j].runtimeId), -1 };
+            for (auto it = std::lower_bound(ids.begin(), ids.end(), probe); it != ids.end() && it->key == probe.key; ++it) {
+                if (taken[it->index] || previous[it->index].runtimeId != current[j].runtimeId) continue;
+                taken[it->index] = 1;
+                diff.previous[j] = it->index;
+                ++diff.byRuntimeId;
+                break;
+            }
+        }
+
+        // 2. The rest by type and overlap, best pairs first
+        if (minOverlap > 1.0) return diff;
+        std::vector<KeyedIndex> cells;
+        cells.reserve(previous.size());
+        for (size_t i = 0; i < previous.size(); ++i) {
+            const Rect& r = previous[i].rect;
+            if (taken[i] || r.Empty()) continue;
+            cells.push_back({ CellKey(CellOf((r.left + r.right) / 2), CellOf((r.top + r.bottom) / 2)), (int)i });
+        }
+        std::sort(cells.begin(), cells.end());
+
+        struct Candidate {
+            double overlap;
+            int current;
+            int previous;
+        };
+        std::vector<Candidate> candidates;
+        for (size_t j = 0; j < current.size() && !cells.empty(); ++j) {
+            const Rect& r = current[j].rect;
+            if (diff.previous[j] >= 0 || r.Empty()) continue;
+            const int cx = CellOf((r.left + r.right) / 2);
+            const int cy = CellOf((r.top + r.bottom) / 2);
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const KeyedIndex probe = { CellKey(cx + dx, cy + dy), -1 };
+                    for (auto it = std::lower_bound(cells.begin(), cells.end(), probe); it != cells.end() && it->key == probe.key; ++it) {
+                        const LabelKey& old = previous[it->index];
+                        if (old.controlType != current[j].controlType) continue;
+                        const double overlap = Overlap(old.rect, r);
+                        if (overlap >= minOverlap) candidates.push_back({ overlap, (int)j, it->index });
+                    }
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            if (a.overlap != b.overlap) return a.overlap > b.overlap;
+            if (a.current != b.current) return a.current < b.current;
+            return a.previous < b.previous;
+        });
+
+        for (const Candidate& c : candidates) {
+            if (diff.previous[c.current] >= 0 || taken[c.previous]) continue;
+            taken[c.previous] = 1;
+            diff.previous[c.current] = c.previous;
+            ++diff.byRect;
+        }
+        return diff;
+    }
+
+    // Shared by both label containers; labels arrives sized, all empty
+    template <typename Labels>
+    static void FillStableLabels(const LabelDiff& diff, const Labels& previousLabels,
+        const std::vector<std::wstring>& pool, Labels& labels) {
+        std::unordered_map<std::wstring, int> poolIndex;
+        poolIndex.reserve(pool.size());
+        for (size_t k = 0; k < pool.size(); ++k) poolIndex.emplace(pool[k], (int)k);
+        std::vector<char> used(pool.size(), 0);
+
+        for (size_t j = 0; j < labels.size(); ++j) {
+            const int old = diff.previous[j];
+            if (old < 0 || old >= (int)previousLabels.size()) continue;
+            auto it = poolIndex.find(std::wstring(previousLabels[old].begin(), previousLabels[old].end()));
+            if (it == poolIndex.end() || used[it->second]) continue;
+            used[it->second] = 1;
+            labels[j].assign(pool[it->second].begin(), pool[it->second].end());
+        }
+
+        size_t next = 0;
+        for (size_t j = 0; j < labels.size(); ++j) {
+            if (!labels[j].empty()) continue;
+            while (next < pool.size() && used[next]) ++next;
+            if (next == pool.size()) break;
+            used[next] = 1;
+            labels[j].assign(pool[next].begin(), pool[next].end());
+        }
+    }
+
+    std::vector<std::wstring> AssignStableLabels(const LabelDiff& diff,
+        const std::vector<std::wstring>& previousLabels, const std::vector<std::wstring>& pool) {
+        std::vector<std::wstring> labels(diff.previous.size());
+        FillStableLabels(diff, previousLabels, pool, labels);
+        return labels;
+    }
+
+    ArenaVector<ArenaWString> AssignStableLabels(const LabelDiff& diff,
+        const ArenaVector<ArenaWString>& previousLabels, const std::vector<std::wstring>& pool) {
+        const ArenaAllocator<ArenaWString> allocator = previousLabels.get_allocator();
+        ArenaVector<ArenaWString> labels(diff.previous.size(), ArenaWString(allocator), allocator);
+        FillStableLabels(diff, previousLabels, pool, labels);
+        return labels;
+    }
+
+}
@@ -0,0 +1,45 @@
+// LabelDiff.h
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Geometry.h"
+#include "ActivationArena.h"
+
+namespace hint_map {
+
+    // What identifies a target from one scan of a window to the next
+    struct LabelKey {
+        Rect rect;                      // relative to the window, so moving it doesn't matter
+        int controlType = 0;
+        std::vector<int> runtimeId;     // empty if the target has none (vision, window)
+    };
+
+    struct LabelDiff {
+        std::vector<int> previous;      // per current target: its index in the old scan, or -1
+        int previousCount = 0;
+        int byRuntimeId = 0;
+        int byRect = 0;
+
+        int Reused() const { return byRuntimeId + byRect; }
+        // Share of the old scan found again
+        double ReuseRatio() const { return previousCount ? (double)Reused() / previousCount : 0.0; }
+    };
+
+    // Matches current targets to the previous scan of the same window: first by equal
+    // runtime id, then the rest by control type and rect overlap (IoU >= minOverlap),
+    // best overlap first. Each old target matches at most one new one. A minOverlap above 1
+    // matches by runtime id only (for content that moved, e.g. a scrolled list).
+    // O(n log n) in the number of targets.
+    LabelDiff DiffLabelKeys(const std::vector<LabelKey>& previous, const std::vector<LabelKey>& current,
+        double minOverlap = 0.6);
+
+    // Labels for the current targets from pool (prefix-free, best first): a matched target
+    // keeps its old label if the pool still has it, the rest take what's left in pool order
+    std::vector<std::wstring> AssignStableLabels(const LabelDiff& diff,
+        const std::vector<std::wstring>& previousLabels, const std::vector<std::wstring>& pool);
+    // Same, for an activation's labels; the result comes from the same arena
+    ArenaVector<ArenaWString> AssignStableLabels(const LabelDiff& diff,
+        const ArenaVector<ArenaWString>& previousLabels, const std::vector<std::wstring>& pool);
+
+}
@@ -0,0 +1,169 @@
+// LabelPlacement.cpp
+
+#include "LabelPlacement.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace hint_map {
+
+    namespace {
+
+        // Hashed uniform grid over placed label rects. Cells are sized to the largest label,
+        // so a query rect touches at most a handful of cells.
+        class LabelHash {
+        public:
+            LabelHash(int cellSize, size_t expected)
+                : cell(cellSize > 0 ? cellSize : 1)
+            {
+                size_t buckets = 64;
+                while (buckets < expected * 2) buckets <<= 1;
+                heads.assign(buckets, -1);
+                mask = buckets - 1;
+                entries.reserve(expected * 4);
+            }
+
+            void Insert(int index, const Rect& r) {
+                ForEachCell(r, [&](int cx, int cy) {
+                    size_t b = Bucket(cx, cy);
+                    entries.push_back({ index, cx, cy, heads[b] });
+                    heads[b] = (int)entries.size() - 1;
+                    });
+            }
+
+            // Calls fn(index) for every label sharing a cell with r. An index may be reported
+            // more than once when the label spans several cells.
+            template <typename Fn>
+            void Query(const Rect& r, Fn fn) const {
+                ForEachCell(r, [&](int cx, int cy) {
+                    for (int e = heads[Bucket(cx, cy)]; e != -1; e = entries[e].next) {
+                        if (entries[e].cx == cx && entries[e].cy == cy) fn(entries[e].index);
+                    }
+                    });
+            }
+
+        private:
+            struct Entry {
+                int index;
+                int cx, cy;
+                int next;
+            };
+
+            int cell;
+            size_t mask = 0;
+            std::vector<int> heads;
+            std::vector<Entry> entries;
+
+            static int FloorDiv(int v, int d) {
+                return (v >= 0) ? v / d : -((-v + d - 1) / d);
+            }
+
+            size_t Bucket(int cx, int cy) const {
+                uint32_t h = (uint32_t)cx * 73856093u ^ (uint32_t)cy * 19349663u;
+                return (size_t)h & mask;
+            }
+
+            template <typename Fn>
+            void ForEachCell(const Rect& r, Fn fn) const {
+                int x0 = FloorDiv(r.left, cell), x1 = FloorDiv(r.right - 1, cell);
+                int y0 = FloorDiv(r.top, cell), y1 = FloorDiv(r.bottom - 1, cell);
+                for (int cy = y0; cy <= y1; ++cy)
+                    for (int cx = x0; cx <= x1; ++cx)
+                        fn(cx, cy);
+            }
+        };
+
+        bool Inside(const Rect& r, const Rect& bounds) {
+            return r.left >= bounds.left && r.top >= bounds.top &&
+                r.right <= bounds.right && r.bottom <= bounds.bottom;
+        }
+
+        // Shift r the minimum amount needed to bring it inside bounds.
+        Rect ClampInto(Rect r, const Rect& bounds) {
+            int dx = 0, dy = 0;
+            if (r.right > bounds.right) dx = bounds.right - r.right;
+            if (r.left + dx < bounds.left) dx = bounds.left - r.left;
+            if (r.bottom > bounds.bottom) dy = bounds.bottom - r.bottom;
+            if (r.top + dy < bounds.top) dy = bounds.top - r.top;
+            return MakeRect(r.left + dx, r.top + dy, r.right + dx, r.bottom + dy);
+        }
+
+        const int kCandidateCount = 5;
+
+        // Candidate anchors in order of preference. The first one is the historic placement
+        // (straddling the target's top edge), the second the historic flip for targets at
+        // the top of the screen.
+        Rect Candidate(int which, const Rect& t, const Size& s, const PlacementParams& p) {
+            int x = t.left + p.insetX;
+            int y = t.top - p.gap;
+            switch (which) {
+            case 0: break;                                                   // above
+            case 1: y = t.top + p.gap - 2; break;                           // inside top
+            case 2: y = t.bottom - s.height + p.gap; break;                 // below
+            case 3: x = t.left - s.width - p.gap / 2; y = t.top; break;    // left
+            case 4: x = t.right + p.gap / 2; y = t.top; break;             // right
+            }
+            return MakeRect(x, y, x + s.width, y + s.height);
+        }
+
+    }
+
+    std::vector<Rect> PlaceLabels(const std::vector<Rect>& targets,
+        const std::vector<Size>& labelSizes,
+        const PlacementParams& params)
+    {
+        const size_t n = std::min(targets.size(), labelSizes.size());
+        std::vector<Rect> placed(n);
+        if (n == 0) return placed;
+
+        int cell = 8;
+        for (size_t i = 0; i < n; ++i) {
+            cell = std::max(cell, std::max(labelSizes[i].width, labelSizes[i].height));
+        }
+
+        LabelHash hash(cell, n);
+        // Last query that reported a label; filters the duplicates LabelHash::Query yields.
+        std::vector<uint32_t> seenStamp(n, 0);
+        uint32_t stamp = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            const Rect& target = targets[i];
+            const Size& size = labelSizes[i];
+
+            Rect best{};
+            long long bestOverlap = -1;
+
+            // The extra last round retries the preferred anchor clamped into the bounds, so a
+            // target near the screen edge still gets a label when every candidate is out.
+            for (int c = 0; c <= kCandidateCount; ++c) {
+                Rect r;
+                if (c < kCandidateCount) {
+                    r = Candidate(c, target, size, params);
+                    if (!Inside(r, params.bounds)) continue;
+                }
+                else {
+                    r = ClampInto(Candidate(0, target, size, params), params.bounds);
+                }
+
+                ++stamp;
+                long long overlap = 0;
+                hash.Query(r, [&](int other) {
+                    if (seenStamp[other] == stamp) return;
+                    seenStamp[other] = stamp;
+                    overlap += OverlapArea(r, placed[other]);
+                    });
+
+                if (bestOverlap < 0 || overlap < bestOverlap) {
+                    best = r;
+                    bestOverlap = overlap;
+                }
+                if (overlap == 0) break;
+            }
+
+            placed[i] = best;
+            hash.Insert((int)i, best);
+        }
+
+        return placed;
+    }
+
+}
@@ -0,0 +1,27 @@
+// LabelPlacement.h
+#pragma once
+
+#include <vector>
+#include "Geometry.h"
+
+namespace hint_map {
+
+    struct PlacementParams {
+        Rect bounds;        // labels are kept inside this rect (overlay client coordinates)
+        int gap = 6;        // distance the default anchor sits above the target
+        int insetX = 8;     // horizontal offset of the label from the target's left edge
+    };
+
+    // Picks a rect for every label. Each target tries a fixed list of candidate anchors
+    // (above, inside top, below, left, right) and takes the first one that stays inside
+    // the bounds without hitting an already placed label; if none is free, the candidate
+    // with the smallest overlap wins. Collisions are found through a spatial hash, so the
+    // whole pass is linear in the label count for realistic layouts.
+    //
+    // targets and labelSizes are index-aligned; targets must be in the same coordinate
+    // space as params.bounds.
+    std::vector<Rect> PlaceLabels(const std::vector<Rect>& targets,
+        const std::vector<Size>& labelSizes,
+        const PlacementParams& params);
+
+}
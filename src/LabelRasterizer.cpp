@@ -0,0 +1,182 @@
+// LabelRasterizer.cpp
+
+#include "LabelRasterizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HINT_MAP_SSE2 1
+#endif
+
+namespace hint_map {
+
+    namespace {
+
+        uint32_t Premultiply(uint32_t argb) {
+            uint32_t a = argb >> 24;
+            uint32_t r = (((argb >> 16) & 0xFF) * a + 127) / 255;
+            uint32_t g = (((argb >> 8) & 0xFF) * a + 127) / 255;
+            uint32_t b = ((argb & 0xFF) * a + 127) / 255;
+            return (a << 24) | (r << 16) | (g << 8) | b;
+        }
+
+        // Exact x / 255 for x in [0, 255 * 255], rounded to nearest.
+        inline uint32_t Div255(uint32_t x) {
+            x += 128;
+            return (x + (x >> 8)) >> 8;
+        }
+
+        inline uint32_t BlendPixel(uint32_t dst, uint32_t src, uint32_t cov) {
+            uint32_t out = 0;
+            uint32_t sa = Div255((src >> 24) * cov);
+            for (int shift = 0; shift < 32; shift += 8) {
+                uint32_t s = Div255(((src >> shift) & 0xFF) * cov);
+                uint32_t d = Div255(((dst >> shift) & 0xFF) * (255 - sa));
+                out |= (s + d) << shift;
+            }
+            return out;
+        }
+
+#ifdef HINT_MAP_SSE2
+        inline __m128i Div255x8(__m128i x) {
+            x = _mm_add_epi16(x, _mm_set1_epi16(128));
+            return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+        }
+
+        // Blends two pixels held as 8 x u16 lanes.
+        inline __m128i Blend2(__m128i dst16, __m128i src16, __m128i cov16) {
+            const __m128i full = _mm_set1_epi16(255);
+            __m128i s = Div255x8(_mm_mullo_epi16(src16, cov16));
+            __m128i sa = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            __m128i d = Div255x8(_mm_mullo_epi16(dst16, _mm_sub_epi16(full, sa)));
+            return _mm_add_epi16(s, d);
+        }
+#endif
+
+        // dst[i] = src * cov[i] over dst[i], src premultiplied.
+        void BlendSpan(uint32_t* dst, const uint8_t* cov, int n, uint32_t src) {
+            int i = 0;
+#ifdef HINT_MAP_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i src16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)src), zero);
+            const __m128i solid = _mm_set1_epi32((int)src);
+            const bool opaque = (src >> 24) == 255;
+
+            for (; i + 4 <= n; i += 4) {
+                uint32_t c4;
+                memcpy(&c4, cov + i, 4);
+                if (c4 == 0) continue;
+                if (opaque && c4 == 0xFFFFFFFFu) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), solid);
+                    continue;
+                }
+
+                __m128i c = _mm_cvtsi32_si128((int)c4);
+                c = _mm_unpacklo_epi8(c, c);
+                c = _mm_unpacklo_epi16(c, c);
+                __m128i covLo = _mm_unpacklo_epi8(c, zero);
+                __m128i covHi = _mm_unpackhi_epi8(c, zero);
+
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+                __m128i lo = Blend2(_mm_unpacklo_epi8(d, zero), src16, covLo);
+                __m128i hi = Blend2(_mm_unpackhi_epi8(d, zero), src16, covHi);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+            }
+#endif
+            for (; i < n; ++i) {
+                if (cov[i]) dst[i] = BlendPixel(dst[i], src, cov[i]);
+            }
+        }
+
+        // Coverage of a corner pixel whose centre lies (dx, dy) outside the corner circle's
+        // centre, for a circle of radius r.
+        uint8_t CornerCoverage(float dx, float dy, float r) {
+            float c = r - std::sqrt(dx * dx + dy * dy) + 0.5f;
+            if (c <= 0.0f) return 0;
+            if (c >= 1.0f) return 255;
+            return (uint8_t)(c * 255.0f + 0.5f);
+        }
+
+    }
+
+    Size MeasureLabel(const std::wstring& text, const GlyphAtlas& atlas, int padX, int padY) {
+        Size s;
+        for (wchar_t ch : text) {
+            if (const GlyphMask* g = atlas.Find(ch)) s.width += g->advance;
+        }
+        s.width += padX * 2;
+        s.height = atlas.lineHeight + padY * 2;
+        return s;
+    }
+
+    void ClearCanvas(Canvas& canvas) {
+        for (int y = 0; y < canvas.height; ++y) {
+            memset(canvas.Row(y), 0, (size_t)canvas.width * sizeof(uint32_t));
+        }
+    }
+
+    void FillRoundedRect(Canvas& canvas, const Rect& rect, float radius, uint32_t argb) {
+        Rect r = Intersection(rect, MakeRect(0, 0, canvas.width, canvas.height));
+        if (r.Empty()) return;
+
+        const uint32_t src = Premultiply(argb);
+        radius = std::max(0.0f, std::min(radius, std::min(rect.Width(), rect.Height()) / 2.0f));
+        const int corner = (int)std::ceil(radius);
+
+        // Corner centres
+        const float cxL = rect.left + radius, cxR = rect.right - radius;
+        const float cyT = rect.top + radius, cyB = rect.bottom - radius;
+
+        std::vector<uint8_t> cov((size_t)rect.Width());
+        for (int y = r.top; y < r.bottom; ++y) {
+            std::fill(cov.begin(), cov.end(), (uint8_t)255);
+
+            // Only rows above the top corner centres or below the bottom ones are curved
+            const float py = y + 0.5f;
+            const float dy = std::max(cyT - py, py - cyB);
+            if (dy > 0.0f) {
+                for (int i = 0; i < corner && i < rect.Width(); ++i) {
+                    const float dxL = cxL - (rect.left + i + 0.5f);
+                    const float dxR = (rect.right - i - 0.5f) - cxR;
+                    if (dxL > 0.0f) cov[i] = CornerCoverage(dxL, dy, radius);
+                    if (dxR > 0.0f) cov[rect.Width() - 1 - i] = CornerCoverage(dxR, dy, radius);
+                }
+            }
+
+            BlendSpan(canvas.Row(y) + r.left, cov.data() + (r.left - rect.left), r.Width(), src);
+        }
+    }
+
+    void BlendMask(Canvas& canvas, int x, int y, const uint8_t* mask, int maskWidth, int maskHeight, int maskStride, uint32_t argb) {
+        Rect r = Intersection(MakeRect(x, y, x + maskWidth, y + maskHeight), MakeRect(0, 0, canvas.width, canvas.height));
+        if (r.Empty()) return;
+
+        const uint32_t src = Premultiply(argb);
+        for (int row = r.top; row < r.bottom; ++row) {
+            const uint8_t* m = mask + (size_t)(row - y) * maskStride + (r.left - x);
+            BlendSpan(canvas.Row(row) + r.left, m, r.Width(), src);
+        }
+    }
+
+    void DrawLabel(Canvas& canvas, const Rect& box, const std::wstring& text, const GlyphAtlas& atlas, const LabelStyle& style) {
+        const int bw = style.borderWidth;
+        FillRoundedRect(canvas, box, style.radius, style.border);
+        FillRoundedRect(canvas, MakeRect(box.left + bw, box.top + bw, box.right - bw, box.bottom - bw),
+            std::max(0.0f, style.radius - bw), style.fill);
+
+        int penX = box.left + style.padX;
+        const int baseline = box.top + style.padY + atlas.ascent;
+        for (wchar_t ch : text) {
+            const GlyphMask* g = atlas.Find(ch);
+            if (!g) continue;
+            if (!g->coverage.empty()) {
+                BlendMask(canvas, penX + g->offsetX, baseline + g->offsetY,
+                    g->coverage.data(), g->width, g->height, g->width, style.text);
+            }
+            penX += g->advance;
+        }
+    }
+
+}
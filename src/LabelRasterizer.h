@@ -0,0 +1,70 @@
+// LabelRasterizer.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Geometry.h"
+
+namespace hint_map {
+
+    // 32-bit premultiplied BGRA pixels, top-down, laid out exactly like a 32bpp DIB section
+    // so the result can be handed to UpdateLayeredWindow without conversion.
+    // The canvas does not own its pixels.
+    struct Canvas {
+        uint32_t* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        int stride = 0;   // in pixels
+
+        uint32_t* Row(int y) const { return pixels + (size_t)y * stride; }
+    };
+
+    // Coverage mask (0..255) for one character, positioned relative to the pen on the baseline.
+    struct GlyphMask {
+        int width = 0;
+        int height = 0;
+        int offsetX = 0;   // left edge of the mask relative to the pen
+        int offsetY = 0;   // top edge of the mask relative to the baseline (usually negative)
+        int advance = 0;
+        std::vector<uint8_t> coverage;
+    };
+
+    // Pre-rasterised glyphs for one font size. Filled by the platform layer, read-only after.
+    struct GlyphAtlas {
+        wchar_t first = L'A';
+        int ascent = 0;
+        int lineHeight = 0;
+        std::vector<GlyphMask> glyphs;
+
+        const GlyphMask* Find(wchar_t ch) const {
+            size_t i = (size_t)(ch - first);
+            return (ch >= first && i < glyphs.size()) ? &glyphs[i] : nullptr;
+        }
+    };
+
+    struct LabelStyle {
+        uint32_t fill = 0xFFC8C8C8;     // straight (non-premultiplied) ARGB
+        uint32_t border = 0xFF000000;
+        uint32_t text = 0xFF000000;
+        float radius = 4.0f;
+        int borderWidth = 1;
+        int padX = 2;
+        int padY = 1;
+    };
+
+    // Box size of a label drawn with the given atlas and padding.
+    Size MeasureLabel(const std::wstring& text, const GlyphAtlas& atlas, int padX, int padY);
+
+    void ClearCanvas(Canvas& canvas);
+
+    // Anti-aliased rounded rectangle, composited source-over.
+    void FillRoundedRect(Canvas& canvas, const Rect& rect, float radius, uint32_t argb);
+
+    // Composites a coverage mask tinted with argb at (x, y); clipped to the canvas.
+    void BlendMask(Canvas& canvas, int x, int y, const uint8_t* mask, int maskWidth, int maskHeight, int maskStride, uint32_t argb);
+
+    // Box, border and text of one hint label.
+    void DrawLabel(Canvas& canvas, const Rect& box, const std::wstring& text, const GlyphAtlas& atlas, const LabelStyle& style);
+
+}
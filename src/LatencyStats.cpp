@@ -0,0 +1,164 @@
+// LatencyStats.cpp
+
+#include "LatencyStats.h"
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace hint_map {
+
+    static const int METRIC_COUNT = (int)LatencyMetric::Count;
+
+    // One block per thread that ever recorded. Blocks outlive their thread so its samples
+    // stay in the report; they are only freed at process exit.
+    struct ThreadLatencyBlock {
+        LatencyHistogram histograms[METRIC_COUNT];
+    };
+
+    static std::mutex registryMutex;
+    static std::vector<std::unique_ptr<ThreadLatencyBlock>> registry;
+
+    static ThreadLatencyBlock* RegisterThreadBlock() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.emplace_back(new ThreadLatencyBlock());
+        return registry.back().get();
+    }
+
+    static int HighestBit(uint64_t v) {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanReverse64(&index, v);
+        return (int)index;
+#elif defined(_MSC_VER)
+        unsigned long index;
+        if (_BitScanReverse(&index, (unsigned long)(v >> 32))) return (int)index + 32;
+        _BitScanReverse(&index, (unsigned long)v);
+        return (int)index;
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+
+    const char* LatencyMetricName(LatencyMetric metric) {
+        switch (metric) {
+        case LatencyMetric::HookProc:       return "Hook proc";
+        case LatencyMetric::KeyQueueDelay:  return "Key queue delay";
+        case LatencyMetric::ProcessKey:     return "Process key";
+        case LatencyMetric::ScanElements:   return "Scan elements";
+        case LatencyMetric::WorkerScan:     return "Worker scan";
+        case LatencyMetric::GenerateLabels: return "Generate labels";
+        case LatencyMetric::ShowOverlay:    return "Show overlay";
+        case LatencyMetric::RenderOverlay:  return "Render overlay";
+        case LatencyMetric::Invoke:         return "Invoke";
+        default:                            return "?";
+        }
+    }
+
+    int LatencyHistogram::BucketIndex(uint64_t ns) {
+        if (ns < 2 * SUB_COUNT) return (int)ns;
+        int msb = HighestBit(ns);
+        if (msb > MAX_MSB) return BUCKET_COUNT - 1;
+        int shift = msb - SUB_BITS;
+        return (shift + 1) * SUB_COUNT + (int)((ns >> shift) - SUB_COUNT);
+    }
+
+    uint64_t LatencyHistogram::BucketUpperBound(int index) {
+        if (index < 2 * SUB_COUNT) return (uint64_t)index;
+        int shift = index / SUB_COUNT - 1;
+        uint64_t mantissa = (uint64_t)(index % SUB_COUNT + SUB_COUNT);
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    void LatencyHistogram::Merge(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            uint64_t n = other.buckets[i].load(std::memory_order_relaxed);
+            if (n) Bump(buckets[i], n);
+        }
+        Bump(count, other.count.load(std::memory_order_relaxed));
+        Bump(sum, other.sum.load(std::memory_order_relaxed));
+        uint64_t otherMax = other.max.load(std::memory_order_relaxed);
+        if (otherMax > max.load(std::memory_order_relaxed)) max.store(otherMax, std::memory_order_relaxed);
+    }
+
+    void LatencyHistogram::Reset() {
+        for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t LatencyHistogram::Mean() const {
+        uint64_t n = Count();
+        return n ? sum.load(std::memory_order_relaxed) / n : 0;
+    }
+
+    uint64_t LatencyHistogram::Percentile(double p) const {
+        // Sum the buckets rather than trusting count, which a concurrent writer may have moved on
+        uint64_t total = 0;
+        for (int i = 0; i < BUCKET_COUNT; ++i) total += buckets[i].load(std::memory_order_relaxed);
+        if (total == 0) return 0;
+
+        if (p < 0) p = 0;
+        if (p > 100) p = 100;
+        uint64_t rank = (uint64_t)(p / 100.0 * (double)total + 0.5);
+        if (rank < 1) rank = 1;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                uint64_t upper = BucketUpperBound(i);
+                uint64_t m = Max();
+                return (m && upper > m) ? m : upper;
+            }
+        }
+        return Max();
+    }
+
+    void RecordLatency(LatencyMetric metric, uint64_t ns) {
+        static thread_local ThreadLatencyBlock* block = RegisterThreadBlock();
+        block->histograms[(int)metric].Record(ns);
+    }
+
+    LatencyHistogram SnapshotLatency(LatencyMetric metric) {
+        LatencyHistogram merged;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& block : registry) {
+            merged.Merge(block->histograms[(int)metric]);
+        }
+        return merged;
+    }
+
+    void ResetLatencyStats() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& block : registry) {
+            for (auto& h : block->histograms) h.Reset();
+        }
+    }
+
+    static void AppendMicros(char* out, size_t size, uint64_t ns) {
+        snprintf(out, size, "%.1f", ns / 1000.0);
+    }
+
+    std::string FormatLatencyReport() {
+        std::string report = "Metric              Count     p50 us     p99 us     max us\n";
+        for (int m = 0; m < METRIC_COUNT; ++m) {
+            LatencyHistogram h = SnapshotLatency((LatencyMetric)m);
+
+            char p50[32], p99[32], mx[32], line[160];
+            AppendMicros(p50, sizeof(p50), h.Percentile(50));
+            AppendMicros(p99, sizeof(p99), h.Percentile(99));
+            AppendMicros(mx, sizeof(mx), h.Max());
+            snprintf(line, sizeof(line), "%-16s %8llu %10s %10s %10s\n",
+                LatencyMetricName((LatencyMetric)m), (unsigned long long)h.Count(), p50, p99, mx);
+            report += line;
+        }
+        return report;
+    }
+
+}
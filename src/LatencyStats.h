@@ -0,0 +1,102 @@
+// LatencyStats.h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace hint_map {
+
+    enum class LatencyMetric {
+        HookProc,           // SuppressKeyboardProc, on the hook thread
+        KeyQueueDelay,      // hook push -> UI thread drain
+        ProcessKey,         // ProcessKeyCommonAndMaybeConsume
+        ScanElements,       // GetClickableElements, in this process
+        WorkerScan,         // scan request -> answer from the scan worker process
+        GenerateLabels,     // GenerateHintLabels
+        ShowOverlay,        // ShowHintOverlay (UI thread part)
+        RenderOverlay,      // overlay rasterisation, worker thread
+        Invoke,             // UIA invoke of a matched hint
+        Count
+    };
+
+    const char* LatencyMetricName(LatencyMetric metric);
+
+    // Log-linear histogram in the style of HdrHistogram: values below 64 ns are exact,
+    // above that each power of two is split into 32 sub-buckets (~3% relative error).
+    // Values are nanoseconds, clamped to ~4.8 hours.
+    class LatencyHistogram {
+    public:
+        static const int SUB_BITS = 5;
+        static const int SUB_COUNT = 1 << SUB_BITS;
+        static const int MAX_MSB = 43;
+        static const int BUCKET_COUNT = (MAX_MSB - SUB_BITS + 2) * SUB_COUNT;
+
+        LatencyHistogram() { Reset(); }
+        LatencyHistogram(const LatencyHistogram& other) { Reset(); Merge(other); }
+        LatencyHistogram& operator=(const LatencyHistogram& other) { Reset(); Merge(other); return *this; }
+
+        // Single writer. Readers on other threads may Merge concurrently and see a
+        // slightly stale but never torn view.
+        void Record(uint64_t ns) {
+            Bump(buckets[BucketIndex(ns)], 1);
+            Bump(count, 1);
+            Bump(sum, ns);
+            if (ns > max.load(std::memory_order_relaxed)) max.store(ns, std::memory_order_relaxed);
+        }
+
+        void Merge(const LatencyHistogram& other);
+        void Reset();
+
+        uint64_t Count() const { return count.load(std::memory_order_relaxed); }
+        uint64_t Max() const { return max.load(std::memory_order_relaxed); }
+        uint64_t Mean() const;
+
+        // Value at percentile p in [0, 100], reported as the upper edge of its bucket
+        uint64_t Percentile(double p) const;
+
+        static int BucketIndex(uint64_t ns);
+        static uint64_t BucketUpperBound(int index);
+
+    private:
+        static void Bump(std::atomic<uint64_t>& a, uint64_t by) {
+            a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+        }
+
+        std::atomic<uint64_t> buckets[BUCKET_COUNT];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> max;
+    };
+
+    // Records into the calling thread's histogram; the first call on a thread registers it.
+    void RecordLatency(LatencyMetric metric, uint64_t ns);
+
+    // All threads' histograms for metric merged together
+    LatencyHistogram SnapshotLatency(LatencyMetric metric);
+    void ResetLatencyStats();
+
+    // One line per metric: count, p50, p99, max
+    std::string FormatLatencyReport();
+
+    class ScopedLatencyTimer {
+    public:
+        explicit ScopedLatencyTimer(LatencyMetric metric)
+            : metric(metric), start(std::chrono::steady_clock::now()) {}
+
+        ~ScopedLatencyTimer() {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            RecordLatency(metric, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+
+        ScopedLatencyTimer(const ScopedLatencyTimer&) = delete;
+        ScopedLatencyTimer& operator=(const ScopedLatencyTimer&) = delete;
+
+    private:
+        LatencyMetric metric;
+        std::chrono::steady_clock::time_point start;
+    };
+
+}
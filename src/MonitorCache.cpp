@@ -0,0 +1,135 @@
+#include "MonitorCache.h"
+#include <ShellScalingApi.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#pragma comment(lib, "Shcore.lib")
+
+namespace hint_map {
+
+    static HWND s_cacheWnd = nullptr;
+    static HINSTANCE s_hInst = nullptr;
+
+    static const MonitorTopology s_emptyTopology;
+    static std::atomic<const MonitorTopology*> s_current{ &s_emptyTopology };
+
+    // Replaced snapshots are retired rather than freed: a reader on another thread may
+    // still hold a reference, and display changes are rare enough that this never grows.
+    static std::vector<std::unique_ptr<MonitorTopology>> s_snapshots;
+
+    static BOOL CALLBACK CollectMonitor(HMONITOR hMon, HDC, LPRECT, LPARAM lParam) {
+        auto* monitors = reinterpret_cast<std::vector<MonitorEntry>*>(lParam);
+
+        MONITORINFOEXW mi = {};
+        mi.cbSize = sizeof(mi);
+        if (!GetMonitorInfoW(hMon, &mi)) return TRUE;
+
+        MonitorEntry entry;
+        entry.handle = hMon;
+        entry.bounds = MakeRect(mi.rcMonitor.left, mi.rcMonitor.top, mi.rcMonitor.right, mi.rcMonitor.bottom);
+        entry.work = MakeRect(mi.rcWork.left, mi.rcWork.top, mi.rcWork.right, mi.rcWork.bottom);
+
+        UINT dpiX = 96, dpiY = 96;
+        if (SUCCEEDED(GetDpiForMonitor(hMon, MDT_EFFECTIVE_DPI, &dpiX, &dpiY))) entry.dpi = dpiX;
+
+        DEVMODEW dm = {};
+        dm.dmSize = sizeof(dm);
+        if (EnumDisplaySettingsW(mi.szDevice, ENUM_CURRENT_SETTINGS, &dm) && dm.dmDisplayFrequency > 1) {
+            entry.refreshHz = dm.dmDisplayFrequency;
+        }
+
+        monitors->push_back(entry);
+        return TRUE;
+    }
+
+    static bool SameRect(const Rect& a, const Rect& b) {
+        return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+    }
+
+    static bool SameLayout(const MonitorTopology& current, const std::vector<MonitorEntry>& monitors, const Rect& virtualScreen) {
+        if (&current == &s_emptyTopology) return false;
+        if (!SameRect(current.VirtualScreen(), virtualScreen)) return false;
+        if (current.Monitors().size() != monitors.size()) return false;
+        for (size_t i = 0; i < monitors.size(); ++i) {
+            const MonitorEntry& a = current.Monitors()[i];
+            const MonitorEntry& b = monitors[i];
+            if (a.handle != b.handle || a.dpi != b.dpi || a.refreshHz != b.refreshHz ||
+                !SameRect(a.bounds, b.bounds) || !SameRect(a.work, b.work)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void RefreshMonitorTopology() {
+        std::vector<MonitorEntry> monitors;
+        EnumDisplayMonitors(nullptr, nullptr, CollectMonitor, reinterpret_cast<LPARAM>(&monitors));
+
+        int left = GetSystemMetrics(SM_XVIRTUALSCREEN);
+        int top = GetSystemMetrics(SM_YVIRTUALSCREEN);
+        Rect virtualScreen = MakeRect(left, top,
+            left + GetSystemMetrics(SM_CXVIRTUALSCREEN), top + GetSystemMetrics(SM_CYVIRTUALSCREEN));
+
+        // WM_SETTINGCHANGE fires for far more than display settings; skip no-op refreshes
+        if (SameLayout(CurrentMonitorTopology(), monitors, virtualScreen)) return;
+
+        s_snapshots.emplace_back(new MonitorTopology(std::move(monitors), virtualScreen));
+        s_current.store(s_snapshots.back().get(), std::memory_order_release);
+
+        OutputDebugString(L"[hint_map] Monitor topology refreshed.\n");
+    }
+
+    static LRESULT CALLBACK MonitorCacheWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+        switch (msg) {
+        case WM_DISPLAYCHANGE:
+        case WM_DPICHANGED:
+        case WM_SETTINGCHANGE:
+            RefreshMonitorTopology();
+            return 0;
+        }
+        return DefWindowProc(hwnd, msg, wParam, lParam);
+    }
+
+    void InitMonitorCache(HINSTANCE hInstance) {
+        if (s_cacheWnd) return;
+        s_hInst = hInstance;
+
+        const wchar_t CLASS_NAME[] = L"MonitorCacheWindow";
+
+        WNDCLASSW wc = {};
+        wc.lpfnWndProc = MonitorCacheWndProc;
+        wc.hInstance = s_hInst;
+        wc.lpszClassName = CLASS_NAME;
+        RegisterClassW(&wc);
+
+        // Top-level (not message-only) so display broadcasts reach it
+        s_cacheWnd = CreateWindowExW(
+            0, CLASS_NAME, L"MonitorCache",
+            WS_OVERLAPPED, 0, 0, 0, 0,
+            nullptr, nullptr, s_hInst, nullptr);
+
+        if (!s_cacheWnd) {
+            wchar_t buf[128];
+            swprintf(buf, 128, L"[hint_map] Monitor cache window failed, error=%lu\n", GetLastError());
+            OutputDebugString(buf);
+        }
+
+        RefreshMonitorTopology();
+    }
+
+    void ShutdownMonitorCache() {
+        if (s_cacheWnd) {
+            DestroyWindow(s_cacheWnd);
+            s_cacheWnd = nullptr;
+        }
+        UnregisterClass(L"MonitorCacheWindow", s_hInst);
+
+        s_current.store(&s_emptyTopology, std::memory_order_release);
+        s_snapshots.clear();
+    }
+
+    const MonitorTopology& CurrentMonitorTopology() {
+        return *s_current.load(std::memory_order_acquire);
+    }
+
+}
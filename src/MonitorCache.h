@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Windows.h>
+#include "MonitorTopology.h"
+
+namespace hint_map {
+
+    // Builds the monitor topology and keeps it current. A hidden window listens for
+    // display and DPI change notifications and publishes a fresh snapshot; everything
+    // else only reads.
+    void InitMonitorCache(HINSTANCE hInstance);
+    void ShutdownMonitorCache();
+
+    // Lock-free; safe from any thread. Snapshots stay alive until ShutdownMonitorCache.
+    const MonitorTopology& CurrentMonitorTopology();
+
+}
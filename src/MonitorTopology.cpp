@@ -0,0 +1,87 @@
+// MonitorTopology.cpp
+
+#include "MonitorTopology.h"
+#include <algorithm>
+#include <climits>
+
+namespace hint_map {
+
+    MonitorTopology::MonitorTopology(std::vector<MonitorEntry> monitorList, const Rect& virtualRect)
+        : monitors(std::move(monitorList)), virtualScreen(virtualRect)
+    {
+        for (const auto& m : monitors) {
+            slabEdges.push_back(m.bounds.left);
+            slabEdges.push_back(m.bounds.right);
+        }
+        std::sort(slabEdges.begin(), slabEdges.end());
+        slabEdges.erase(std::unique(slabEdges.begin(), slabEdges.end()), slabEdges.end());
+
+        if (slabEdges.size() < 2) return;
+        slabs.resize(slabEdges.size() - 1);
+
+        for (size_t s = 0; s < slabs.size(); ++s) {
+            const int x = slabEdges[s];
+            for (size_t i = 0; i < monitors.size(); ++i) {
+                const Rect& b = monitors[i].bounds;
+                if (b.left <= x && x < b.right && !b.Empty()) {
+                    slabs[s].push_back({ b.top, b.bottom, (int)i });
+                }
+            }
+            std::sort(slabs[s].begin(), slabs[s].end(),
+                [](const SlabEntry& a, const SlabEntry& b) { return a.top < b.top; });
+        }
+    }
+
+    int MonitorTopology::FindMonitor(int x, int y) const {
+        if (slabs.empty()) return -1;
+
+        auto edge = std::upper_bound(slabEdges.begin(), slabEdges.end(), x);
+        if (edge == slabEdges.begin() || edge == slabEdges.end()) return -1;
+        const std::vector<SlabEntry>& slab = slabs[(edge - slabEdges.begin()) - 1];
+
+        auto it = std::upper_bound(slab.begin(), slab.end(), y,
+            [](int value, const SlabEntry& e) { return value < e.top; });
+        if (it == slab.begin()) return -1;
+        --it;
+        return (y < it->bottom) ? it->monitor : -1;
+    }
+
+    int MonitorTopology::FindNearestMonitor(int x, int y) const {
+        int hit = FindMonitor(x, y);
+        if (hit >= 0 || monitors.empty()) return hit;
+
+        // Off every monitor: the set is tiny, so a linear distance scan is fine here
+        long long bestDist = LLONG_MAX;
+        for (size_t i = 0; i < monitors.size(); ++i) {
+            const Rect& b = monitors[i].bounds;
+            long long dx = (x < b.left) ? b.left - x : (x >= b.right ? x - b.right + 1 : 0);
+            long long dy = (y < b.top) ? b.top - y : (y >= b.bottom ? y - b.bottom + 1 : 0);
+            long long d = dx * dx + dy * dy;
+            if (d < bestDist) {
+                bestDist = d;
+                hit = (int)i;
+            }
+        }
+        return hit;
+    }
+
+    int MonitorTopology::FindMonitorForRect(const Rect& r) const {
+        int best = -1;
+        long long bestArea = 0;
+        for (size_t i = 0; i < monitors.size(); ++i) {
+            long long area = OverlapArea(r, monitors[i].bounds);
+            if (area > bestArea) {
+                bestArea = area;
+                best = (int)i;
+            }
+        }
+        if (best >= 0) return best;
+        return FindNearestMonitor(r.left + r.Width() / 2, r.top + r.Height() / 2);
+    }
+
+    float MonitorTopology::ScaleAt(int x, int y) const {
+        int i = FindNearestMonitor(x, y);
+        return (i >= 0) ? monitors[i].Scale() : 1.0f;
+    }
+
+}
@@ -0,0 +1,58 @@
+// MonitorTopology.h
+#pragma once
+
+#include <vector>
+#include "Geometry.h"
+
+namespace hint_map {
+
+    struct MonitorEntry {
+        Rect bounds;                // full monitor rect, virtual-screen coordinates
+        Rect work;                  // work area (excludes the taskbar)
+        unsigned dpi = 96;          // effective DPI
+        unsigned refreshHz = 60;
+        void* handle = nullptr;     // HMONITOR on Windows
+
+        float Scale() const { return dpi / 96.0f; }
+    };
+
+    // Immutable snapshot of the monitor layout. Built once per display change and then
+    // shared read-only, so lookups need no locking.
+    class MonitorTopology {
+    public:
+        MonitorTopology() = default;
+        MonitorTopology(std::vector<MonitorEntry> monitors, const Rect& virtualScreen);
+
+        const std::vector<MonitorEntry>& Monitors() const { return monitors; }
+        const Rect& VirtualScreen() const { return virtualScreen; }
+
+        // Index of the monitor containing (x, y) in O(log n), or -1 if the point is on no monitor.
+        int FindMonitor(int x, int y) const;
+
+        // Like MONITOR_DEFAULTTONEAREST: the containing monitor, else the closest one.
+        // -1 only when there are no monitors.
+        int FindNearestMonitor(int x, int y) const;
+
+        // Monitor with the largest intersection with r, else the one nearest its centre.
+        int FindMonitorForRect(const Rect& r) const;
+
+        // Effective DPI scale at (x, y), 1.0 when there are no monitors.
+        float ScaleAt(int x, int y) const;
+
+    private:
+        struct SlabEntry {
+            int top;
+            int bottom;
+            int monitor;
+        };
+
+        std::vector<MonitorEntry> monitors;
+        Rect virtualScreen;
+
+        // Vertical slabs between consecutive distinct monitor x-edges. Each slab lists the
+        // monitors spanning it sorted by top, so a point lookup is two binary searches.
+        std::vector<int> slabEdges;
+        std::vector<std::vector<SlabEntry>> slabs;
+    };
+
+}
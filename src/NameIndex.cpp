@@ -0,0 +1,170 @@
+// NameIndex.cpp
+
+#include "NameIndex.h"
+#include <algorithm>
+#include <cwctype>
+#include <unordered_map>
+
+namespace hint_map {
+
+    std::wstring FoldName(const std::wstring& name) {
+        std::wstring folded;
+        folded.reserve(name.size());
+        bool space = false;
+        for (wchar_t c : name) {
+            if (std::iswalnum(c)) {
+                if (space && !folded.empty()) folded += L' ';
+                space = false;
+                folded += (wchar_t)std::towlower(c);
+            }
+            else {
+                space = true;
+            }
+        }
+        return folded;
+    }
+
+    static uint64_t GramKey(wchar_t a, wchar_t b, wchar_t c) {
+        return ((uint64_t)(a & 0x1FFFFF) << 42) | ((uint64_t)(b & 0x1FFFFF) << 21) | (uint64_t)(c & 0x1FFFFF);
+    }
+
+    // Distinct trigrams of the text with a leading space, so word starts get their own grams
+    static void CollectGrams(const std::wstring& folded, std::vector<uint64_t>& grams) {
+        grams.clear();
+        const std::wstring padded = L" " + folded;
+        for (size_t i = 0; i + 2 < padded.size(); ++i) {
+            grams.push_back(GramKey(padded[i], padded[i + 1], padded[i + 2]));
+        }
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    }
+
+    void NameIndex::Clear() {
+        unique.clear();
+        targetName.clear();
+        nameTargetStart.clear();
+        nameTargets.clear();
+        gramKeys.clear();
+        gramStart.clear();
+        gramNames.clear();
+        hits.clear();
+    }
+
+    void NameIndex::Build(const std::vector<std::wstring>& names) {
+        Clear();
+
+        // Intern
+        std::unordered_map<std::wstring, int> ids;
+        targetName.resize(names.size(), -1);
+        for (size_t i = 0; i < names.size(); ++i) {
+            std::wstring folded = FoldName(names[i]);
+            if (folded.empty()) continue;
+            auto it = ids.find(folded);
+            if (it == ids.end()) {
+                it = ids.emplace(folded, (int)unique.size()).first;
+                unique.push_back(folded);
+            }
+            targetName[i] = it->second;
+        }
+
+        // Targets per name, in target order
+        nameTargetStart.assign(unique.size() + 1, 0);
+        for (int id : targetName) if (id >= 0) ++nameTargetStart[id + 1];
+        for (size_t n = 1; n < nameTargetStart.size(); ++n) nameTargetStart[n] += nameTargetStart[n - 1];
+        nameTargets.resize(nameTargetStart.back());
+        std::vector<int> fill(nameTargetStart.begin(), nameTargetStart.end() - 1);
+        for (size_t i = 0; i < targetName.size(); ++i) {
+            if (targetName[i] >= 0) nameTargets[fill[targetName[i]]++] = (int)i;
+        }
+
+        // Trigram postings: sort (gram, name) pairs, then compress into CSR
+        std::vector<std::pair<uint64_t, int>> pairs;
+        std::vector<uint64_t> grams;
+        for (size_t n = 0; n < unique.size(); ++n) {
+            CollectGrams(unique[n], grams);
+            for (uint64_t g : grams) pairs.push_back(std::make_pair(g, (int)n));
+        }
+        std::sort(pairs.begin(), pairs.end());
+
+        gramNames.reserve(pairs.size());
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            if (gramKeys.empty() || gramKeys.back() != pairs[i].first) {
+                gramKeys.push_back(pairs[i].first);
+                gramStart.push_back((int)i);
+            }
+            gramNames.push_back(pairs[i].second);
+        }
+        gramStart.push_back((int)pairs.size());
+
+        hits.assign(unique.size(), 0);
+    }
+
+    std::vector<int> NameIndex::Search(const std::wstring& query, size_t maxResults) const {
+        std::vector<int> results;
+        const std::wstring q = FoldName(query);
+        if (q.empty() || unique.empty() || maxResults == 0) return results;
+
+        // Candidate names and how many of the query's trigrams each one has
+        std::vector<int> candidates;
+        std::vector<uint64_t> grams;
+        int required = 0;
+        if (q.size() < 3) {
+            // Too short for trigrams: a plain scan of the distinct names is cheap enough
+            for (size_t n = 0; n < unique.size(); ++n) {
+                if (unique[n].find(q) != std::wstring::npos) candidates.push_back((int)n);
+            }
+        }
+        else {
+            CollectGrams(q, grams);
+            for (uint64_t g : grams) {
+                auto it = std::lower_bound(gramKeys.begin(), gramKeys.end(), g);
+                if (it == gramKeys.end() || *it != g) continue;
+                const size_t k = it - gramKeys.begin();
+                for (int p = gramStart[k]; p < gramStart[k + 1]; ++p) {
+                    if (hits[gramNames[p]]++ == 0) candidates.push_back(gramNames[p]);
+                }
+            }
+            // Fuzzy: half the query's trigrams is enough to be listed
+            required = (int)(grams.size() + 1) / 2;
+        }
+
+        struct Ranked {
+            int score;
+            int length;
+            int name;
+        };
+        std::vector<Ranked> ranked;
+        ranked.reserve(candidates.size());
+        for (int n : candidates) {
+            const int h = grams.empty() ? 0 : hits[n];
+            hits[n] = 0;
+            const std::wstring& name = unique[n];
+            const size_t pos = name.find(q);
+            int tier = 0;
+            if (pos == 0) tier = 3;
+            else if (pos != std::wstring::npos && name[pos - 1] == L' ') tier = 2;
+            else if (pos != std::wstring::npos) tier = 1;
+            if (tier == 0 && h < required) continue;
+
+            const int coverage = grams.empty() ? 1024 : h * 1024 / (int)grams.size();
+            ranked.push_back({ tier * 2048 + coverage, (int)name.size(), n });
+        }
+
+        std::sort(ranked.begin(), ranked.end(), [](const Ranked& a, const Ranked& b) {
+            if (a.score != b.score) return a.score > b.score;
+            if (a.length != b.length) return a.length < b.length;
+            return a.name < b.name;
+        });
+
+        // Interned names back to targets. Names were numbered in first-seen order, so a
+        // tie within one score keeps targets in scan order.
+        for (const Ranked& r : ranked) {
+            for (int t = nameTargetStart[r.name]; t < nameTargetStart[r.name + 1]; ++t) {
+                results.push_back(nameTargets[t]);
+                if (results.size() >= maxResults) return results;
+            }
+        }
+        return results;
+    }
+
+}
@@ -0,0 +1,43 @@
+// NameIndex.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hint_map {
+
+    // Fuzzy search over target names for the "/" search sub-mode.
+    // Names are case-folded and interned (toolbars repeat the same names a lot), then every
+    // distinct name is indexed by its character trigrams. A query counts trigram hits per
+    // name through the postings, so typos and reordered words still match, and only names
+    // sharing a trigram with the query are ever scored.
+    class NameIndex {
+    public:
+        // names[i] belongs to target i; empty names are never returned
+        void Build(const std::vector<std::wstring>& names);
+        void Clear();
+
+        int Size() const { return (int)targetName.size(); }
+        bool Empty() const { return targetName.empty(); }
+
+        // Target indices, best match first, at most maxResults. Prefix and word-start
+        // matches rank above plain substrings, which rank above trigram-only matches;
+        // shorter names win ties, then lower indices.
+        std::vector<int> Search(const std::wstring& query, size_t maxResults = 64) const;
+
+    private:
+        std::vector<std::wstring> unique;       // folded distinct names
+        std::vector<int> targetName;            // target -> unique name, -1 if empty
+        std::vector<int> nameTargetStart;       // unique name -> targets, CSR over nameTargets
+        std::vector<int> nameTargets;
+        std::vector<uint64_t> gramKeys;         // sorted distinct trigrams
+        std::vector<int> gramStart;             // postings of gramKeys[k]: gramNames[gramStart[k] .. gramStart[k + 1])
+        std::vector<int> gramNames;
+        mutable std::vector<uint16_t> hits;     // per unique name, scratch for Search
+    };
+
+    // Lower-case with punctuation folded to spaces, so "Save_As" finds "save as"
+    std::wstring FoldName(const std::wstring& name);
+
+}
@@ -0,0 +1,87 @@
+// Occlusion.cpp
+
+#include "Occlusion.h"
+#include <dwmapi.h>
+#include "MonitorCache.h"
+#include "TraceRecorder.h"
+#pragma comment(lib, "Dwmapi.lib")
+
+namespace hint_map {
+
+    // Visible frame without the invisible resize borders Windows 10+ adds around windows
+    static bool GetVisibleFrame(HWND hwnd, RECT& r) {
+        if (SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_EXTENDED_FRAME_BOUNDS, &r, sizeof(r)))) return true;
+        return GetWindowRect(hwnd, &r) != FALSE;
+    }
+
+    // Windows that paint over what's below them
+    static bool IsOccluder(HWND hwnd) {
+        if (!IsWindowVisible(hwnd) || IsIconic(hwnd)) return false;
+
+        // Click-through layered windows are overlays (ours, screen tools); they rarely hide much
+        const LONG_PTR exStyle = GetWindowLongPtr(hwnd, GWL_EXSTYLE);
+        if ((exStyle & WS_EX_LAYERED) && (exStyle & WS_EX_TRANSPARENT)) return false;
+
+        DWORD pid = 0;
+        GetWindowThreadProcessId(hwnd, &pid);
+        if (pid == GetCurrentProcessId()) return false;
+
+        DWORD cloaked = 0;
+        if (SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) && cloaked) return false;
+        return true;
+    }
+
+    Region VisibleWindowRegion(HWND hwnd) {
+        RECT wr;
+        if (!hwnd || !IsWindowVisible(hwnd) || IsIconic(hwnd) || !GetVisibleFrame(hwnd, wr)) return Region();
+
+        // Gaps between monitors of different sizes are not visible either
+        std::vector<Rect> screens;
+        for (const auto& m : CurrentMonitorTopology().Monitors()) screens.push_back(m.bounds);
+        Region visible = Region(MakeRect(wr.left, wr.top, wr.right, wr.bottom));
+        if (!screens.empty()) visible = visible.Intersect(Region::FromRects(screens));
+
+        // GW_HWNDPREV walks up the z-order, topmost windows last
+        std::vector<Rect> above;
+        for (HWND w = GetWindow(hwnd, GW_HWNDPREV); w; w = GetWindow(w, GW_HWNDPREV)) {
+            if (!IsOccluder(w)) continue;
+            RECT r;
+            if (!GetVisibleFrame(w, r)) continue;
+            Rect rect = MakeRect(r.left, r.top, r.right, r.bottom);
+            if (Intersects(rect, visible.Bounds())) above.push_back(rect);
+        }
+        if (above.empty()) return visible;
+        return visible.Subtract(Region::FromRects(above));
+    }
+
+    void CullOccludedTargets(HWND hwnd, std::vector<HintTarget>& targets, double minVisible) {
+        if (!hwnd || targets.empty()) return;
+        ScopedTrace trace("Occlusion");
+
+        const Region visible = VisibleWindowRegion(hwnd);
+        if (visible.Empty()) return;   // can't tell; better too many hints than none
+
+        size_t kept = 0;
+        for (size_t i = 0; i < targets.size(); ++i) {
+            HintTarget& t = targets[i];
+            const Rect r = MakeRect(t.rect.left, t.rect.top, t.rect.right, t.rect.bottom);
+            const long long area = (long long)r.Width() * r.Height();
+            if (area <= 0) continue;
+
+            const long long seen = visible.IntersectArea(r);
+            if ((double)seen < minVisible * (double)area) continue;
+            if (seen < area) {
+                Rect clip = visible.IntersectBounds(r);
+                t.rect = { clip.left, clip.top, clip.right, clip.bottom };
+            }
+            if (kept != i) targets[kept] = std::move(t);
+            ++kept;
+        }
+
+        wchar_t buf[96];
+        swprintf_s(buf, L"[hint_map] Occlusion: kept %zu of %zu targets.\n", kept, targets.size());
+        OutputDebugString(buf);
+        targets.resize(kept);
+    }
+
+}
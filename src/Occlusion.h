@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include "UIElementScanner.h"
+#include "RegionAlgebra.h"
+
+namespace hint_map {
+
+    // What the user can actually see of hwnd: its frame on the monitors, minus every visible
+    // top-level window above it in z-order (always-on-top tools, owned popups, ...)
+    Region VisibleWindowRegion(HWND hwnd);
+
+    // Drops targets with less than minVisible of their area visible; partly covered ones
+    // are shrunk to the bounds of their visible part so the label lands on it
+    void CullOccludedTargets(HWND hwnd, std::vector<HintTarget>& targets, double minVisible = 0.5);
+
+}
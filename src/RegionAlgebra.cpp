@@ -0,0 +1,286 @@
+// RegionAlgebra.cpp
+
+#include "RegionAlgebra.h"
+#include <algorithm>
+
+namespace hint_map {
+
+    Region::Region(const Rect& rect) {
+        if (rect.Empty()) return;
+        spans.push_back({ rect.left, rect.right });
+        bands.push_back({ rect.top, rect.bottom, 0, 1 });
+    }
+
+    void Region::PushBand(int top, int bottom, const std::vector<Span>& bandSpans) {
+        if (bandSpans.empty() || bottom <= top) return;
+
+        if (!bands.empty()) {
+            Band& last = bands.back();
+            if (last.bottom == top && last.lastSpan - last.firstSpan == (int)bandSpans.size()) {
+                bool same = true;
+                for (size_t k = 0; k < bandSpans.size() && same; ++k) {
+                    const Span& s = spans[last.firstSpan + k];
+                    same = s.left == bandSpans[k].left && s.right == bandSpans[k].right;
+                }
+                if (same) {
+                    last.bottom = bottom;
+                    return;
+                }
+            }
+        }
+
+        Band band = { top, bottom, (int)spans.size(), (int)(spans.size() + bandSpans.size()) };
+        spans.insert(spans.end(), bandSpans.begin(), bandSpans.end());
+        bands.push_back(band);
+    }
+
+    size_t Region::FirstBandBelow(int y) const {
+        size_t lo = 0, hi = bands.size();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (bands[mid].bottom <= y) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // Coverage counts over compressed x intervals, as in the classic area-of-union sweep.
+    // A node with a nonzero count is fully covered; covered[] says whether anything under
+    // a node is, so emitting a band's spans only descends into partially covered nodes.
+    class CoverageTree {
+    public:
+        explicit CoverageTree(const std::vector<int>& xs)
+            : xs(xs), count(4 * xs.size(), 0), covered(4 * xs.size(), 0) {}
+
+        void Add(int lo, int hi, int delta) { Add(1, 0, (int)xs.size() - 1, lo, hi, delta); }
+
+        void Emit(std::vector<Region::Span>& out) const {
+            if (xs.size() > 1) Emit(1, 0, (int)xs.size() - 1, out);
+        }
+
+    private:
+        // Node covers elementary intervals [l, r), i.e. xs[l] .. xs[r]
+        void Add(int node, int l, int r, int lo, int hi, int delta) {
+            if (hi <= l || r <= lo) return;
+            if (lo <= l && r <= hi) {
+                count[node] += delta;
+            }
+            else {
+                const int mid = (l + r) / 2;
+                Add(2 * node, l, mid, lo, hi, delta);
+                Add(2 * node + 1, mid, r, lo, hi, delta);
+            }
+            covered[node] = count[node] > 0 || (r - l > 1 && (covered[2 * node] || covered[2 * node + 1]));
+        }
+
+        void Emit(int node, int l, int r, std::vector<Region::Span>& out) const {
+            if (!covered[node]) return;
+            if (count[node] > 0) {
+                if (!out.empty() && out.back().right == xs[l]) out.back().right = xs[r];
+                else out.push_back({ xs[l], xs[r] });
+                return;
+            }
+            const int mid = (l + r) / 2;
+            Emit(2 * node, l, mid, out);
+            Emit(2 * node + 1, mid, r, out);
+        }
+
+        const std::vector<int>& xs;
+        std::vector<int> count;
+        std::vector<char> covered;
+    };
+
+    Region Region::FromRects(const std::vector<Rect>& rects) {
+        Region region;
+
+        struct Event {
+            int y;
+            int delta;
+            int left;       // indices into xs
+            int right;
+        };
+        std::vector<int> xs;
+        for (const Rect& r : rects) {
+            if (r.Empty()) continue;
+            xs.push_back(r.left);
+            xs.push_back(r.right);
+        }
+        if (xs.empty()) return region;
+        std::sort(xs.begin(), xs.end());
+        xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+
+        std::vector<Event> events;
+        events.reserve(xs.size());
+        for (const Rect& r : rects) {
+            if (r.Empty()) continue;
+            const int l = (int)(std::lower_bound(xs.begin(), xs.end(), r.left) - xs.begin());
+            const int h = (int)(std::lower_bound(xs.begin(), xs.end(), r.right) - xs.begin());
+            events.push_back({ r.top, 1, l, h });
+            events.push_back({ r.bottom, -1, l, h });
+        }
+        std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.y < b.y; });
+
+        // Sweep down: apply every edge at y, then the band until the next edge is fixed
+        CoverageTree tree(xs);
+        std::vector<Span> row;
+        for (size_t e = 0; e < events.size();) {
+            const int y = events[e].y;
+            while (e < events.size() && events[e].y == y) {
+                tree.Add(events[e].left, events[e].right, events[e].delta);
+                ++e;
+            }
+            if (e == events.size()) break;
+            row.clear();
+            tree.Emit(row);
+            region.PushBand(y, events[e].y, row);
+        }
+        return region;
+    }
+
+    Region Region::Combine(const Region& other, Op op) const {
+        Region result;
+        if (op == OP_INTERSECT && (Empty() || other.Empty())) return result;
+        if (op == OP_SUBTRACT && Empty()) return result;
+
+        // Every edge of either region starts a band of the result
+        std::vector<int> ys;
+        ys.reserve(2 * (bands.size() + other.bands.size()));
+        for (const Band& b : bands) { ys.push_back(b.top); ys.push_back(b.bottom); }
+        for (const Band& b : other.bands) { ys.push_back(b.top); ys.push_back(b.bottom); }
+        std::sort(ys.begin(), ys.end());
+        ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+        struct Edge {
+            int x;
+            int toggle;     // 1 for this region, 2 for the other
+        };
+        std::vector<Edge> edges;
+        std::vector<Span> out;
+        size_t ia = 0, ib = 0;
+
+        for (size_t k = 0; k + 1 < ys.size(); ++k) {
+            const int y0 = ys[k], y1 = ys[k + 1];
+            while (ia < bands.size() && bands[ia].bottom <= y0) ++ia;
+            while (ib < other.bands.size() && other.bands[ib].bottom <= y0) ++ib;
+            const Band* a = (ia < bands.size() && bands[ia].top <= y0) ? &bands[ia] : nullptr;
+            const Band* b = (ib < other.bands.size() && other.bands[ib].top <= y0) ? &other.bands[ib] : nullptr;
+
+            // Spans are disjoint within a band, so each side's coverage is a single bit
+            // that flips at each of its span edges
+            edges.clear();
+            if (a) for (int s = a->firstSpan; s < a->lastSpan; ++s) {
+                edges.push_back({ spans[s].left, 1 });
+                edges.push_back({ spans[s].right, 1 });
+            }
+            if (b) for (int s = b->firstSpan; s < b->lastSpan; ++s) {
+                edges.push_back({ other.spans[s].left, 2 });
+                edges.push_back({ other.spans[s].right, 2 });
+            }
+            std::sort(edges.begin(), edges.end(), [](const Edge& l, const Edge& r) { return l.x < r.x; });
+
+            out.clear();
+            int state = 0;
+            bool inside = false;
+            for (size_t e = 0; e < edges.size();) {
+                const int x = edges[e].x;
+                while (e < edges.size() && edges[e].x == x) state ^= edges[e++].toggle;
+
+                bool covered = false;
+                switch (op) {
+                case OP_UNION:     covered = state != 0; break;
+                case OP_INTERSECT: covered = state == 3; break;
+                case OP_SUBTRACT:  covered = state == 1; break;
+                }
+                if (covered && !inside) {
+                    out.push_back({ x, x });
+                    inside = true;
+                }
+                else if (!covered && inside) {
+                    out.back().right = x;
+                    inside = false;
+                }
+            }
+            result.PushBand(y0, y1, out);
+        }
+        return result;
+    }
+
+    Region Region::Union(const Region& other) const { return Combine(other, OP_UNION); }
+    Region Region::Intersect(const Region& other) const { return Combine(other, OP_INTERSECT); }
+    Region Region::Subtract(const Region& other) const { return Combine(other, OP_SUBTRACT); }
+
+    long long Region::Area() const {
+        long long area = 0;
+        for (const Band& b : bands) {
+            long long width = 0;
+            for (int s = b.firstSpan; s < b.lastSpan; ++s) width += spans[s].right - spans[s].left;
+            area += width * (b.bottom - b.top);
+        }
+        return area;
+    }
+
+    Rect Region::Bounds() const {
+        if (bands.empty()) return Rect();
+        Rect r = MakeRect(spans[bands.front().firstSpan].left, bands.front().top,
+            spans[bands.front().lastSpan - 1].right, bands.back().bottom);
+        for (const Band& b : bands) {
+            r.left = (std::min)(r.left, spans[b.firstSpan].left);
+            r.right = (std::max)(r.right, spans[b.lastSpan - 1].right);
+        }
+        return r;
+    }
+
+    long long Region::IntersectArea(const Rect& rect) const {
+        long long area = 0;
+        if (rect.Empty()) return area;
+        for (size_t i = FirstBandBelow(rect.top); i < bands.size() && bands[i].top < rect.bottom; ++i) {
+            const Band& b = bands[i];
+            const int height = (std::min)(b.bottom, rect.bottom) - (std::max)(b.top, rect.top);
+            long long width = 0;
+            for (int s = b.firstSpan; s < b.lastSpan && spans[s].left < rect.right; ++s) {
+                const int overlap = (std::min)(spans[s].right, rect.right) - (std::max)(spans[s].left, rect.left);
+                if (overlap > 0) width += overlap;
+            }
+            area += width * height;
+        }
+        return area;
+    }
+
+    Rect Region::IntersectBounds(const Rect& rect) const {
+        Rect r;
+        bool any = false;
+        if (rect.Empty()) return r;
+        for (size_t i = FirstBandBelow(rect.top); i < bands.size() && bands[i].top < rect.bottom; ++i) {
+            const Band& b = bands[i];
+            for (int s = b.firstSpan; s < b.lastSpan && spans[s].left < rect.right; ++s) {
+                const int left = (std::max)(spans[s].left, rect.left);
+                const int right = (std::min)(spans[s].right, rect.right);
+                if (right <= left) continue;
+                const int top = (std::max)(b.top, rect.top);
+                const int bottom = (std::min)(b.bottom, rect.bottom);
+                if (!any) {
+                    r = MakeRect(left, top, right, bottom);
+                    any = true;
+                    continue;
+                }
+                r.left = (std::min)(r.left, left);
+                r.top = (std::min)(r.top, top);
+                r.right = (std::max)(r.right, right);
+                r.bottom = (std::max)(r.bottom, bottom);
+            }
+        }
+        return r;
+    }
+
+    std::vector<Rect> Region::Rects() const {
+        std::vector<Rect> rects;
+        rects.reserve(spans.size());
+        for (const Band& b : bands) {
+            for (int s = b.firstSpan; s < b.lastSpan; ++s) {
+                rects.push_back(MakeRect(spans[s].left, b.top, spans[s].right, b.bottom));
+            }
+        }
+        return rects;
+    }
+
+}
@@ -0,0 +1,63 @@
+// RegionAlgebra.h
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "Geometry.h"
+
+namespace hint_map {
+
+    // Set of pixels stored the way GDI and X11 store regions: horizontal bands, each with
+    // sorted, disjoint x-spans. Vertically adjacent bands with identical spans are merged,
+    // so a region has one canonical form. Binary operations walk both band lists once.
+    class Region {
+    public:
+        Region() = default;
+        explicit Region(const Rect& rect);
+
+        // Union of many rects in one sweep; much faster than folding Union over them
+        static Region FromRects(const std::vector<Rect>& rects);
+
+        Region Union(const Region& other) const;
+        Region Intersect(const Region& other) const;
+        Region Subtract(const Region& other) const;
+
+        bool Empty() const { return bands.empty(); }
+        long long Area() const;
+        Rect Bounds() const;
+
+        // Area and bounding box of (this & rect) without building the intersection
+        long long IntersectArea(const Rect& rect) const;
+        Rect IntersectBounds(const Rect& rect) const;
+
+        // Disjoint rects covering the region, band by band
+        std::vector<Rect> Rects() const;
+
+        int BandCount() const { return (int)bands.size(); }
+
+        struct Span {
+            int left;
+            int right;
+        };
+
+    private:
+        struct Band {
+            int top;
+            int bottom;
+            int firstSpan;      // spans[firstSpan .. lastSpan)
+            int lastSpan;
+        };
+
+        enum Op { OP_UNION, OP_INTERSECT, OP_SUBTRACT };
+        Region Combine(const Region& other, Op op) const;
+
+        // Appends a band, merging it into the previous one when they touch and match
+        void PushBand(int top, int bottom, const std::vector<Span>& bandSpans);
+        // First band whose bottom is below y
+        size_t FirstBandBelow(int y) const;
+
+        std::vector<Band> bands;
+        std::vector<Span> spans;
+    };
+
+}
@@ -0,0 +1,269 @@
+// RegionDetector.cpp
+
+#include "RegionDetector.h"
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HINT_MAP_SSE2 1
+#endif
+
+namespace hint_map {
+
+    // Horizontal run of set mask pixels on one row
+    struct Run {
+        int y;
+        int x0;
+        int x1;     // exclusive
+    };
+
+    // Runs the band function on [0, height) split into roughly equal row ranges
+    template <typename Fn>
+    static void ForEachBand(int height, int threads, Fn fn) {
+        if (threads <= 1 || height < 64) {
+            fn(0, 0, height);
+            return;
+        }
+        std::vector<std::future<void>> work;
+        for (int b = 1; b < threads; ++b) {
+            int y0 = (int)((long long)height * b / threads);
+            int y1 = (int)((long long)height * (b + 1) / threads);
+            work.push_back(std::async(std::launch::async, [&fn, b, y0, y1]() { fn(b, y0, y1); }));
+        }
+        fn(0, 0, (int)((long long)height / threads));
+        for (auto& w : work) w.get();
+    }
+
+    // Luma approximation (77 R + 150 G + 29 B) / 256
+    static void GrayRow(const uint8_t* src, uint8_t* dst, int width) {
+        int x = 0;
+#ifdef HINT_MAP_SSE2
+        const __m128i mask = _mm_set1_epi32(0xFF);
+        const __m128i kr = _mm_set1_epi16(77), kg = _mm_set1_epi16(150), kb = _mm_set1_epi16(29);
+        for (; x + 8 <= width; x += 8) {
+            __m128i p0 = _mm_loadu_si128((const __m128i*)(src + x * 4));
+            __m128i p1 = _mm_loadu_si128((const __m128i*)(src + x * 4 + 16));
+            __m128i b = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+            __m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask), _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+            __m128i r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask), _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+            __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, kr), _mm_mullo_epi16(g, kg)), _mm_mullo_epi16(b, kb));
+            __m128i y = _mm_srli_epi16(sum, 8);
+            _mm_storel_epi64((__m128i*)(dst + x), _mm_packus_epi16(y, y));
+        }
+#endif
+        for (; x < width; ++x) {
+            const uint8_t* p = src + x * 4;
+            dst[x] = (uint8_t)((p[2] * 77 + p[1] * 150 + p[0] * 29) >> 8);
+        }
+    }
+
+    // Edge mask row: 0xFF where |g(x+1) - g(x-1)| + |g(y+1) - g(y-1)| >= threshold (saturating).
+    // Border columns are left clear.
+    static void EdgeRow(const uint8_t* up, const uint8_t* mid, const uint8_t* down, uint8_t* dst, int width, uint8_t threshold) {
+        if (width < 3) {
+            memset(dst, 0, width);
+            return;
+        }
+        dst[0] = 0;
+        dst[width - 1] = 0;
+        int x = 1;
+#ifdef HINT_MAP_SSE2
+        const __m128i thr = _mm_set1_epi8((char)threshold);
+        for (; x + 16 <= width - 1; x += 16) {
+            __m128i l = _mm_loadu_si128((const __m128i*)(mid + x - 1));
+            __m128i r = _mm_loadu_si128((const __m128i*)(mid + x + 1));
+            __m128i u = _mm_loadu_si128((const __m128i*)(up + x));
+            __m128i d = _mm_loadu_si128((const __m128i*)(down + x));
+            __m128i gx = _mm_or_si128(_mm_subs_epu8(l, r), _mm_subs_epu8(r, l));
+            __m128i gy = _mm_or_si128(_mm_subs_epu8(u, d), _mm_subs_epu8(d, u));
+            __m128i mag = _mm_adds_epu8(gx, gy);
+            __m128i edge = _mm_cmpeq_epi8(_mm_max_epu8(mag, thr), mag);
+            _mm_storeu_si128((__m128i*)(dst + x), edge);
+        }
+#endif
+        for (; x < width - 1; ++x) {
+            int gx = mid[x - 1] > mid[x + 1] ? mid[x - 1] - mid[x + 1] : mid[x + 1] - mid[x - 1];
+            int gy = up[x] > down[x] ? up[x] - down[x] : down[x] - up[x];
+            int mag = gx + gy > 255 ? 255 : gx + gy;
+            dst[x] = mag >= threshold ? 0xFF : 0;
+        }
+    }
+
+    // dst[x] = OR of src[x - radius .. x + radius]; padded holds src with radius zero bytes on each side
+    static void DilateRowX(const uint8_t* padded, uint8_t* dst, int width, int radius) {
+        int x = 0;
+#ifdef HINT_MAP_SSE2
+        for (; x + 16 <= width; x += 16) {
+            __m128i acc = _mm_loadu_si128((const __m128i*)(padded + x));
+            for (int d = 1; d <= 2 * radius; ++d) {
+                acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i*)(padded + x + d)));
+            }
+            _mm_storeu_si128((__m128i*)(dst + x), acc);
+        }
+#endif
+        for (; x < width; ++x) {
+            uint8_t acc = 0;
+            for (int d = 0; d <= 2 * radius; ++d) acc |= padded[x + d];
+            dst[x] = acc;
+        }
+    }
+
+    // dst = OR of rows[0..count)
+    static void OrRows(const uint8_t* const* rows, int count, uint8_t* dst, int width) {
+        int x = 0;
+#ifdef HINT_MAP_SSE2
+        for (; x + 16 <= width; x += 16) {
+            __m128i acc = _mm_setzero_si128();
+            for (int i = 0; i < count; ++i) acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i*)(rows[i] + x)));
+            _mm_storeu_si128((__m128i*)(dst + x), acc);
+        }
+#endif
+        for (; x < width; ++x) {
+            uint8_t acc = 0;
+            for (int i = 0; i < count; ++i) acc |= rows[i][x];
+            dst[x] = acc;
+        }
+    }
+
+    static void CollectRuns(const uint8_t* row, int width, int y, std::vector<Run>& runs) {
+        int x = 0;
+        while (x < width) {
+#ifdef HINT_MAP_SSE2
+            // Skip empty 16-pixel blocks quickly
+            while (x + 16 <= width && _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(row + x))) == 0) x += 16;
+#endif
+            while (x < width && !row[x]) ++x;
+            if (x >= width) break;
+            int start = x;
+            while (x < width && row[x]) ++x;
+            runs.push_back({ y, start, x });
+        }
+    }
+
+    static int FindRoot(std::vector<int>& parent, int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    std::vector<Rect> DetectRegions(const ImageView& image, const RegionParams& params) {
+        std::vector<Rect> regions;
+        const int w = image.width, h = image.height;
+        if (!image.pixels || w < 3 || h < 3) return regions;
+
+        int threads = params.threads > 0 ? params.threads : (int)std::thread::hardware_concurrency();
+        threads = (std::max)(1, (std::min)(threads, 8));
+        const int rx = (std::max)(0, params.dilateX);
+        const int ry = (std::max)(0, params.dilateY);
+        const uint8_t threshold = (uint8_t)(std::max)(1, (std::min)(params.edgeThreshold, 255));
+
+        std::vector<uint8_t> gray((size_t)w * h);
+        std::vector<uint8_t> edges((size_t)w * h);
+
+        // Pass 1: luma
+        ForEachBand(h, threads, [&](int, int y0, int y1) {
+            for (int y = y0; y < y1; ++y) GrayRow(image.pixels + (size_t)y * image.stride, &gray[(size_t)y * w], w);
+        });
+
+        // Pass 2: edge mask, then horizontal dilation in place (row-local)
+        ForEachBand(h, threads, [&](int, int y0, int y1) {
+            std::vector<uint8_t> edgeRow(w), padded(w + 2 * rx, 0);
+            for (int y = y0; y < y1; ++y) {
+                uint8_t* out = &edges[(size_t)y * w];
+                if (y == 0 || y == h - 1) {
+                    memset(out, 0, w);
+                    continue;
+                }
+                EdgeRow(&gray[(size_t)(y - 1) * w], &gray[(size_t)y * w], &gray[(size_t)(y + 1) * w], padded.data() + rx, w, threshold);
+                DilateRowX(padded.data(), out, w, rx);
+            }
+        });
+
+        // Pass 3: vertical dilation and run extraction per band
+        std::vector<std::vector<Run>> bandRuns(threads);
+        ForEachBand(h, threads, [&](int band, int y0, int y1) {
+            std::vector<uint8_t> row(w);
+            std::vector<const uint8_t*> rows;
+            std::vector<Run>& runs = bandRuns[band];
+            for (int y = y0; y < y1; ++y) {
+                rows.clear();
+                for (int yy = (std::max)(0, y - ry); yy <= (std::min)(h - 1, y + ry); ++yy) rows.push_back(&edges[(size_t)yy * w]);
+                OrRows(rows.data(), (int)rows.size(), row.data(), w);
+                CollectRuns(row.data(), w, y, runs);
+            }
+        });
+
+        std::vector<Run> runs;
+        for (auto& b : bandRuns) runs.insert(runs.end(), b.begin(), b.end());
+        if (runs.empty()) return regions;
+
+        // Union runs that touch a run on the previous row (runs are sorted by y, then x)
+        std::vector<int> parent(runs.size());
+        for (size_t i = 0; i < runs.size(); ++i) parent[i] = (int)i;
+
+        size_t prevStart = 0, prevEnd = 0, cur = 0;
+        while (cur < runs.size()) {
+            const int y = runs[cur].y;
+            size_t rowEnd = cur;
+            while (rowEnd < runs.size() && runs[rowEnd].y == y) ++rowEnd;
+
+            if (prevEnd > prevStart && runs[prevStart].y == y - 1) {
+                size_t p = prevStart;
+                for (size_t c = cur; c < rowEnd; ++c) {
+                    while (p < prevEnd && runs[p].x1 <= runs[c].x0) ++p;
+                    for (size_t q = p; q < prevEnd && runs[q].x0 < runs[c].x1; ++q) {
+                        int a = FindRoot(parent, (int)c), b = FindRoot(parent, (int)q);
+                        if (a != b) parent[(std::max)(a, b)] = (std::min)(a, b);
+                    }
+                }
+            }
+            prevStart = cur;
+            prevEnd = rowEnd;
+            cur = rowEnd;
+        }
+
+        // Bounding box per component, indexed by root
+        std::vector<Rect> boxes(runs.size());
+        std::vector<char> used(runs.size(), 0);
+        for (size_t i = 0; i < runs.size(); ++i) {
+            int root = FindRoot(parent, (int)i);
+            const Run& r = runs[i];
+            if (!used[root]) {
+                boxes[root] = MakeRect(r.x0, r.y, r.x1, r.y + 1);
+                used[root] = 1;
+                continue;
+            }
+            Rect& b = boxes[root];
+            b.left = (std::min)(b.left, r.x0);
+            b.right = (std::max)(b.right, r.x1);
+            b.bottom = (std::max)(b.bottom, r.y + 1);
+        }
+
+        const long long maxArea = (long long)(params.maxAreaFraction * (double)w * h);
+        for (size_t i = 0; i < runs.size(); ++i) {
+            if (!used[i]) continue;
+            // Undo the growth dilation added around the content
+            Rect b = boxes[i];
+            b.left = (std::min)(b.left + rx, b.right - 1);
+            b.right = (std::max)(b.right - rx, b.left + 1);
+            b.top = (std::min)(b.top + ry, b.bottom - 1);
+            b.bottom = (std::max)(b.bottom - ry, b.top + 1);
+
+            if (b.Width() < params.minWidth || b.Height() < params.minHeight) continue;
+            if (b.Height() > params.maxHeight) continue;
+            if ((long long)b.Width() * b.Height() > maxArea) continue;
+            regions.push_back(b);
+        }
+
+        std::sort(regions.begin(), regions.end(), [](const Rect& a, const Rect& b) {
+            return a.top != b.top ? a.top < b.top : a.left < b.left;
+        });
+        return regions;
+    }
+
+}
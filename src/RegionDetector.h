@@ -0,0 +1,35 @@
+// RegionDetector.h
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Geometry.h"
+
+namespace hint_map {
+
+    // 32bpp BGRA pixels, top-down rows
+    struct ImageView {
+        const uint8_t* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        int stride = 0;     // bytes per row
+    };
+
+    struct RegionParams {
+        int edgeThreshold = 28;         // |dx| + |dy| of luma that counts as an edge
+        int dilateX = 5;                // merges glyphs into words and icons into buttons
+        int dilateY = 2;
+        int minWidth = 10;
+        int minHeight = 8;
+        int maxHeight = 160;            // taller blobs are panels, not controls
+        double maxAreaFraction = 0.2;   // of the whole image
+        int threads = 0;                // 0 = hardware concurrency, capped at 8
+    };
+
+    // Proposes clickable-looking rects (buttons, icons, text lines) from an image:
+    // luma -> gradient edge mask -> separable dilation -> run-based connected components.
+    // Each stage is SSE2-vectorised with a scalar fallback and split into row bands across
+    // threads. Rects are in image coordinates, sorted top-to-bottom, left-to-right.
+    std::vector<Rect> DetectRegions(const ImageView& image, const RegionParams& params = RegionParams());
+
+}
@@ -0,0 +1,249 @@
+// ScanIpc.cpp
+
+#include "ScanIpc.h"
+#include <atomic>
+#include <cstring>
+#include <new>
+
+namespace hint_map {
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "ring offsets must be lock-free to live in shared memory");
+
+    static const uint32_t CHANNEL_MAGIC = 0x4E4B5343;  // "NKSC"
+    static const uint32_t CHANNEL_VERSION = 4;
+
+    // Offsets in separate cache lines so producer and consumer don't false-share
+    struct ScanChannel::RingState {
+        alignas(64) std::atomic<uint64_t> head;     // bytes ever written; producer only
+        alignas(64) std::atomic<uint64_t> tail;     // bytes ever consumed; consumer only
+        uint32_t capacity;                          // multiple of 8
+        uint32_t offset;                            // of the data from the channel base
+    };
+
+    struct ScanChannel::Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t totalBytes;
+        RingState rings[2];
+    };
+
+    static uint64_t Align8(uint64_t n) { return (n + 7) & ~(uint64_t)7; }
+    static uint64_t Align64(uint64_t n) { return (n + 63) & ~(uint64_t)63; }
+
+    size_t ScanChannel::RequiredBytes(uint32_t requestCapacity, uint32_t responseCapacity) {
+        return (size_t)(Align64(sizeof(Header)) + Align64(requestCapacity & ~7u) + Align64(responseCapacity & ~7u));
+    }
+
+    ScanChannel ScanChannel::Create(void* memory, size_t bytes, uint32_t requestCapacity, uint32_t responseCapacity) {
+        ScanChannel channel;
+        requestCapacity &= ~7u;
+        responseCapacity &= ~7u;
+        if (!memory || requestCapacity < 64 || responseCapacity < 64 ||
+            bytes < RequiredBytes(requestCapacity, responseCapacity)) return channel;
+
+        Header* header = new (memory) Header;
+        header->magic = 0;
+        header->totalBytes = bytes;
+        header->version = CHANNEL_VERSION;
+
+        const uint32_t capacities[2] = { requestCapacity, responseCapacity };
+        uint64_t offset = Align64(sizeof(Header));
+        for (int r = 0; r < 2; ++r) {
+            RingState& state = header->rings[r];
+            state.head.store(0, std::memory_order_relaxed);
+            state.tail.store(0, std::memory_order_relaxed);
+            state.capacity = capacities[r];
+            state.offset = (uint32_t)offset;
+            offset += Align64(capacities[r]);
+        }
+
+        // Magic last: a worker attaching early sees an invalid channel, not a half-built one
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = CHANNEL_MAGIC;
+        channel.base = static_cast<uint8_t*>(memory);
+        return channel;
+    }
+
+    ScanChannel ScanChannel::Attach(void* memory, size_t bytes) {
+        ScanChannel channel;
+        if (!memory || bytes < sizeof(Header)) return channel;
+
+        const Header* header = static_cast<const Header*>(memory);
+        if (header->magic != CHANNEL_MAGIC || header->version != CHANNEL_VERSION) return channel;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        for (int r = 0; r < 2; ++r) {
+            const RingState& state = header->rings[r];
+            // Same bounds as Create; Write and Peek divide by the capacity
+            if (state.capacity < 64 || (state.capacity & 7u) || (uint64_t)state.offset + state.capacity > bytes) return channel;
+        }
+        channel.base = static_cast<uint8_t*>(memory);
+        return channel;
+    }
+
+    ScanChannel::RingState* ScanChannel::State(ScanRing ring) const {
+        return &reinterpret_cast<Header*>(base)->rings[ring];
+    }
+
+    uint8_t* ScanChannel::Data(ScanRing ring) const {
+        return base + State(ring)->offset;
+    }
+
+    uint32_t ScanChannel::Capacity(ScanRing ring) const {
+        return base ? State(ring)->capacity : 0;
+    }
+
+    bool ScanChannel::Write(ScanRing ring, uint32_t type, uint32_t sequence, const void* payload, uint32_t size) {
+        if (!base) return false;
+        RingState* state = State(ring);
+        uint8_t* data = Data(ring);
+        const uint64_t capacity = state->capacity;
+
+        const uint64_t recordBytes = Align8(sizeof(ScanRecordHeader) + (uint64_t)size);
+        if (recordBytes > capacity) return false;
+
+        uint64_t head = state->head.load(std::memory_order_relaxed);
+        const uint64_t tail = state->tail.load(std::memory_order_acquire);
+
+        // Pad to the end rather than split the record
+        const uint64_t position = head % capacity;
+        const uint64_t contiguous = capacity - position;
+        const uint64_t pad = contiguous < recordBytes ? contiguous : 0;
+        if (head + pad + recordBytes - tail > capacity) return false;
+
+        if (pad) {
+            // A tail shorter than a header is skipped by readers without one
+            if (pad >= sizeof(ScanRecordHeader)) {
+                ScanRecordHeader padding = { (uint32_t)(pad - sizeof(ScanRecordHeader)), SCAN_RECORD_PAD, 0, 0 };
+                memcpy(data + position, &padding, sizeof(padding));
+            }
+            head += pad;
+        }
+
+        ScanRecordHeader header = { size, type, sequence, 0 };
+        uint8_t* dst = data + head % capacity;
+        memcpy(dst, &header, sizeof(header));
+        if (size) memcpy(dst + sizeof(header), payload, size);
+
+        state->head.store(head + recordBytes, std::memory_order_release);
+        return true;
+    }
+
+    bool ScanChannel::Peek(ScanRing ring, ScanRecordView& record) {
+        if (!base) return false;
+        RingState* state = State(ring);
+        const uint8_t* data = Data(ring);
+        const uint64_t capacity = state->capacity;
+
+        uint64_t tail = state->tail.load(std::memory_order_relaxed);
+        const uint64_t head = state->head.load(std::memory_order_acquire);
+
+        while (tail != head) {
+            if (head - tail > capacity) return false;
+
+            const uint64_t position = tail % capacity;
+            const uint64_t contiguous = capacity - position;
+            if (contiguous < sizeof(ScanRecordHeader)) {
+                tail += contiguous;
+                state->tail.store(tail, std::memory_order_release);
+                continue;
+            }
+
+            ScanRecordHeader header;
+            memcpy(&header, data + position, sizeof(header));
+            if (header.type == SCAN_RECORD_PAD) {
+                tail += contiguous;
+                state->tail.store(tail, std::memory_order_release);
+                continue;
+            }
+
+            const uint64_t recordBytes = Align8(sizeof(ScanRecordHeader) + (uint64_t)header.size);
+            if (recordBytes > contiguous || recordBytes > head - tail) return false;
+
+            record.type = header.type;
+            record.sequence = header.sequence;
+            record.payload = data + position + sizeof(header);
+            record.size = header.size;
+            record.next = tail + recordBytes;
+            return true;
+        }
+        return false;
+    }
+
+    void ScanChannel::Consume(ScanRing ring, const ScanRecordView& record) {
+        if (!base) return;
+        State(ring)->tail.store(record.next, std::memory_order_release);
+    }
+
+    void ScanChannel::Drain(ScanRing ring) {
+        if (!base) return;
+        RingState* state = State(ring);
+        state->tail.store(state->head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    void ScanResultWriter::Add(const Rect& rect, int controlType,
+        const int32_t* runtimeId, uint32_t runtimeIdCount,
+        const uint16_t* name, uint32_t nameLength,
+        const uint16_t* automationId, uint32_t automationIdLength) {
+        ScanTargetRecord r;
+        r.left = rect.left;
+        r.top = rect.top;
+        r.right = rect.right;
+        r.bottom = rect.bottom;
+        r.controlType = controlType;
+        r.runtimeIdStart = (uint32_t)runtimeIds.size();
+        r.runtimeIdCount = runtimeIdCount;
+        runtimeIds.insert(runtimeIds.end(), runtimeId, runtimeId + runtimeIdCount);
+        r.nameStart = (uint32_t)text.size();
+        r.nameLength = nameLength;
+        text.insert(text.end(), name, name + nameLength);
+        r.automationIdStart = (uint32_t)text.size();
+        r.automationIdLength = automationIdLength;
+        text.insert(text.end(), automationId, automationId + automationIdLength);
+        records.push_back(r);
+    }
+
+    std::vector<uint8_t> ScanResultWriter::Finish() const {
+        ScanResultHeader header = { (uint32_t)records.size(), resultStatus, (uint32_t)runtimeIds.size(), (uint32_t)text.size(),
+            bounds.left, bounds.top, bounds.right, bounds.bottom, stageUs[0], stageUs[1], stageUs[2], 0 };
+        const size_t recordBytes = records.size() * sizeof(ScanTargetRecord);
+        const size_t idBytes = runtimeIds.size() * sizeof(int32_t);
+        const size_t textBytes = text.size() * sizeof(uint16_t);
+
+        std::vector<uint8_t> payload(sizeof(header) + recordBytes + idBytes + textBytes);
+        uint8_t* p = payload.data();
+        memcpy(p, &header, sizeof(header));
+        p += sizeof(header);
+        if (recordBytes) memcpy(p, records.data(), recordBytes);
+        p += recordBytes;
+        if (idBytes) memcpy(p, runtimeIds.data(), idBytes);
+        p += idBytes;
+        if (textBytes) memcpy(p, text.data(), textBytes);
+        return payload;
+    }
+
+    bool ScanResultView::Parse(const uint8_t* payload, uint32_t size) {
+        header = nullptr;
+        if (!payload || size < sizeof(ScanResultHeader)) return false;
+
+        const ScanResultHeader* h = reinterpret_cast<const ScanResultHeader*>(payload);
+        const uint64_t recordBytes = (uint64_t)h->count * sizeof(ScanTargetRecord);
+        const uint64_t idBytes = (uint64_t)h->runtimeIdInts * sizeof(int32_t);
+        const uint64_t textBytes = (uint64_t)h->textUnits * sizeof(uint16_t);
+        if (sizeof(ScanResultHeader) + recordBytes + idBytes + textBytes != size) return false;
+
+        const ScanTargetRecord* r = reinterpret_cast<const ScanTargetRecord*>(payload + sizeof(ScanResultHeader));
+        for (uint32_t i = 0; i < h->count; ++i) {
+            if ((uint64_t)r[i].runtimeIdStart + r[i].runtimeIdCount > h->runtimeIdInts) return false;
+            if ((uint64_t)r[i].nameStart + r[i].nameLength > h->textUnits) return false;
+            if ((uint64_t)r[i].automationIdStart + r[i].automationIdLength > h->textUnits) return false;
+        }
+
+        header = h;
+        records = r;
+        runtimeIds = reinterpret_cast<const int32_t*>(payload + sizeof(ScanResultHeader) + recordBytes);
+        text = reinterpret_cast<const uint16_t*>(payload + sizeof(ScanResultHeader) + recordBytes + idBytes);
+        return true;
+    }
+
+}
@@ -0,0 +1,170 @@
+// ScanIpc.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Geometry.h"
+
+namespace hint_map {
+
+    // Channel between the app and its scan worker process, laid out in one block of shared
+    // memory: a header, then a request ring (app -> worker) and a response ring (worker -> app).
+    // Each ring is single-producer/single-consumer over byte offsets that only grow, so the
+    // two processes never lock. Records never wrap: a writer that reaches the end pads to it,
+    // so a reader always sees one contiguous record and can decode it in place.
+    // Nothing in the block is a pointer; it is valid at any address in either process.
+
+    enum ScanRing {
+        SCAN_REQUESTS = 0,
+        SCAN_RESPONSES = 1
+    };
+
+    enum ScanRecordType : uint32_t {
+        SCAN_RECORD_PAD = 0,
+        SCAN_RECORD_REQUEST = 1,            // ScanRequestPayload
+        SCAN_RECORD_RESULT = 2,
+        SCAN_RECORD_CONTAINER_REQUEST = 3,  // ScanContainerRequestPayload; also answered with a result
+        SCAN_RECORD_INVOKE_REQUEST = 4      // ScanInvokeRequestPayload; answered with an empty result
+    };
+
+    struct ScanRecordHeader {
+        uint32_t size;          // payload bytes
+        uint32_t type;          // ScanRecordType
+        uint32_t sequence;      // matches a result to its request
+        uint32_t reserved;
+    };
+
+    // Zero-copy view of a record still in the ring; valid until Consume
+    struct ScanRecordView {
+        uint32_t type = 0;
+        uint32_t sequence = 0;
+        const uint8_t* payload = nullptr;
+        uint32_t size = 0;
+        uint64_t next = 0;      // read offset after this record
+    };
+
+    class ScanChannel {
+    public:
+        static size_t RequiredBytes(uint32_t requestCapacity, uint32_t responseCapacity);
+
+        // Lays out an empty channel in memory (app side, before starting a worker)
+        static ScanChannel Create(void* memory, size_t bytes, uint32_t requestCapacity, uint32_t responseCapacity);
+        // Attaches to a channel made by Create (worker side); !Valid() if the header is wrong
+        static ScanChannel Attach(void* memory, size_t bytes);
+
+        bool Valid() const { return base != nullptr; }
+
+        // False if the payload can't fit right now (or ever, if it exceeds the ring)
+        bool Write(ScanRing ring, uint32_t type, uint32_t sequence, const void* payload, uint32_t size);
+        // Next record, skipping padding. False if the ring is empty or corrupt.
+        bool Peek(ScanRing ring, ScanRecordView& record);
+        void Consume(ScanRing ring, const ScanRecordView& record);
+        // Drops everything unread
+        void Drain(ScanRing ring);
+
+        uint32_t Capacity(ScanRing ring) const;
+
+    private:
+        struct RingState;
+        struct Header;
+
+        RingState* State(ScanRing ring) const;
+        uint8_t* Data(ScanRing ring) const;
+
+        uint8_t* base = nullptr;
+    };
+
+    // Result payload: header, fixed-size target records, then pools of runtime id ints and
+    // UTF-16 code units. Records refer into the pools by index, never by pointer.
+    struct ScanResultHeader {
+        uint32_t count;
+        uint32_t status;        // 0 ok, otherwise the scan failed
+        uint32_t runtimeIdInts;
+        uint32_t textUnits;
+        int32_t boundsLeft, boundsTop, boundsRight, boundsBottom;  // container requests: its viewport
+        uint32_t setupUs, findUs, filterUs;     // how long the worker's scan stages took, for the trace
+        uint32_t reserved;
+    };
+
+    struct ScanTargetRecord {
+        int32_t left, top, right, bottom;
+        int32_t controlType;
+        uint32_t runtimeIdStart, runtimeIdCount;
+        uint32_t nameStart, nameLength;
+        uint32_t automationIdStart, automationIdLength;
+    };
+
+    struct ScanRequestPayload {
+        uint64_t window;        // HWND to scan
+    };
+
+    // Rescan of just the scrollable container under a screen point
+    struct ScanContainerRequestPayload {
+        int32_t x, y;
+    };
+
+    // Longer runtime ids aren't sent; the app clicks the target instead
+    static const uint32_t SCAN_MAX_RUNTIME_ID = 16;
+
+    // Invoke of a target from an earlier result: the element with this runtime id in the
+    // window, looked for at the target's centre first
+    struct ScanInvokeRequestPayload {
+        uint64_t window;
+        int32_t x, y;
+        uint32_t runtimeIdCount;
+        int32_t runtimeId[SCAN_MAX_RUNTIME_ID];
+    };
+
+    class ScanResultWriter {
+    public:
+        void Add(const Rect& rect, int controlType,
+            const int32_t* runtimeId, uint32_t runtimeIdCount,
+            const uint16_t* name, uint32_t nameLength,
+            const uint16_t* automationId, uint32_t automationIdLength);
+        void SetStatus(uint32_t value) { resultStatus = value; }
+        void SetBounds(const Rect& value) { bounds = value; }
+        void SetStageTimes(uint32_t setup, uint32_t find, uint32_t filter) {
+            stageUs[0] = setup;
+            stageUs[1] = find;
+            stageUs[2] = filter;
+        }
+        // Flat payload ready for ScanChannel::Write
+        std::vector<uint8_t> Finish() const;
+
+    private:
+        uint32_t resultStatus = 0;
+        Rect bounds;
+        uint32_t stageUs[3] = {};
+        std::vector<ScanTargetRecord> records;
+        std::vector<int32_t> runtimeIds;
+        std::vector<uint16_t> text;
+    };
+
+    // Reads a result payload in place. Parse checks every index against the payload size,
+    // since the bytes come from another process that may have died mid-write.
+    class ScanResultView {
+    public:
+        bool Parse(const uint8_t* payload, uint32_t size);
+
+        uint32_t Count() const { return header ? header->count : 0; }
+        uint32_t Status() const { return header ? header->status : 0; }
+        uint32_t SetupUs() const { return header ? header->setupUs : 0; }
+        uint32_t FindUs() const { return header ? header->findUs : 0; }
+        uint32_t FilterUs() const { return header ? header->filterUs : 0; }
+        Rect Bounds() const {
+            return header ? MakeRect(header->boundsLeft, header->boundsTop, header->boundsRight, header->boundsBottom) : Rect();
+        }
+        const ScanTargetRecord& Target(uint32_t i) const { return records[i]; }
+        const int32_t* RuntimeId(uint32_t i) const { return runtimeIds + records[i].runtimeIdStart; }
+        const uint16_t* Name(uint32_t i) const { return text + records[i].nameStart; }
+        const uint16_t* AutomationId(uint32_t i) const { return text + records[i].automationIdStart; }
+
+    private:
+        const ScanResultHeader* header = nullptr;
+        const ScanTargetRecord* records = nullptr;
+        const int32_t* runtimeIds = nullptr;
+        const uint16_t* text = nullptr;
+    };
+
+}
@@ -0,0 +1,309 @@
+// ScanProfile.cpp
+
+#include "ScanProfile.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cwctype>
+
+namespace hint_map {
+
+    // UIA control type ids are 50000 + the position in this list
+    static const char* const CONTROL_TYPE_NAMES[TargetBuckets::TYPE_COUNT] = {
+        "Button", "Calendar", "CheckBox", "ComboBox", "Edit", "Hyperlink", "Image", "ListItem",
+        "List", "Menu", "MenuBar", "MenuItem", "ProgressBar", "RadioButton", "ScrollBar", "Slider",
+        "Spinner", "StatusBar", "Tab", "TabItem", "Text", "ToolBar", "ToolTip", "Tree",
+        "TreeItem", "Custom", "Group", "Thumb", "DataGrid", "DataItem", "Document", "SplitButton",
+        "Window", "Pane", "Header", "HeaderItem", "Table", "TitleBar", "Separator", "SemanticZoom",
+        "AppBar"
+    };
+
+    static bool EqualsIgnoreCase(const std::string& a, const char* b) {
+        size_t i = 0;
+        for (; i < a.size() && b[i]; ++i) {
+            if (std::tolower((unsigned char)a[i]) != std::tolower((unsigned char)b[i])) return false;
+        }
+        return i == a.size() && !b[i];
+    }
+
+    int ControlTypeFromName(const std::string& name) {
+        for (int i = 0; i < TargetBuckets::TYPE_COUNT; ++i) {
+            if (EqualsIgnoreCase(name, CONTROL_TYPE_NAMES[i])) return TargetBuckets::FIRST_TYPE + i;
+        }
+        return 0;
+    }
+
+    static std::wstring Lower(const std::wstring& s) {
+        std::wstring out(s);
+        for (wchar_t& c : out) c = (wchar_t)std::towlower(c);
+        return out;
+    }
+
+    static std::string Trim(const std::string& s) {
+        const size_t start = s.find_first_not_of(" \t\r");
+        if (start == std::string::npos) return std::string();
+        return s.substr(start, s.find_last_not_of(" \t\r") - start + 1);
+    }
+
+    static std::vector<std::string> SplitList(const std::string& value) {
+        std::vector<std::string> items;
+        std::string item;
+        for (char c : value) {
+            if (c == ' ' || c == '\t' || c == ',') {
+                if (!item.empty()) items.push_back(item);
+                item.clear();
+            }
+            else {
+                item += c;
+            }
+        }
+        if (!item.empty()) items.push_back(item);
+        return items;
+    }
+
+    // The filter the scanner had just before profiles: ListItem is skipped, but items keeps
+    // the selectable ones
+    static CompiledScanProfile BaselineProfile() {
+        CompiledScanProfile p;
+        p.name = "default";
+        const int skipped[] = { 50033 /* Pane */, 50026 /* Group */, 50020 /* Text */, 50025 /* Custom */,
+                                50030 /* Document */, 50007 /* ListItem */ };
+        for (int type : skipped) p.keepTypes &= ~TargetBuckets::Bit(type);
+        p.itemTypes = TargetBuckets::Bit(50007 /* ListItem */) | TargetBuckets::Bit(50029 /* DataItem */) |
+                      TargetBuckets::Bit(50024 /* TreeItem */);
+        return p;
+    }
+
+    ScanProfiles::ScanProfiles() {
+        Clear();
+    }
+
+    void ScanProfiles::Clear() {
+        profiles.assign(1, BaselineProfile());
+        byProcess.clear();
+    }
+
+    // One key = value line of a section; false with a reason if it isn't understood
+    static bool ApplySetting(CompiledScanProfile& p, const std::string& key, const std::string& value,
+        std::vector<std::wstring>& processes, std::string& error) {
+        const std::vector<std::string> list = SplitList(value);
+
+        if (key == "processes") {
+            for (const std::string& name : list) processes.push_back(Lower(std::wstring(name.begin(), name.end())));
+            return true;
+        }
+        if (key == "include" || key == "skip" || key == "only" || key == "items") {
+            uint64_t bits = 0;
+            for (const std::string& name : list) {
+                const int type = ControlTypeFromName(name);
+                if (!type) {
+                    error = "unknown control type '" + name + "'";
+                    return false;
+                }
+                bits |= TargetBuckets::Bit(type);
+            }
+            if (key == "include") p.keepTypes |= bits;
+            else if (key == "skip") p.keepTypes &= ~bits;
+            else if (key == "only") p.keepTypes = bits;
+            else p.itemTypes = bits;
+            return true;
+        }
+        if (key == "min_size" || key == "max_size") {
+            char* end = nullptr;
+            const long size = std::strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end || size < 0 || size > 100000) {
+                error = "bad size '" + value + "'";
+                return false;
+            }
+            (key == "min_size" ? p.minSize : p.maxSize) = (int)size;
+            return true;
+        }
+        if (key == "scope") {
+            if (value == "children") p.scope = ScanScope::CHILDREN;
+            else if (value == "descendants") p.scope = ScanScope::DESCENDANTS;
+            else if (value == "subtree") p.scope = ScanScope::SUBTREE;
+            else {
+                error = "unknown scope '" + value + "'";
+                return false;
+            }
+            return true;
+        }
+        if (key == "match" || key == "cache") {
+            uint32_t flags = 0;
+            for (const std::string& name : list) {
+                if (key == "match" && name == "invoke") flags |= MATCH_INVOKE;
+                else if (key == "match" && name == "selection_item") flags |= MATCH_SELECTION_ITEM;
+                else if (key == "match" && name == "keyboard_focusable") flags |= MATCH_KEYBOARD_FOCUSABLE;
+                else if (key == "cache" && name == "name") flags |= CACHE_NAME;
+                else if (key == "cache" && name == "automation_id") flags |= CACHE_AUTOMATION_ID;
+                else {
+                    error = "unknown " + key + " '" + name + "'";
+                    return false;
+                }
+            }
+            // Nothing to match would match everything
+            if (key == "match" && !flags) {
+                error = "match needs at least one test";
+                return false;
+            }
+            (key == "match" ? p.match : p.cache) = flags;
+            return true;
+        }
+        if (key == "strategy") {
+            if (value == "worker") p.strategy = ScanStrategy::WORKER;
+            else if (value == "in_process") p.strategy = ScanStrategy::IN_PROCESS;
+            else if (value == "grid") p.strategy = ScanStrategy::GRID;
+            else {
+                error = "unknown strategy '" + value + "'";
+                return false;
+            }
+            return true;
+        }
+        error = "unknown key '" + key + "'";
+        return false;
+    }
+
+    bool ScanProfiles::Load(const std::string& text, std::vector<std::string>* errors) {
+        bool clean = true;
+        auto fail = [&](int line, const std::string& what) {
+            clean = false;
+            if (errors) errors->push_back("line " + std::to_string(line) + ": " + what);
+        };
+
+        int current = -1;       // profile the lines go to; -1 before the first section
+        int lineNumber = 0;
+        int sectionLine = 0;    // header line of current
+        std::vector<std::wstring> processes;
+        bool processesGiven = false;
+        auto finishSection = [&]() {
+            if (current < 0) return;
+            CompiledScanProfile& p = profiles[current];
+            if (p.minSize > p.maxSize) {
+                fail(sectionLine, "[" + p.name + "] min_size is above max_size; swapped them");
+                std::swap(p.minSize, p.maxSize);
+            }
+            if (processesGiven) {
+                // The section's list replaces whatever it had
+                byProcess.erase(std::remove_if(byProcess.begin(), byProcess.end(),
+                    [&](const std::pair<std::wstring, int>& e) { return e.second == current; }), byProcess.end());
+                for (const std::wstring& exe : processes) byProcess.emplace_back(exe, current);
+            }
+            processes.clear();
+            processesGiven = false;
+        };
+
+        size_t pos = 0;
+        while (pos <= text.size()) {
+            size_t end = text.find('\n', pos);
+            if (end == std::string::npos) end = text.size();
+            const std::string line = Trim(text.substr(pos, end - pos));
+            pos = end + 1;
+            ++lineNumber;
+            if (line.empty() || line[0] == ';' || line[0] == '#') continue;
+
+            if (line[0] == '[') {
+                const std::string name = line.back() == ']' ? Trim(line.substr(1, line.size() - 2)) : std::string();
+                if (name.empty()) {
+                    fail(lineNumber, "bad section header");
+                    finishSection();
+                    current = -1;
+                    continue;
+                }
+                finishSection();
+                sectionLine = lineNumber;
+                auto it = std::find_if(profiles.begin(), profiles.end(),
+                    [&](const CompiledScanProfile& p) { return p.name == name; });
+                if (it != profiles.end()) {
+                    // Named again: the settings change it further
+                    current = (int)(it - profiles.begin());
+                }
+                else {
+                    CompiledScanProfile fresh = profiles.front();
+                    fresh.name = name;
+                    current = (int)profiles.size();
+                    profiles.push_back(fresh);
+                }
+                continue;
+            }
+
+            const size_t eq = line.find('=');
+            if (eq == std::string::npos) {
+                fail(lineNumber, "expected key = value");
+                continue;
+            }
+            if (current < 0) {
+                fail(lineNumber, "setting outside a section");
+                continue;
+            }
+            std::string key = Trim(line.substr(0, eq));
+            for (char& c : key) c = (char)std::tolower((unsigned char)c);
+            if (key == "processes") processesGiven = true;
+            std::string error;
+            if (!ApplySetting(profiles[current], key, Trim(line.substr(eq + 1)), processes, error)) fail(lineNumber, error);
+        }
+        finishSection();
+
+        // Sorted by name, and for a name listed twice only the later entry survives
+        std::stable_sort(byProcess.begin(), byProcess.end(),
+            [](const std::pair<std::wstring, int>& a, const std::pair<std::wstring, int>& b) { return a.first < b.first; });
+        std::vector<std::pair<std::wstring, int>> unique;
+        unique.reserve(byProcess.size());
+        for (auto& entry : byProcess) {
+            if (!unique.empty() && unique.back().first == entry.first) unique.back() = std::move(entry);
+            else unique.push_back(std::move(entry));
+        }
+        byProcess.swap(unique);
+        return clean;
+    }
+
+    const CompiledScanProfile& ScanProfiles::ForProcess(const std::wstring& exeName) const {
+        const std::wstring key = Lower(exeName);
+        auto it = std::lower_bound(byProcess.begin(), byProcess.end(), key,
+            [](const std::pair<std::wstring, int>& e, const std::wstring& k) { return e.first < k; });
+        if (it == byProcess.end() || it->first != key) return profiles.front();
+        return profiles[it->second];
+    }
+
+    const char* BuiltInScanProfiles() {
+        return
+            "[default]\n"
+            "skip = Pane Group Text Custom Document ListItem\n"
+            "items = ListItem DataItem TreeItem\n"
+            "min_size = 6\n"
+            "max_size = 999\n"
+            "scope = descendants\n"
+            "match = invoke selection_item keyboard_focusable\n"
+            "cache = name automation_id\n"
+            "strategy = worker\n"
+            "\n"
+            // Pages make every tabindex'd div focusable and most images links' children;
+            // DOM ids aren't worth caching for search
+            "[browser]\n"
+            "processes = chrome.exe msedge.exe firefox.exe brave.exe opera.exe vivaldi.exe\n"
+            "skip = Image Separator\n"
+            "min_size = 8\n"
+            "cache = name\n"
+            "\n"
+            // The editor's tokens and the huge tool window trees are focusable but seldom
+            // clicked; buttons, tabs and tree items all support invoke or selection
+            "[visual-studio]\n"
+            "processes = devenv.exe\n"
+            "skip = Image Separator Thumb\n"
+            "match = invoke selection_item\n"
+            "cache = name\n"
+            "\n"
+            // Electron: same tree as a browser, plus the editor's many focusable parts
+            "[vscode]\n"
+            "processes = code.exe cursor.exe\n"
+            "skip = Image Separator\n"
+            "min_size = 8\n"
+            "match = invoke selection_item\n"
+            "cache = name\n"
+            "\n"
+            // Swing UIs expose only the frame to UIA unless the Java Access Bridge is on
+            "[jetbrains]\n"
+            "processes = idea64.exe pycharm64.exe clion64.exe rider64.exe webstorm64.exe goland64.exe\n"
+            "strategy = grid\n";
+    }
+
+}
@@ -0,0 +1,98 @@
+// ScanProfile.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "TargetBuckets.h"
+
+namespace hint_map {
+
+    enum class ScanStrategy {
+        WORKER,         // scan in the worker process, in-process if it's unavailable
+        IN_PROCESS,     // always scan in this process
+        GRID            // nothing useful in the UIA tree: go straight to grid mode
+    };
+
+    enum class ScanScope { CHILDREN, DESCENDANTS, SUBTREE };
+
+    // The query's "clickable" tests; an element has to pass one of them (and be on screen)
+    enum ScanMatch : uint32_t {
+        MATCH_INVOKE = 1,
+        MATCH_SELECTION_ITEM = 2,
+        MATCH_KEYBOARD_FOCUSABLE = 4
+    };
+
+    // Properties cached on top of the rect, control type and runtime id every scan needs
+    enum ScanCache : uint32_t {
+        CACHE_NAME = 1,                 // search mode
+        CACHE_AUTOMATION_ID = 2
+    };
+
+    // A profile compiled for the scan's filter loop: control types are one bit each, in
+    // TargetBuckets' slot order, so every test there is a shift and a mask
+    struct CompiledScanProfile {
+        std::string name;
+        uint64_t keepTypes = TargetBuckets::ALL;
+        uint64_t itemTypes = 0;         // types that are kept anyway, at any size, as selectable container items
+        int minSize = 6;                // width and height, in pixels
+        int maxSize = 999;
+        ScanScope scope = ScanScope::DESCENDANTS;
+        uint32_t match = MATCH_INVOKE | MATCH_SELECTION_ITEM | MATCH_KEYBOARD_FOCUSABLE;
+        uint32_t cache = CACHE_NAME | CACHE_AUTOMATION_ID;
+        ScanStrategy strategy = ScanStrategy::WORKER;
+
+        bool Keeps(int controlType) const { return (keepTypes & TargetBuckets::Bit(controlType)) != 0; }
+        bool MayBeItem(int controlType) const { return (itemTypes & TargetBuckets::Bit(controlType)) != 0; }
+        bool FitsSize(int width, int height, bool item) const {
+            if (width < minSize || height < minSize) return false;
+            return item || (width <= maxSize && height <= maxSize);
+        }
+    };
+
+    // Per-application scan profiles from INI text:
+    //
+    //   [browser]
+    //   processes = chrome.exe msedge.exe
+    //   skip = Image
+    //   min_size = 8
+    //
+    // A new section starts from [default] as it stands at that point, and a section named
+    // again (a built-in one, say) starts from itself; either way it changes what it names:
+    // include/skip add or remove control types (UIA names without "ControlTypeId"), only
+    // sets them outright, items names the types that count as container items, min_size and
+    // max_size bound the rect, scope is children/descendants/subtree, match lists invoke,
+    // selection_item and keyboard_focusable, cache lists name and automation_id, and
+    // strategy is worker, in_process or grid. Lists take spaces or commas; processes
+    // replaces the section's list, which is otherwise kept.
+    class ScanProfiles {
+    public:
+        ScanProfiles();
+
+        // Adds the sections in text; one already defined is amended, and a process named
+        // again moves to the later section. Lines that can't be understood are skipped and
+        // described in errors ("line 4: unknown control type 'Buton'"). True if there were none.
+        bool Load(const std::string& text, std::vector<std::string>* errors = nullptr);
+        // Back to just the built-in default
+        void Clear();
+
+        // The profile for an executable name ("chrome.exe", any case), or the default
+        const CompiledScanProfile& ForProcess(const std::wstring& exeName) const;
+        const CompiledScanProfile& Default() const { return profiles.front(); }
+        size_t Count() const { return profiles.size(); }
+
+    private:
+        std::vector<CompiledScanProfile> profiles;              // [0] is [default]
+        std::vector<std::pair<std::wstring, int>> byProcess;    // lower-case exe name -> profile, sorted
+    };
+
+    // Defaults tuned for the apps with the largest trees (IDEs, browsers); [default] is the
+    // scanner's filter as it stood before profiles, which since item hinting keeps
+    // selectable ListItems (through items) even though skip drops the rest
+    const char* BuiltInScanProfiles();
+
+    // "Button" -> UIA_ButtonControlTypeId; 0 if unknown
+    int ControlTypeFromName(const std::string& name);
+
+}
@@ -0,0 +1,517 @@
+// ScanWorker.cpp
+
+#include "ScanWorker.h"
+#include <UIAutomationClient.h>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include "ScanIpc.h"
+#include "MonitorCache.h"
+#include "LatencyStats.h"
+#include "TraceRecorder.h"
+
+namespace hint_map {
+
+    static_assert(sizeof(wchar_t) == sizeof(uint16_t), "result text is UTF-16");
+
+    static const uint32_t REQUEST_RING_BYTES = 4 * 1024;
+    static const uint32_t RESPONSE_RING_BYTES = 4 * 1024 * 1024;   // a few thousand named targets
+
+    // A healthy scan of a big window takes a few hundred ms; past this the provider is stuck
+    // and grid mode is more use than waiting
+    static const DWORD SCAN_DEADLINE_MS = 750;
+    static const DWORD KILL_WAIT_MS = 100;
+
+    enum ScanStatus : uint32_t {
+        SCAN_STATUS_OK = 0,
+        SCAN_STATUS_TOO_LARGE = 1,  // didn't fit the response ring; scan in-process instead
+        SCAN_STATUS_NO_CONTAINER = 2,   // container request: nothing scrollable under the point
+        SCAN_STATUS_NOT_INVOKED = 3     // invoke request: the element is gone or has nothing to invoke
+    };
+
+    // Kernel objects the app and worker share by name, keyed by the app's pid
+    struct SharedObjects {
+        HANDLE mapping = nullptr;
+        void* view = nullptr;
+        size_t bytes = 0;
+        HANDLE requestEvent = nullptr;
+        HANDLE responseEvent = nullptr;
+    };
+
+    static std::wstring ObjectName(DWORD appPid, const wchar_t* suffix) {
+        wchar_t buf[64];
+        swprintf_s(buf, L"Local\\NavKeyScan-%lu-%s", appPid, suffix);
+        return buf;
+    }
+
+    static void CloseShared(SharedObjects& shared) {
+        if (shared.view) UnmapViewOfFile(shared.view);
+        if (shared.mapping) CloseHandle(shared.mapping);
+        if (shared.requestEvent) CloseHandle(shared.requestEvent);
+        if (shared.responseEvent) CloseHandle(shared.responseEvent);
+        shared = SharedObjects();
+    }
+
+    // ---- App side ----
+
+    static SharedObjects s_shared;
+    static ScanChannel s_channel;
+    static HANDLE s_workerProcess = nullptr;
+    static uint32_t s_sequence = 0;
+
+    // For InvokeWorkerTarget without a worker, on the UI thread
+    static Microsoft::WRL::ComPtr<IUIAutomation> s_automation;
+    static bool s_comInitialized = false;
+
+    static void SpawnWorker() {
+        wchar_t exe[MAX_PATH];
+        const DWORD length = GetModuleFileNameW(nullptr, exe, MAX_PATH);
+        if (length == 0 || length == MAX_PATH) return;
+
+        wchar_t cmd[MAX_PATH + 48];
+        swprintf_s(cmd, L"\"%s\" --scan-worker %lu", exe, GetCurrentProcessId());
+
+        STARTUPINFOW si = {};
+        si.cb = sizeof(si);
+        PROCESS_INFORMATION pi = {};
+        if (!CreateProcessW(exe, cmd, nullptr, nullptr, FALSE, 0, nullptr, nullptr, &si, &pi)) {
+            OutputDebugString(L"[hint_map] Failed to start the scan worker.\n");
+            return;
+        }
+        CloseHandle(pi.hThread);
+        s_workerProcess = pi.hProcess;
+    }
+
+    static void KillWorker() {
+        if (!s_workerProcess) return;
+        TerminateProcess(s_workerProcess, 1);
+        WaitForSingleObject(s_workerProcess, KILL_WAIT_MS);
+        CloseHandle(s_workerProcess);
+        s_workerProcess = nullptr;
+    }
+
+    // A fresh channel as well as a fresh worker: the old one may have died mid-write
+    static void RestartWorker() {
+        KillWorker();
+        s_channel = ScanChannel::Create(s_shared.view, s_shared.bytes, REQUEST_RING_BYTES, RESPONSE_RING_BYTES);
+        ResetEvent(s_shared.requestEvent);
+        ResetEvent(s_shared.responseEvent);
+        SpawnWorker();
+    }
+
+    void StartScanWorker() {
+        const DWORD pid = GetCurrentProcessId();
+        const size_t bytes = ScanChannel::RequiredBytes(REQUEST_RING_BYTES, RESPONSE_RING_BYTES);
+
+        s_shared.mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+            (DWORD)((uint64_t)bytes >> 32), (DWORD)bytes, ObjectName(pid, L"map").c_str());
+        if (s_shared.mapping) s_shared.view = MapViewOfFile(s_shared.mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+        s_shared.bytes = bytes;
+        s_shared.requestEvent = CreateEventW(nullptr, FALSE, FALSE, ObjectName(pid, L"request").c_str());
+        s_shared.responseEvent = CreateEventW(nullptr, FALSE, FALSE, ObjectName(pid, L"response").c_str());
+        if (!s_shared.view || !s_shared.requestEvent || !s_shared.responseEvent) {
+            OutputDebugString(L"[hint_map] Scan worker channel setup failed, scanning in-process.\n");
+            CloseShared(s_shared);
+            return;
+        }
+
+        // The channel must exist before the worker can attach to it
+        s_channel = ScanChannel::Create(s_shared.view, bytes, REQUEST_RING_BYTES, RESPONSE_RING_BYTES);
+        SpawnWorker();
+    }
+
+    void StopScanWorker() {
+        KillWorker();
+        s_channel = ScanChannel();
+        CloseShared(s_shared);
+
+        s_automation.Reset();
+        if (s_comInitialized) CoUninitialize();
+        s_comInitialized = false;
+    }
+
+    enum class WorkerScan {
+        OK,
+        FAILED,         // hung, crashed or garbled; the worker has been replaced
+        UNAVAILABLE     // no worker to ask, or it can't return this result
+    };
+
+    // What a result says besides its targets
+    struct WorkerReply {
+        uint32_t status = SCAN_STATUS_OK;
+        Rect bounds;                // container requests: the container's viewport
+        ScanStageTimes stages;
+    };
+
+    // Decodes straight out of the ring; the record stays unconsumed until this returns
+    static bool DecodeResult(const ScanRecordView& record, std::vector<HintTarget>& targets, WorkerReply& reply) {
+        ScanResultView view;
+        if (!view.Parse(record.payload, record.size)) return false;
+
+        reply.status = view.Status();
+        reply.bounds = view.Bounds();
+        reply.stages.setupUs = view.SetupUs();
+        reply.stages.findUs = view.FindUs();
+        reply.stages.filterUs = view.FilterUs();
+        targets.resize(view.Count());
+        for (uint32_t i = 0; i < view.Count(); ++i) {
+            const ScanTargetRecord& r = view.Target(i);
+            HintTarget& t = targets[i];
+            t.rect = { r.left, r.top, r.right, r.bottom };
+            t.controlTypeId = r.controlType;
+            t.name.assign(reinterpret_cast<const wchar_t*>(view.Name(i)), r.nameLength);
+            t.automationId.assign(reinterpret_cast<const wchar_t*>(view.AutomationId(i)), r.automationIdLength);
+            t.runtimeId.assign(view.RuntimeId(i), view.RuntimeId(i) + r.runtimeIdCount);
+        }
+        return true;
+    }
+
+    // Sends one request and waits for its result. OK means the worker answered, with
+    // reply.status saying how; the targets are only filled for SCAN_STATUS_OK.
+    static WorkerScan AskWorker(uint32_t type, const void* request, uint32_t requestSize,
+        std::vector<HintTarget>& targets, WorkerReply& reply) {
+        if (!s_channel.Valid()) return WorkerScan::UNAVAILABLE;
+        if (!s_workerProcess || WaitForSingleObject(s_workerProcess, 0) == WAIT_OBJECT_0) {
+            // Exited between scans (or never started): try again for the next one
+            RestartWorker();
+            return WorkerScan::UNAVAILABLE;
+        }
+
+        const uint32_t sequence = ++s_sequence;
+        s_channel.Drain(SCAN_RESPONSES);
+        if (!s_channel.Write(SCAN_REQUESTS, type, sequence, request, requestSize)) {
+            return WorkerScan::UNAVAILABLE;
+        }
+        SetEvent(s_shared.requestEvent);
+
+        ULONGLONG deadline = GetTickCount64() + SCAN_DEADLINE_MS;
+        HANDLE waits[2] = { s_shared.responseEvent, s_workerProcess };
+        for (;;) {
+            ScanRecordView record;
+            while (s_channel.Peek(SCAN_RESPONSES, record)) {
+                if (record.type != SCAN_RECORD_RESULT || record.sequence != sequence) {
+                    s_channel.Consume(SCAN_RESPONSES, record);
+                    continue;
+                }
+                const bool decoded = DecodeResult(record, targets, reply);
+                s_channel.Consume(SCAN_RESPONSES, record);
+                if (decoded && reply.status != SCAN_STATUS_OK) targets.clear();
+                if (decoded) return WorkerScan::OK;
+                targets.clear();
+                deadline = 0;   // garbled: treat like a hang
+                break;
+            }
+
+            const ULONGLONG now = GetTickCount64();
+            if (now >= deadline) break;
+            const DWORD wait = WaitForMultipleObjects(2, waits, FALSE, (DWORD)(deadline - now));
+            if (wait != WAIT_OBJECT_0 && wait != WAIT_TIMEOUT) break;   // worker died mid-scan
+        }
+
+        OutputDebugString(L"[hint_map] Scan worker failed to answer in time, restarting it.\n");
+        targets.clear();
+        RestartWorker();
+        return WorkerScan::FAILED;
+    }
+
+    // The worker's scan stages as children of the current "Worker scan" span. Only their
+    // durations cross over, so they're laid end to end, ending as the answer arrived.
+    static void TraceWorkerStages(const ScanStageTimes& stages) {
+        if (!IsTracingEnabled()) return;
+        const uint64_t now = TraceNowMicroseconds();
+        const uint64_t total = stages.setupUs + stages.findUs + stages.filterUs;
+        uint64_t start = now > total ? now - total : 0;
+        TraceSpan("Scan setup", start, stages.setupUs);
+        start += stages.setupUs;
+        TraceSpan("FindAllBuildCache", start, stages.findUs);
+        start += stages.findUs;
+        TraceSpan("Filter elements", start, stages.filterUs);
+    }
+
+    static WorkerScan ScanViaWorker(HWND hwnd, std::vector<HintTarget>& targets) {
+        const ScanRequestPayload request = { (uint64_t)(uintptr_t)hwnd };
+        WorkerReply reply;
+        const WorkerScan result = AskWorker(SCAN_RECORD_REQUEST, &request, sizeof(request), targets, reply);
+        if (result == WorkerScan::OK && reply.status != SCAN_STATUS_OK) return WorkerScan::UNAVAILABLE;
+        if (result == WorkerScan::OK) TraceWorkerStages(reply.stages);
+        return result;
+    }
+
+    std::vector<HintTarget> ScanForegroundTargets() {
+        HWND hwnd = GetForegroundWindow();
+        std::vector<HintTarget> targets;
+        const CompiledScanProfile& profile = ScanProfileFor(hwnd);
+        if (profile.strategy == ScanStrategy::GRID) {
+            OutputDebugString(L"[hint_map] Scan profile says grid, skipping the scan.\n");
+            return targets;
+        }
+        if (profile.strategy == ScanStrategy::WORKER) {
+            ScopedTrace trace("Worker scan");
+            const auto start = std::chrono::steady_clock::now();
+            const WorkerScan result = ScanViaWorker(hwnd, targets);
+            // Don't retry a hung or crashing provider in the process that holds the hook.
+            // A fallback is timed as ScanElements by GetClickableElements instead.
+            if (result != WorkerScan::UNAVAILABLE) {
+                RecordLatency(LatencyMetric::WorkerScan, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+                return targets;
+            }
+        }
+        return GetClickableElements(hwnd);
+    }
+
+    bool ScanContainerAt(HWND window, POINT pt, std::vector<HintTarget>& items, RECT& viewport) {
+        items.clear();
+        const CompiledScanProfile& profile = ScanProfileFor(window);
+        if (profile.strategy == ScanStrategy::GRID) return false;
+        if (profile.strategy == ScanStrategy::WORKER) {
+            ScopedTrace trace("Worker container scan");
+            const ScanContainerRequestPayload request = { (int32_t)pt.x, (int32_t)pt.y };
+            WorkerReply reply;
+            const WorkerScan result = AskWorker(SCAN_RECORD_CONTAINER_REQUEST, &request, sizeof(request), items, reply);
+            if (result == WorkerScan::OK && reply.status != SCAN_STATUS_TOO_LARGE) {
+                viewport = { reply.bounds.left, reply.bounds.top, reply.bounds.right, reply.bounds.bottom };
+                return reply.status == SCAN_STATUS_OK;
+            }
+            // Same rule as a full scan: a provider that hung the worker isn't retried here
+            if (result == WorkerScan::FAILED) return false;
+        }
+        return GetContainerItemsAt(pt, items, viewport);
+    }
+
+    // Ancestors of the hit-test result checked for the runtime id: the point usually lands
+    // on a button's text or icon rather than the button
+    static const int HIT_TEST_PARENTS = 4;
+
+    static bool HasRuntimeId(IUIAutomationElement* element, const int32_t* runtimeId, uint32_t count) {
+        SAFEARRAY* ids = nullptr;
+        if (FAILED(element->GetRuntimeId(&ids)) || !ids) return false;
+        LONG lower = 0, upper = -1;
+        SafeArrayGetLBound(ids, 1, &lower);
+        SafeArrayGetUBound(ids, 1, &upper);
+        bool same = false;
+        int* data = nullptr;
+        if ((uint32_t)(upper - lower + 1) == count && SUCCEEDED(SafeArrayAccessData(ids, (void**)&data))) {
+            same = memcmp(data, runtimeId, count * sizeof(int32_t)) == 0;
+            SafeArrayUnaccessData(ids);
+        }
+        SafeArrayDestroy(ids);
+        return same;
+    }
+
+    // The element with this runtime id if it's under pt: one hit test and a few parents,
+    // never a search of the window
+    static Microsoft::WRL::ComPtr<IUIAutomationElement> ElementAtPoint(IUIAutomation* automation, POINT pt,
+        const int32_t* runtimeId, uint32_t count) {
+        Microsoft::WRL::ComPtr<IUIAutomationElement> element;
+        Microsoft::WRL::ComPtr<IUIAutomationTreeWalker> walker;
+        if (FAILED(automation->ElementFromPoint(pt, &element)) || !element ||
+            FAILED(automation->get_ControlViewWalker(&walker)) || !walker) return nullptr;
+        for (int i = 0; element && i <= HIT_TEST_PARENTS; ++i) {
+            if (HasRuntimeId(element.Get(), runtimeId, count)) return element;
+            Microsoft::WRL::ComPtr<IUIAutomationElement> parent;
+            if (FAILED(walker->GetParentElement(element.Get(), &parent))) break;
+            element = parent;
+        }
+        return nullptr;
+    }
+
+    static bool InvokeElement(IUIAutomationElement* element) {
+        Microsoft::WRL::ComPtr<IUIAutomationInvokePattern> invoke;
+        if (SUCCEEDED(element->GetCurrentPatternAs(UIA_InvokePatternId, IID_PPV_ARGS(&invoke))) && invoke) {
+            return SUCCEEDED(invoke->Invoke());
+        }
+        Microsoft::WRL::ComPtr<IUIAutomationLegacyIAccessiblePattern> legacy;
+        if (SUCCEEDED(element->GetCurrentPatternAs(UIA_LegacyIAccessiblePatternId, IID_PPV_ARGS(&legacy))) && legacy) {
+            return SUCCEEDED(legacy->DoDefaultAction());
+        }
+        return false;
+    }
+
+    bool InvokeWorkerTarget(const HintTarget& target) {
+        if (target.runtimeId.empty() || target.runtimeId.size() > SCAN_MAX_RUNTIME_ID) return false;
+        const POINT centre = { (target.rect.left + target.rect.right) / 2, (target.rect.top + target.rect.bottom) / 2 };
+
+        // The worker finds and invokes it, since the provider that might hang is the one
+        // the scan ran against
+        ScanInvokeRequestPayload request = {};
+        request.window = (uint64_t)(uintptr_t)GetForegroundWindow();
+        request.x = centre.x;
+        request.y = centre.y;
+        request.runtimeIdCount = (uint32_t)target.runtimeId.size();
+        memcpy(request.runtimeId, target.runtimeId.data(), target.runtimeId.size() * sizeof(int32_t));
+        std::vector<HintTarget> unused;
+        WorkerReply reply;
+        const WorkerScan result = AskWorker(SCAN_RECORD_INVOKE_REQUEST, &request, sizeof(request), unused, reply);
+        if (result == WorkerScan::OK) return reply.status == SCAN_STATUS_OK;
+        // It may have hung inside the invoke (some providers block until a dialog it opens
+        // closes), so a click now could act twice
+        if (result == WorkerScan::FAILED) return true;
+
+        // No worker: only what the hit test finds, so a hung provider costs one call
+        ScopedTrace trace("Resolve element");
+        if (!s_automation) {
+            if (!s_comInitialized) s_comInitialized = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+            HRESULT hr = CoCreateInstance(__uuidof(CUIAutomation), nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&s_automation));
+            if (FAILED(hr) || !s_automation) {
+                OutputDebugStringW(L"[hint_map] CoCreateInstance for CUIAutomation failed\n");
+                s_automation.Reset();
+                return false;
+            }
+        }
+        Microsoft::WRL::ComPtr<IUIAutomationElement> element =
+            ElementAtPoint(s_automation.Get(), centre, request.runtimeId, request.runtimeIdCount);
+        return element && InvokeElement(element.Get());
+    }
+
+    Microsoft::WRL::ComPtr<IUIAutomationElement> FindElementByRuntimeId(IUIAutomation* automation,
+        IUIAutomationElement* root, const std::vector<int>& runtimeId) {
+        Microsoft::WRL::ComPtr<IUIAutomationElement> element;
+        if (!automation || !root || runtimeId.empty()) return element;
+
+        SAFEARRAY* ids = SafeArrayCreateVector(VT_I4, 0, (ULONG)runtimeId.size());
+        if (!ids) return element;
+        int* data = nullptr;
+        if (SUCCEEDED(SafeArrayAccessData(ids, (void**)&data))) {
+            memcpy(data, runtimeId.data(), runtimeId.size() * sizeof(int));
+            SafeArrayUnaccessData(ids);
+        }
+
+        VARIANT value;
+        VariantInit(&value);
+        value.vt = VT_I4 | VT_ARRAY;
+        value.parray = ids;
+        Microsoft::WRL::ComPtr<IUIAutomationCondition> condition;
+        if (SUCCEEDED(automation->CreatePropertyCondition(UIA_RuntimeIdPropertyId, value, &condition)) && condition) {
+            root->FindFirst(TreeScope_Subtree, condition.Get(), &element);
+        }
+        VariantClear(&value);
+        return element;
+    }
+
+    // ---- Worker side ----
+
+    bool ParseScanWorkerCommandLine(const char* cmdLine, DWORD& parentPid) {
+        static const char flag[] = "--scan-worker";
+        const char* p = cmdLine ? strstr(cmdLine, flag) : nullptr;
+        if (!p) return false;
+        parentPid = strtoul(p + sizeof(flag) - 1, nullptr, 10);
+        return parentPid != 0;
+    }
+
+    static std::vector<uint8_t> SerializeTargets(const std::vector<HintTarget>& targets,
+        uint32_t status = SCAN_STATUS_OK, const Rect& bounds = Rect(), const ScanStageTimes& stages = ScanStageTimes()) {
+        ScanResultWriter writer;
+        writer.SetStatus(status);
+        writer.SetBounds(bounds);
+        writer.SetStageTimes((uint32_t)stages.setupUs, (uint32_t)stages.findUs, (uint32_t)stages.filterUs);
+        for (const HintTarget& t : targets) {
+            writer.Add(MakeRect(t.rect.left, t.rect.top, t.rect.right, t.rect.bottom), t.controlTypeId,
+                t.runtimeId.data(), (uint32_t)t.runtimeId.size(),
+                reinterpret_cast<const uint16_t*>(t.name.data()), (uint32_t)t.name.size(),
+                reinterpret_cast<const uint16_t*>(t.automationId.data()), (uint32_t)t.automationId.size());
+        }
+        return writer.Finish();
+    }
+
+    // Worker side of InvokeWorkerTarget: the element at the target's centre, or failing
+    // that a search of the window, under the app's deadline like a scan
+    static uint32_t InvokeRequested(const ScanInvokeRequestPayload& request) {
+        ScopedTrace trace("Worker invoke");
+        if (request.runtimeIdCount == 0 || request.runtimeIdCount > SCAN_MAX_RUNTIME_ID) return SCAN_STATUS_NOT_INVOKED;
+        if (FAILED(CoInitializeEx(nullptr, COINIT_MULTITHREADED))) return SCAN_STATUS_NOT_INVOKED;
+
+        bool invoked = false;
+        {
+            Microsoft::WRL::ComPtr<IUIAutomation> automation;
+            if (SUCCEEDED(CoCreateInstance(__uuidof(CUIAutomation), nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&automation))) && automation) {
+                const POINT pt = { request.x, request.y };
+                Microsoft::WRL::ComPtr<IUIAutomationElement> element =
+                    ElementAtPoint(automation.Get(), pt, request.runtimeId, request.runtimeIdCount);
+                Microsoft::WRL::ComPtr<IUIAutomationElement> root;
+                if (!element && SUCCEEDED(automation->ElementFromHandle((HWND)(uintptr_t)request.window, &root)) && root) {
+                    element = FindElementByRuntimeId(automation.Get(), root.Get(),
+                        std::vector<int>(request.runtimeId, request.runtimeId + request.runtimeIdCount));
+                }
+                invoked = element && InvokeElement(element.Get());
+            }
+        }
+        CoUninitialize();
+        return invoked ? SCAN_STATUS_OK : SCAN_STATUS_NOT_INVOKED;
+    }
+
+    int RunScanWorker(HINSTANCE hInstance, DWORD parentPid) {
+        // The scanner clips to the virtual screen
+        InitMonitorCache(hInstance);
+
+        SharedObjects shared;
+        shared.mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, ObjectName(parentPid, L"map").c_str());
+        if (shared.mapping) shared.view = MapViewOfFile(shared.mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        MEMORY_BASIC_INFORMATION info = {};
+        if (shared.view && VirtualQuery(shared.view, &info, sizeof(info))) shared.bytes = info.RegionSize;
+        shared.requestEvent = OpenEventW(SYNCHRONIZE | EVENT_MODIFY_STATE, FALSE, ObjectName(parentPid, L"request").c_str());
+        shared.responseEvent = OpenEventW(SYNCHRONIZE | EVENT_MODIFY_STATE, FALSE, ObjectName(parentPid, L"response").c_str());
+
+        // Exit with the app rather than linger if it crashes
+        HANDLE parent = OpenProcess(SYNCHRONIZE, FALSE, parentPid);
+
+        ScanChannel channel = ScanChannel::Attach(shared.view, shared.bytes);
+        if (!channel.Valid() || !shared.requestEvent || !shared.responseEvent || !parent) {
+            OutputDebugString(L"[hint_map] Scan worker could not attach to the app.\n");
+            if (parent) CloseHandle(parent);
+            CloseShared(shared);
+            ShutdownMonitorCache();
+            return 1;
+        }
+
+        HANDLE waits[2] = { shared.requestEvent, parent };
+        while (WaitForMultipleObjects(2, waits, FALSE, INFINITE) == WAIT_OBJECT_0) {
+            ScanRecordView record;
+            while (channel.Peek(SCAN_REQUESTS, record)) {
+                ScanRequestPayload request = {};
+                ScanContainerRequestPayload containerRequest = {};
+                ScanInvokeRequestPayload invokeRequest = {};
+                const bool scan = record.type == SCAN_RECORD_REQUEST && record.size == sizeof(request);
+                const bool container = record.type == SCAN_RECORD_CONTAINER_REQUEST && record.size == sizeof(containerRequest);
+                const bool invoke = record.type == SCAN_RECORD_INVOKE_REQUEST && record.size == sizeof(invokeRequest);
+                if (scan) memcpy(&request, record.payload, sizeof(request));
+                if (container) memcpy(&containerRequest, record.payload, sizeof(containerRequest));
+                if (invoke) memcpy(&invokeRequest, record.payload, sizeof(invokeRequest));
+                const uint32_t sequence = record.sequence;
+                channel.Consume(SCAN_REQUESTS, record);
+                if (!scan && !container && !invoke) continue;
+
+                std::vector<uint8_t> payload;
+                if (invoke) {
+                    payload = SerializeTargets(std::vector<HintTarget>(), InvokeRequested(invokeRequest));
+                }
+                else if (scan) {
+                    ScanStageTimes stages;
+                    const std::vector<HintTarget> targets = GetClickableElements((HWND)(uintptr_t)request.window, &stages);
+                    payload = SerializeTargets(targets, SCAN_STATUS_OK, Rect(), stages);
+                }
+                else {
+                    std::vector<HintTarget> items;
+                    RECT viewport = {};
+                    const POINT pt = { containerRequest.x, containerRequest.y };
+                    const bool found = GetContainerItemsAt(pt, items, viewport);
+                    payload = SerializeTargets(items, found ? SCAN_STATUS_OK : SCAN_STATUS_NO_CONTAINER,
+                        MakeRect(viewport.left, viewport.top, viewport.right, viewport.bottom));
+                }
+                if (!channel.Write(SCAN_RESPONSES, SCAN_RECORD_RESULT, sequence, payload.data(), (uint32_t)payload.size())) {
+                    ScanResultWriter tooLarge;
+                    tooLarge.SetStatus(SCAN_STATUS_TOO_LARGE);
+                    payload = tooLarge.Finish();
+                    channel.Write(SCAN_RESPONSES, SCAN_RECORD_RESULT, sequence, payload.data(), (uint32_t)payload.size());
+                }
+                SetEvent(shared.responseEvent);
+            }
+        }
+
+        CloseHandle(parent);
+        CloseShared(shared);
+        ShutdownMonitorCache();
+        return 0;
+    }
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include "UIElementScanner.h"
+
+namespace hint_map {
+
+    // UIA scans run in a child copy of this exe, so a provider that hangs or crashes takes
+    // down the worker rather than the process holding the keyboard hook. Results come back
+    // through a ScanChannel in shared memory and are decoded straight out of the ring.
+
+    // Creates the shared channel and spawns the worker (app side)
+    void StartScanWorker();
+    void StopScanWorker();
+
+    // Targets of the foreground window. Scanned by the worker when it's up, in-process
+    // otherwise or when the app's scan profile says so; empty if the profile says grid.
+    // A worker that misses the deadline is killed and respawned, and the result is empty
+    // (the caller falls back to grid mode) rather than late.
+    std::vector<HintTarget> ScanForegroundTargets();
+
+    // GetContainerItemsAt for a scroll rescan in window, run where its scan profile says:
+    // in the worker, like a full scan, or in-process. False if the profile says grid, if
+    // there's no container under pt, or if the worker hung on it.
+    bool ScanContainerAt(HWND window, POINT pt, std::vector<HintTarget>& items, RECT& viewport);
+
+    // Worker results carry a runtime id instead of an element. Invokes the live element:
+    // in the worker under the scan deadline (killed and respawned if it hangs), or with no
+    // worker, only if a hit test at the target's centre finds it. False if the element is
+    // gone or has nothing to invoke; the caller clicks the centre instead. True, with
+    // nothing more tried, if the worker hung: it may have hung inside the invoke.
+    bool InvokeWorkerTarget(const HintTarget& target);
+
+    // The element under root (inclusive) with this runtime id; null if it's gone
+    Microsoft::WRL::ComPtr<IUIAutomationElement> FindElementByRuntimeId(IUIAutomation* automation,
+        IUIAutomationElement* root, const std::vector<int>& runtimeId);
+
+    // "--scan-worker <pid>" on the command line: this process is a worker for that app
+    bool ParseScanWorkerCommandLine(const char* cmdLine, DWORD& parentPid);
+    int RunScanWorker(HINSTANCE hInstance, DWORD parentPid);
+
+}
@@ -0,0 +1,292 @@
+// ScrollEngine.cpp
+
+#include "ScrollEngine.h"
+#include <UIAutomation.h>
+#include <UIAutomationClient.h>
+#include <wrl/client.h>
+#include <comdef.h>
+#include <atomic>
+#include <thread>
+#include "ScrollMotion.h"
+#include "MonitorCache.h"
+#include "TraceRecorder.h"
+#include "UIElementScanner.h"
+
+using Microsoft::WRL::ComPtr;
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace hint_map {
+
+    static std::thread engineThread;
+    static std::atomic<bool> engineRunning{ false };
+    static std::atomic<int> requestedDirection{ 0 };
+    static HANDLE wakeEvent = nullptr;
+
+    // Everything below is owned by the engine thread
+
+    // Scroll target for one foreground window, resolved once and reused while it stays in front
+    struct ScrollTarget {
+        HWND foreground = nullptr;
+        RECT windowRect = {};
+        POINT cursor = {};              // where the cursor was when this was resolved
+        ComPtr<IUIAutomationScrollPattern> pattern;
+        double viewportHeight = 0.0;    // physical pixels
+        HWND wheelWindow = nullptr;     // fallback target for WM_MOUSEWHEEL
+        POINT wheelPoint = {};
+        float dpiScale = 1.0f;
+        unsigned refreshHz = 60;
+    };
+
+    static ComPtr<IUIAutomation> automation;
+    static ScrollTarget target;
+    static double wheelRemainder = 0.0;
+    static double pixelRemainder = 0.0;
+
+    static LONGLONG QpcNow() {
+        LARGE_INTEGER t;
+        QueryPerformanceCounter(&t);
+        return t.QuadPart;
+    }
+
+    static LONGLONG QpcFrequency() {
+        static LONGLONG freq = []() { LARGE_INTEGER f; QueryPerformanceFrequency(&f); return f.QuadPart; }();
+        return freq;
+    }
+
+    // Ancestors climbed from the element under the point before giving up
+    static const int MAX_SCROLL_DEPTH = 24;
+
+    static bool CachedBool(IUIAutomationElement* element, PROPERTYID property) {
+        VARIANT value;
+        VariantInit(&value);
+        const bool set = SUCCEEDED(element->GetCachedPropertyValue(property, &value)) &&
+            value.vt == VT_BOOL && value.boolVal == VARIANT_TRUE;
+        VariantClear(&value);
+        return set;
+    }
+
+    // Nearest vertically scrollable ancestor (or self) of the element under pt, so split
+    // views scroll the pane the cursor is over. One hit test and a short walk up, never a
+    // search of the window's tree.
+    static void FindScrollPattern(HWND hwnd, POINT pt) {
+        if (!automation) return;
+        // Nothing useful in the UIA tree of these; wheel messages only
+        if (ScanProfileFor(hwnd).strategy == ScanStrategy::GRID) return;
+        ScopedTrace trace("Find scroll container");
+
+        ComPtr<IUIAutomationCacheRequest> cacheRequest;
+        ComPtr<IUIAutomationTreeWalker> walker;
+        if (FAILED(automation->CreateCacheRequest(&cacheRequest)) || !cacheRequest ||
+            FAILED(automation->get_ControlViewWalker(&walker)) || !walker) return;
+        cacheRequest->AddProperty(UIA_IsScrollPatternAvailablePropertyId);
+        cacheRequest->AddProperty(UIA_ScrollVerticallyScrollablePropertyId);
+        cacheRequest->AddProperty(UIA_BoundingRectanglePropertyId);
+        cacheRequest->AddProperty(UIA_NativeWindowHandlePropertyId);
+
+        ComPtr<IUIAutomationElement> element;
+        if (FAILED(automation->ElementFromPointBuildCache(pt, cacheRequest.Get(), &element))) return;
+        for (int depth = 0; element && depth < MAX_SCROLL_DEPTH; ++depth) {
+            if (CachedBool(element.Get(), UIA_IsScrollPatternAvailablePropertyId) &&
+                CachedBool(element.Get(), UIA_ScrollVerticallyScrollablePropertyId)) {
+                RECT r{};
+                element->get_CachedBoundingRectangle(&r);
+                // Live pattern, not the cached one: percents must be current every frame
+                ComPtr<IUIAutomationScrollPattern> pattern;
+                if (SUCCEEDED(element->GetCurrentPatternAs(UIA_ScrollPatternId, IID_PPV_ARGS(&pattern))) && pattern) {
+                    target.pattern = pattern;
+                    target.viewportHeight = (double)(r.bottom - r.top);
+                }
+                return;
+            }
+
+            // The window's own element is as far up as it goes
+            UIA_HWND native = nullptr;
+            if (SUCCEEDED(element->get_CachedNativeWindowHandle(&native)) && (HWND)native == hwnd) return;
+
+            ComPtr<IUIAutomationElement> parent;
+            if (FAILED(walker->GetParentElementBuildCache(element.Get(), cacheRequest.Get(), &parent))) return;
+            element = parent;
+        }
+    }
+
+    static void ResolveTarget(HWND foreground) {
+        target = ScrollTarget();
+        target.foreground = foreground;
+        wheelRemainder = 0.0;
+        pixelRemainder = 0.0;
+        if (!foreground) return;
+
+        if (!GetWindowRect(foreground, &target.windowRect)) return;
+        const RECT& rect = target.windowRect;
+
+        // Scroll what's under the cursor, like a real wheel would; the window centre when
+        // the cursor is over some other window
+        GetCursorPos(&target.cursor);
+        HWND under = WindowFromPoint(target.cursor);
+        if (under && GetAncestor(under, GA_ROOT) == foreground) {
+            target.wheelPoint = target.cursor;
+        }
+        else {
+            target.wheelPoint = { (rect.left + rect.right) / 2, (rect.top + rect.bottom) / 2 };
+            under = WindowFromPoint(target.wheelPoint);
+        }
+        target.wheelWindow = (under && GetAncestor(under, GA_ROOT) == foreground) ? under : foreground;
+
+        const MonitorTopology& topology = CurrentMonitorTopology();
+        int mon = topology.FindNearestMonitor(target.wheelPoint.x, target.wheelPoint.y);
+        if (mon >= 0) {
+            target.dpiScale = topology.Monitors()[mon].Scale();
+            target.refreshHz = topology.Monitors()[mon].refreshHz;
+        }
+        if (target.refreshHz < 30) target.refreshHz = 60;
+
+        FindScrollPattern(foreground, target.wheelPoint);
+    }
+
+    static bool ScrollWithPattern(double pixels) {
+        if (!target.pattern || target.viewportHeight <= 0.0) return false;
+
+        double percent = 0.0, viewSize = 0.0;
+        if (FAILED(target.pattern->get_CurrentVerticalScrollPercent(&percent)) ||
+            FAILED(target.pattern->get_CurrentVerticalViewSize(&viewSize)) ||
+            percent < 0.0 || viewSize <= 0.0 || viewSize >= 100.0) {
+            target.pattern.Reset();
+            return false;
+        }
+
+        // Percent of the scrollable range per pixel: the view covers viewSize% of the content
+        const double scrollable = target.viewportHeight * (100.0 - viewSize) / viewSize;
+        double next = percent - pixels * 100.0 / scrollable;   // positive pixels scroll up
+        if (next < 0.0) next = 0.0;
+        if (next > 100.0) next = 100.0;
+        if (next == percent) return true;
+
+        if (FAILED(target.pattern->SetScrollPercent(UIA_ScrollPatternNoScroll, next))) {
+            target.pattern.Reset();
+            return false;
+        }
+        return true;
+    }
+
+    static void ScrollWithWheel(double pixels) {
+        if (!target.wheelWindow) return;
+
+        // About 100 px per 120-unit notch; send fractional deltas so scrolling stays smooth
+        wheelRemainder += pixels * WHEEL_DELTA / (100.0 * target.dpiScale);
+        int delta = (int)wheelRemainder;
+        if (delta == 0) return;
+        wheelRemainder -= delta;
+
+        PostMessage(target.wheelWindow, WM_MOUSEWHEEL, MAKEWPARAM(0, delta),
+            MAKELPARAM(target.wheelPoint.x, target.wheelPoint.y));
+    }
+
+    // Re-resolve only when the foreground window changed, moved or resized, or the cursor moved
+    static void RefreshTarget() {
+        HWND foreground = GetForegroundWindow();
+        RECT rect = {};
+        if (foreground) GetWindowRect(foreground, &rect);
+        POINT cursor = {};
+        GetCursorPos(&cursor);
+        if (foreground != target.foreground || !EqualRect(&rect, &target.windowRect) ||
+            cursor.x != target.cursor.x || cursor.y != target.cursor.y) {
+            ResolveTarget(foreground);
+        }
+    }
+
+    static void ApplyScroll(double pixels) {
+        RefreshTarget();
+
+        if (target.pattern) {
+            // Whole pixels only, so tiny steps are not lost to rounding inside the provider
+            pixelRemainder += pixels;
+            double whole = (double)(long long)pixelRemainder;
+            if (whole == 0.0) return;
+            pixelRemainder -= whole;
+            if (ScrollWithPattern(whole)) return;
+            pixels = whole;
+        }
+        ScrollWithWheel(pixels);
+    }
+
+    static void EngineThreadMain() {
+        HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        if (SUCCEEDED(hr)) {
+            CoCreateInstance(__uuidof(CUIAutomation), nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&automation));
+        }
+
+        HANDLE frameTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!frameTimer) frameTimer = CreateWaitableTimerW(nullptr, FALSE, nullptr);
+
+        ScrollMotion motion;
+        LONGLONG lastQpc = 0;
+
+        while (engineRunning.load()) {
+            const int direction = requestedDirection.load();
+            motion.SetDirection(direction);
+
+            if (!motion.IsMoving()) {
+                // Idle: sleep until a key event changes the direction
+                WaitForSingleObject(wakeEvent, INFINITE);
+                lastQpc = 0;
+                continue;
+            }
+
+            if (lastQpc == 0) {
+                // First frame of a gesture moves right away instead of a frame later
+                lastQpc = QpcNow();
+                RefreshTarget();
+                ApplyScroll(motion.Advance(1.0 / target.refreshHz) * target.dpiScale);
+            }
+
+            // Pace to the monitor refresh
+            LARGE_INTEGER due;
+            due.QuadPart = -(LONGLONG)(10000000LL / target.refreshHz);
+            if (frameTimer && SetWaitableTimer(frameTimer, &due, 0, nullptr, nullptr, FALSE)) {
+                HANDLE handles[2] = { frameTimer, wakeEvent };
+                WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+            }
+            else {
+                Sleep(1000 / target.refreshHz);
+            }
+
+            const LONGLONG now = QpcNow();
+            double dt = (double)(now - lastQpc) / QpcFrequency();
+            lastQpc = now;
+            if (dt > 0.1) dt = 0.1;   // don't jump after a stall
+
+            const double pixels = motion.Advance(dt) * target.dpiScale;
+            if (pixels != 0.0) ApplyScroll(pixels);
+        }
+
+        if (frameTimer) CloseHandle(frameTimer);
+        target = ScrollTarget();
+        automation.Reset();
+        if (SUCCEEDED(hr)) CoUninitialize();
+    }
+
+    void StartScrollEngine() {
+        if (engineRunning.load()) return;
+        wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        engineRunning.store(true);
+        engineThread = std::thread(EngineThreadMain);
+    }
+
+    void StopScrollEngine() {
+        if (!engineRunning.exchange(false)) return;
+        SetEvent(wakeEvent);
+        if (engineThread.joinable()) engineThread.join();
+        CloseHandle(wakeEvent);
+        wakeEvent = nullptr;
+    }
+
+    void SetScrollDirection(int direction) {
+        if (requestedDirection.exchange(direction) != direction && wakeEvent) {
+            SetEvent(wakeEvent);
+        }
+    }
+
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Windows.h>
+
+namespace hint_map {
+
+    // Smooth held-key scrolling on a dedicated thread. Scrolls the foreground window's scroll
+    // container under the cursor through UIA ScrollPattern, falling back to posted wheel
+    // messages (the only way for windows whose scan profile says grid).
+    void StartScrollEngine();
+    void StopScrollEngine();
+
+    // +1 up, -1 down, 0 release. Cheap and safe from any thread; call on every key event.
+    void SetScrollDirection(int direction);
+
+}
@@ -0,0 +1,53 @@
+// ScrollMotion.cpp
+
+#include "ScrollMotion.h"
+
+namespace hint_map {
+
+    void ScrollMotion::SetDirection(int newDirection) {
+        newDirection = (newDirection > 0) - (newDirection < 0);
+        if (newDirection == direction) return;
+
+        if (newDirection == 0) {
+            releaseSpeed = velocity < 0 ? -velocity : velocity;
+        }
+        else {
+            // Fresh press or reversal: restart the ramp
+            held = 0.0;
+        }
+        direction = newDirection;
+    }
+
+    double ScrollMotion::Advance(double dt) {
+        if (dt <= 0.0) return 0.0;
+
+        if (direction != 0) {
+            held += dt;
+            double t = curve.rampSeconds > 0.0 ? held / curve.rampSeconds : 1.0;
+            if (t > 1.0) t = 1.0;
+            const double ease = t * t * (3.0 - 2.0 * t);
+            const double speed = curve.startSpeed + (curve.maxSpeed - curve.startSpeed) * ease;
+            velocity = direction * speed;
+            return velocity * dt;
+        }
+
+        if (velocity == 0.0) return 0.0;
+
+        // Linear glide-out; integrate the trapezoid so the stop distance doesn't depend on dt
+        const double decel = curve.stopSeconds > 0.0 ? releaseSpeed / curve.stopSeconds : releaseSpeed / dt;
+        const double sign = velocity < 0 ? -1.0 : 1.0;
+        const double speed = sign * velocity;
+        double next = speed - decel * dt;
+        double distance;
+        if (next <= 0.0) {
+            distance = speed * speed / (2.0 * decel);
+            next = 0.0;
+        }
+        else {
+            distance = (speed + next) * 0.5 * dt;
+        }
+        velocity = sign * next;
+        return sign * distance;
+    }
+
+}
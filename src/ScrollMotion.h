@@ -0,0 +1,38 @@
+// ScrollMotion.h
+#pragma once
+
+namespace hint_map {
+
+    // Speeds are in pixels per second at 96 DPI
+    struct ScrollCurve {
+        double startSpeed = 500.0;      // speed right after the chord goes down
+        double maxSpeed = 2800.0;       // reached after rampSeconds of holding
+        double rampSeconds = 0.7;
+        double stopSeconds = 0.12;      // glide to rest after release
+    };
+
+    // Velocity integrator for held-key scrolling: eases from startSpeed to maxSpeed while a
+    // direction is held and glides to a stop after release. Independent of the key repeat
+    // rate; the caller advances it once per frame.
+    class ScrollMotion {
+    public:
+        explicit ScrollMotion(const ScrollCurve& curve = ScrollCurve()) : curve(curve) {}
+
+        // +1 up, -1 down, 0 released
+        void SetDirection(int direction);
+
+        // Signed distance to scroll for a frame of dt seconds (positive = up)
+        double Advance(double dt);
+
+        bool IsMoving() const { return direction != 0 || velocity != 0.0; }
+        double Velocity() const { return velocity; }
+
+    private:
+        ScrollCurve curve;
+        int direction = 0;
+        double held = 0.0;
+        double velocity = 0.0;
+        double releaseSpeed = 0.0;
+    };
+
+}
@@ -0,0 +1,134 @@
+// SpatialIndex.cpp
+
+#include "SpatialIndex.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace hint_map {
+
+    // Keeps degenerate layouts (everything on one line) from allocating huge grids
+    static const int MAX_CELLS_PER_AXIS = 256;
+
+    void SpatialIndex::Clear() {
+        centerX.clear();
+        centerY.clear();
+        cellStart.clear();
+        cellItems.clear();
+        columns = rows = 0;
+    }
+
+    void SpatialIndex::Build(const Rect* rects, size_t count) {
+        Clear();
+        const int n = (int)count;
+        if (n == 0) return;
+
+        centerX.resize(n);
+        centerY.resize(n);
+        int minX = INT_MAX, minY = INT_MAX, maxX = INT_MIN, maxY = INT_MIN;
+        for (int i = 0; i < n; ++i) {
+            centerX[i] = rects[i].left + rects[i].right;
+            centerY[i] = rects[i].top + rects[i].bottom;
+            minX = (std::min)(minX, centerX[i]);
+            maxX = (std::max)(maxX, centerX[i]);
+            minY = (std::min)(minY, centerY[i]);
+            maxY = (std::max)(maxY, centerY[i]);
+        }
+
+        // About two targets per cell on average
+        const double spanX = (double)maxX - minX + 1.0;
+        const double spanY = (double)maxY - minY + 1.0;
+        double size = std::sqrt(spanX * spanY * 2.0 / n);
+        size = (std::max)(size, (std::max)(spanX, spanY) / MAX_CELLS_PER_AXIS);
+        cellSize = (std::max)(1, (int)std::ceil(size));
+
+        originX = minX;
+        originY = minY;
+        columns = (int)(spanX / cellSize) + 1;
+        rows = (int)(spanY / cellSize) + 1;
+
+        // Counting sort of items into cells
+        cellStart.assign((size_t)columns * rows + 1, 0);
+        std::vector<int> cellOf(n);
+        for (int i = 0; i < n; ++i) {
+            cellOf[i] = ((centerY[i] - originY) / cellSize) * columns + (centerX[i] - originX) / cellSize;
+            ++cellStart[cellOf[i] + 1];
+        }
+        for (size_t c = 1; c < cellStart.size(); ++c) cellStart[c] += cellStart[c - 1];
+
+        cellItems.resize(n);
+        std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < n; ++i) cellItems[fill[cellOf[i]]++] = i;
+    }
+
+    int SpatialIndex::Nearest(int from, Direction direction) const {
+        if (from < 0 || from >= Size()) return -1;
+
+        // Work in (primary, orthogonal) axes so all four directions share one loop
+        const bool horizontal = direction == LEFT || direction == RIGHT;
+        const int sign = (direction == RIGHT || direction == DOWN) ? 1 : -1;
+        const std::vector<int>& primaryCoord = horizontal ? centerX : centerY;
+        const std::vector<int>& orthCoord = horizontal ? centerY : centerX;
+        const int p = primaryCoord[from];
+        const int o = orthCoord[from];
+        const int pOrigin = horizontal ? originX : originY;
+        const int oOrigin = horizontal ? originY : originX;
+        const int pCells = horizontal ? columns : rows;
+        const int oCells = horizontal ? rows : columns;
+        const int pCell = (p - pOrigin) / cellSize;
+        const int oCell = (o - oOrigin) / cellSize;
+
+        long long best = LLONG_MAX;
+        int bestIndex = -1;
+
+        for (int s = pCell; s >= 0 && s < pCells; s += sign) {
+            // Nothing in this slab or beyond is closer along the direction than its near edge
+            long long slabBound = 0;
+            if (s != pCell) {
+                const int edge = pOrigin + (sign > 0 ? s : s + 1) * cellSize;
+                slabBound = (long long)sign * (edge - p);
+            }
+            if (slabBound > best) break;
+
+            // Walk the slab outward from our own row/column, both ways
+            for (int step = 1; step >= -1; step -= 2) {
+                for (int t = (step > 0 ? oCell : oCell - 1); t >= 0 && t < oCells; t += step) {
+                    long long orthBound = 0;
+                    if (t > oCell) orthBound = (long long)oOrigin + (long long)t * cellSize - o;
+                    else if (t < oCell) orthBound = (long long)o - (oOrigin + (long long)(t + 1) * cellSize);
+                    if (slabBound + 2 * orthBound > best) break;
+
+                    const int cell = horizontal ? t * columns + s : s * columns + t;
+                    for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                        const int j = cellItems[k];
+                        const long long primary = (long long)sign * (primaryCoord[j] - p);
+                        if (primary <= 0) continue;
+                        const long long orth = orthCoord[j] > o ? orthCoord[j] - o : o - orthCoord[j];
+                        const long long score = primary + 2 * orth;
+                        if (score < best || (score == best && j < bestIndex)) {
+                            best = score;
+                            bestIndex = j;
+                        }
+                    }
+                }
+            }
+        }
+        return bestIndex;
+    }
+
+    int SpatialIndex::NearestToPoint(int x, int y) const {
+        int bestIndex = -1;
+        long long best = LLONG_MAX;
+        for (int i = 0; i < Size(); ++i) {
+            const long long dx = centerX[i] - 2LL * x;
+            const long long dy = centerY[i] - 2LL * y;
+            const long long d = dx * dx + dy * dy;
+            if (d < best) {
+                best = d;
+                bestIndex = i;
+            }
+        }
+        return bestIndex;
+    }
+
+}
@@ -0,0 +1,47 @@
+// SpatialIndex.h
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "Geometry.h"
+
+namespace hint_map {
+
+    // Uniform-grid index over target centres for directional "walk" navigation.
+    // Build is O(n); a directional query visits cells outward from the start and stops
+    // as soon as no unvisited cell can beat the best score, so it touches a handful of
+    // cells regardless of how many targets there are.
+    class SpatialIndex {
+    public:
+        enum Direction { LEFT, RIGHT, UP, DOWN };
+
+        void Build(const Rect* rects, size_t count);
+        void Build(const std::vector<Rect>& rects) { Build(rects.data(), rects.size()); }
+        void Clear();
+
+        int Size() const { return (int)centerX.size(); }
+
+        // Best target strictly beyond `from` in the direction, or -1. Score is the
+        // distance along the direction plus twice the sideways offset, so a target
+        // straight ahead beats a closer one off to the side. Ties go to the lower index.
+        int Nearest(int from, Direction direction) const;
+
+        // Target whose centre is closest to the point, or -1 when empty. O(n); meant for
+        // picking the starting selection once.
+        int NearestToPoint(int x, int y) const;
+
+    private:
+        // Centres in doubled coordinates (left + right), so they stay integral
+        std::vector<int> centerX;
+        std::vector<int> centerY;
+        // Items of cell c are cellItems[cellStart[c] .. cellStart[c + 1])
+        std::vector<int> cellStart;
+        std::vector<int> cellItems;
+        int originX = 0;
+        int originY = 0;
+        int cellSize = 1;
+        int columns = 0;
+        int rows = 0;
+    };
+
+}
@@ -0,0 +1,55 @@
+// TargetBuckets.cpp
+
+#include "TargetBuckets.h"
+#include <algorithm>
+
+namespace hint_map {
+
+    void TargetBuckets::Clear() {
+        std::fill(start, start + SLOTS + 1, 0);
+        items.clear();
+    }
+
+    void TargetBuckets::Build(const int* controlTypes, size_t count) {
+        Clear();
+
+        // Counting sort: each bucket keeps targets in scan order
+        for (size_t i = 0; i < count; ++i) ++start[Slot(controlTypes[i]) + 1];
+        for (int s = 1; s <= SLOTS; ++s) start[s] += start[s - 1];
+
+        items.resize(count);
+        int fill[SLOTS];
+        std::copy(start, start + SLOTS, fill);
+        for (size_t i = 0; i < count; ++i) {
+            items[fill[Slot(controlTypes[i])]++] = (int)i;
+        }
+    }
+
+    int TargetBuckets::Count(int controlTypeId) const {
+        const int s = Slot(controlTypeId);
+        return start[s + 1] - start[s];
+    }
+
+    int TargetBuckets::CountMatching(uint64_t mask) const {
+        int count = 0;
+        for (int s = 0; s < SLOTS; ++s) {
+            if (mask & (1ull << s)) count += start[s + 1] - start[s];
+        }
+        return count;
+    }
+
+    std::vector<int> TargetBuckets::Select(uint64_t mask) const {
+        std::vector<int> selected;
+        selected.reserve(CountMatching(mask));
+        int buckets = 0;
+        for (int s = 0; s < SLOTS; ++s) {
+            if (!(mask & (1ull << s)) || start[s + 1] == start[s]) continue;
+            selected.insert(selected.end(), items.begin() + start[s], items.begin() + start[s + 1]);
+            ++buckets;
+        }
+        // Each bucket is already sorted; only a mix of buckets needs ordering
+        if (buckets > 1) std::sort(selected.begin(), selected.end());
+        return selected;
+    }
+
+}
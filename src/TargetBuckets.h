@@ -0,0 +1,45 @@
+// TargetBuckets.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hint_map {
+
+    // Targets grouped by UIA control type so the hint set can be narrowed to a few types
+    // (only edits, only links, ...) without rescanning. Control type ids are a dense range
+    // starting at UIA_ButtonControlTypeId, so buckets live in a flat table indexed by
+    // id - FIRST_TYPE; anything outside the range shares one overflow slot.
+    class TargetBuckets {
+    public:
+        static const int FIRST_TYPE = 50000;                // UIA_ButtonControlTypeId
+        static const int TYPE_COUNT = 41;                   // through UIA_AppBarControlTypeId (50040)
+        static const int OTHER_SLOT = TYPE_COUNT;
+        static const int SLOTS = TYPE_COUNT + 1;
+
+        static int Slot(int controlTypeId) {
+            const int slot = controlTypeId - FIRST_TYPE;
+            return (slot >= 0 && slot < TYPE_COUNT) ? slot : OTHER_SLOT;
+        }
+        static uint64_t Bit(int controlTypeId) { return 1ull << Slot(controlTypeId); }
+        static const uint64_t ALL = (1ull << SLOTS) - 1;
+
+        // controlTypes[i] is target i's control type
+        void Build(const int* controlTypes, size_t count);
+        void Build(const std::vector<int>& controlTypes) { Build(controlTypes.data(), controlTypes.size()); }
+        void Clear();
+
+        int Size() const { return (int)items.size(); }
+        int Count(int controlTypeId) const;
+        // Number of targets whose slot bit is set in mask
+        int CountMatching(uint64_t mask) const;
+        // Targets whose slot bit is set in mask, in ascending (scan) order
+        std::vector<int> Select(uint64_t mask) const;
+
+    private:
+        int start[SLOTS + 1] = {};      // bucket s is items[start[s] .. start[s + 1])
+        std::vector<int> items;
+    };
+
+}
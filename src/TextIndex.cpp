@@ -0,0 +1,150 @@
+// TextIndex.cpp
+
+#include "TextIndex.h"
+#include <algorithm>
+
+namespace hint_map {
+
+    enum CharClass { CLASS_SPACE, CLASS_WORD, CLASS_PUNCT, CLASS_BREAK };
+
+    static CharClass Classify(wchar_t c) {
+        if (c == L'\n' || c == L'\r' || c == 0x0B || c == 0x2028 || c == 0x2029) return CLASS_BREAK;
+        if (c < 0x80) {
+            if (c == L' ' || c == L'\t' || c == L'\f' || c < 0x20) return CLASS_SPACE;
+            if ((c >= L'0' && c <= L'9') || (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z') || c == L'_') return CLASS_WORD;
+            return CLASS_PUNCT;
+        }
+        if (c == 0x00A0 || c == 0x3000 || (c >= 0x2000 && c <= 0x200B) || c == 0xFEFF) return CLASS_SPACE;
+        return CLASS_WORD;
+    }
+
+    void TextIndex::Clear() {
+        length = 0;
+        lineStarts.clear();
+        lineEnds.clear();
+        wordStarts.clear();
+        wordEnds.clear();
+        stops.clear();
+    }
+
+    void TextIndex::Build(const wchar_t* text, size_t textLength) {
+        Clear();
+        length = text ? textLength : 0;
+
+        int lineStart = 0;
+        CharClass previous = CLASS_BREAK;
+        for (int i = 0; i < (int)length; ++i) {
+            const CharClass c = Classify(text[i]);
+            if (c == CLASS_BREAK) {
+                if (wordEnds.size() < wordStarts.size()) wordEnds.push_back(i);
+                lineStarts.push_back(lineStart);
+                lineEnds.push_back(i);
+                if (lineStart == i) stops.push_back(i);
+                // CR LF is one break
+                if (text[i] == L'\r' && i + 1 < (int)length && text[i + 1] == L'\n') ++i;
+                lineStart = i + 1;
+                previous = CLASS_BREAK;
+                continue;
+            }
+            if (c != previous) {
+                if (wordEnds.size() < wordStarts.size()) wordEnds.push_back(i);
+                if (c != CLASS_SPACE) {
+                    wordStarts.push_back(i);
+                    stops.push_back(i);
+                }
+            }
+            previous = c;
+        }
+        if (wordEnds.size() < wordStarts.size()) wordEnds.push_back((int)length);
+
+        // The last line has no break; text ending in one has an empty last line
+        lineStarts.push_back(lineStart);
+        lineEnds.push_back((int)length);
+        if (lineStart == (int)length) stops.push_back(lineStart);
+    }
+
+    int TextIndex::LineOf(int offset) const {
+        if (lineStarts.empty()) return -1;
+        auto it = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+        return it == lineStarts.begin() ? 0 : (int)(it - lineStarts.begin()) - 1;
+    }
+
+    int TextIndex::WordEnd(int start) const {
+        auto it = std::lower_bound(wordStarts.begin(), wordStarts.end(), start);
+        if (it == wordStarts.end() || *it != start) return start;
+        return wordEnds[it - wordStarts.begin()];
+    }
+
+    std::vector<Rect> LayoutTextStops(const TextIndex& index, const std::vector<Rect>& lineRects,
+        const std::vector<int>& advance) {
+        const std::vector<int>& stops = index.Stops();
+        std::vector<Rect> placed(stops.size());
+        const int length = (int)index.Length();
+        if (lineRects.empty() || (int)advance.size() < length) return placed;
+
+        std::vector<long long> prefix(length + 1, 0);
+        for (int i = 0; i < length; ++i) prefix[i + 1] = prefix[i] + (std::max)(advance[i], 0);
+
+        // Displayed lines, in the same order as lineRects
+        struct Segment {
+            int start;
+            int end;
+        };
+        std::vector<Segment> segments;
+        const int lines = index.LineCount();
+
+        if ((int)lineRects.size() == lines) {
+            for (int l = 0; l < lines; ++l) segments.push_back({ index.LineStart(l), index.LineEnd(l) });
+        }
+        else {
+            // Soft wrapped. Providers often leave empty lines out, so only text is wrapped,
+            // at a scale that makes all of it as wide as all the rects.
+            long long measured = 0, available = 0;
+            for (int l = 0; l < lines; ++l) measured += prefix[index.LineEnd(l)] - prefix[index.LineStart(l)];
+            for (const Rect& r : lineRects) available += (std::max)(r.Width(), 0);
+            const double scale = measured > 0 && available > 0 ? (double)available / (double)measured : 1.0;
+            const std::vector<int>& words = index.WordStarts();
+
+            size_t k = 0;
+            for (int l = 0; l < lines && k < lineRects.size(); ++l) {
+                int s = index.LineStart(l);
+                const int e = index.LineEnd(l);
+                while (s < e && k < lineRects.size()) {
+                    // Longest run from s that fits the rect, with a little slack for rounding
+                    const double limit = lineRects[k].Width() / scale * 1.02 + 1.0;
+                    const long long* fit = std::upper_bound(&prefix[s], &prefix[e] + 1, prefix[s] + (long long)limit);
+                    int cut = (int)(fit - &prefix[0]) - 1;
+                    if (cut < e) {
+                        // Break before the last word that starts within the run
+                        auto w = std::upper_bound(words.begin(), words.end(), cut);
+                        if (w != words.begin() && *(w - 1) > s) cut = *(w - 1);
+                        else cut = (std::max)(cut, s + 1);
+                    }
+                    segments.push_back({ s, cut });
+                    ++k;
+                    s = cut;
+                }
+            }
+        }
+
+        size_t seg = 0;
+        for (size_t i = 0; i < stops.size(); ++i) {
+            const int p = stops[i];
+            while (seg < segments.size() &&
+                (segments[seg].start == segments[seg].end ? segments[seg].start < p : segments[seg].end <= p)) ++seg;
+            if (seg == segments.size()) break;
+            const Segment& s = segments[seg];
+            const bool inside = s.start == s.end ? p == s.start : (p >= s.start && p < s.end);
+            if (!inside) continue;
+
+            const Rect& r = lineRects[seg];
+            const long long width = prefix[s.end] - prefix[s.start];
+            const double scale = width > 0 ? (double)r.Width() / (double)width : 1.0;
+            const int x = r.left + (int)(scale * (double)(prefix[p] - prefix[s.start]) + 0.5);
+            const int w = p < length ? (int)(scale * advance[p] + 0.5) : 0;
+            placed[i] = MakeRect(x, r.top, x + (std::max)(w, 4), r.bottom);
+        }
+        return placed;
+    }
+
+}
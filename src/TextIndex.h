@@ -0,0 +1,54 @@
+// TextIndex.h
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "Geometry.h"
+
+namespace hint_map {
+
+    // Line and word boundaries of a block of UTF-16 text, for hinting places to put the
+    // caret. Built once per visible range in one linear pass; every hint is then served
+    // from here instead of asking the provider about each word.
+    //
+    // Words follow vim's "w": a run of letters/digits/underscore, or a run of other
+    // punctuation, starts a word. Anything at or above U+0080 that isn't a space counts
+    // as a letter, so CJK text and accented words aren't split.
+    class TextIndex {
+    public:
+        void Build(const wchar_t* text, size_t length);
+        void Clear();
+
+        size_t Length() const { return length; }
+        int LineCount() const { return (int)lineStarts.size(); }
+        int LineStart(int line) const { return lineStarts[line]; }
+        // End of the line's text, before its break
+        int LineEnd(int line) const { return lineEnds[line]; }
+        int LineOf(int offset) const;
+
+        const std::vector<int>& WordStarts() const { return wordStarts; }
+        // Offset just past the word starting at start
+        int WordEnd(int start) const;
+
+        // Word starts plus the starts of empty lines, ascending: everywhere text mode hints
+        const std::vector<int>& Stops() const { return stops; }
+
+    private:
+        size_t length = 0;
+        std::vector<int> lineStarts;
+        std::vector<int> lineEnds;
+        std::vector<int> wordStarts;
+        std::vector<int> wordEnds;
+        std::vector<int> stops;
+    };
+
+    // Screen rects for the stops of one visible range. lineRects are the rects TextPattern
+    // reports for the range, one per displayed line; advance[i] is the width of character
+    // i measured in some reference font. When there are more rects than lines the text is
+    // soft-wrapped into them at word starts, using one scale for the whole range; then each
+    // displayed line's widths are scaled to its own rect. Stops that fall outside every rect
+    // get an empty Rect.
+    std::vector<Rect> LayoutTextStops(const TextIndex& index, const std::vector<Rect>& lineRects,
+        const std::vector<int>& advance);
+
+}
@@ -0,0 +1,247 @@
+// TextNavigator.cpp
+
+#include "TextNavigator.h"
+#include <UIAutomationClient.h>
+#include <cmath>
+#include <string>
+#include "TextIndex.h"
+#include "TraceRecorder.h"
+
+namespace hint_map {
+
+    // More than a few screenfuls is a provider reporting the whole document as visible
+    static const int MAX_RANGE_CHARS = 64 * 1024;
+    // Height advances are measured at; only their ratios matter once scaled to the line rects
+    static const int REFERENCE_FONT_PX = 32;
+
+    struct TextStop {
+        int range;      // into s_ranges
+        int start;      // characters from the range start, as TextPattern counts them
+        int end;        // end of the stop's word, same units
+    };
+
+    static Microsoft::WRL::ComPtr<IUIAutomation> s_automation;
+    static bool s_comInitialized = false;
+
+    // Held from GetTextStopTargets until the overlay closes (UI thread)
+    static Microsoft::WRL::ComPtr<IUIAutomationTextPattern> s_pattern;
+    static std::vector<Microsoft::WRL::ComPtr<IUIAutomationTextRange>> s_ranges;
+    static std::vector<TextStop> s_stops;     // per target
+
+    static bool EnsureAutomation() {
+        if (s_automation) return true;
+        if (!s_comInitialized) s_comInitialized = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+        HRESULT hr = CoCreateInstance(__uuidof(CUIAutomation), nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&s_automation));
+        if (FAILED(hr) || !s_automation) {
+            OutputDebugStringW(L"[hint_map] CoCreateInstance for CUIAutomation failed in text mode\n");
+            s_automation.Reset();
+            return false;
+        }
+        return true;
+    }
+
+    // One rect per displayed line, from the provider's (left, top, width, height) doubles
+    static std::vector<Rect> LineRects(IUIAutomationTextRange* range) {
+        std::vector<Rect> rects;
+        SAFEARRAY* values = nullptr;
+        if (FAILED(range->GetBoundingRectangles(&values)) || !values) return rects;
+        double* data = nullptr;
+        if (SUCCEEDED(SafeArrayAccessData(values, (void**)&data))) {
+            const LONG count = (LONG)values->rgsabound[0].cElements;
+            for (LONG i = 0; i + 3 < count; i += 4) {
+                const int left = (int)std::lround(data[i]);
+                const int top = (int)std::lround(data[i + 1]);
+                rects.push_back(MakeRect(left, top, left + (int)std::lround(data[i + 2]), top + (int)std::lround(data[i + 3])));
+            }
+            SafeArrayUnaccessData(values);
+        }
+        SafeArrayDestroy(values);
+        return rects;
+    }
+
+    // The range's font, or Segoe UI when it's mixed or not reported
+    static std::wstring FontName(IUIAutomationTextRange* range) {
+        std::wstring name = L"Segoe UI";
+        VARIANT value;
+        VariantInit(&value);
+        if (SUCCEEDED(range->GetAttributeValue(UIA_FontNameAttributeId, &value)) &&
+            value.vt == VT_BSTR && value.bstrVal && SysStringLen(value.bstrVal)) {
+            name.assign(value.bstrVal, SysStringLen(value.bstrVal));
+        }
+        VariantClear(&value);
+        return name;
+    }
+
+    // Width of each character in the DC's font, one GDI call per line
+    static std::vector<int> MeasureAdvances(HDC dc, const std::wstring& text, const TextIndex& index) {
+        std::vector<int> advance(text.size(), 0);
+        std::vector<int> extents;
+        SIZE size;
+        const int tabWidth = (GetTextExtentPoint32W(dc, L" ", 1, &size) ? size.cx : REFERENCE_FONT_PX / 4) * 4;
+
+        for (int l = 0; l < index.LineCount(); ++l) {
+            const int s = index.LineStart(l);
+            const int e = index.LineEnd(l);
+            if (e <= s) continue;
+            extents.resize(e - s);
+            if (!GetTextExtentExPointW(dc, text.data() + s, e - s, 0, nullptr, extents.data(), &size)) continue;
+            int previous = 0;
+            for (int i = s; i < e; ++i) {
+                advance[i] = text[i] == L'\t' ? tabWidth : extents[i - s] - previous;
+                previous = extents[i - s];
+            }
+        }
+        return advance;
+    }
+
+    // TextPattern moves by characters as the user sees them: a surrogate pair is one
+    static int CharactersBetween(const std::wstring& text, int from, int to) {
+        int count = 0;
+        for (int i = from; i < to; ++i) {
+            if (text[i] < 0xDC00 || text[i] > 0xDFFF) ++count;
+        }
+        return count;
+    }
+
+    std::vector<HintTarget> GetTextStopTargets() {
+        ScopedTrace trace("Text stops");
+        ClearTextStops();
+        std::vector<HintTarget> targets;
+        if (!EnsureAutomation()) return targets;
+
+        Microsoft::WRL::ComPtr<IUIAutomationElement> focused;
+        if (FAILED(s_automation->GetFocusedElement(&focused)) || !focused) return targets;
+        if (FAILED(focused->GetCurrentPatternAs(UIA_TextPatternId, IID_PPV_ARGS(&s_pattern))) || !s_pattern) {
+            s_pattern.Reset();
+            return targets;
+        }
+
+        Microsoft::WRL::ComPtr<IUIAutomationTextRangeArray> visible;
+        int rangeCount = 0;
+        if (FAILED(s_pattern->GetVisibleRanges(&visible)) || !visible || FAILED(visible->get_Length(&rangeCount))) {
+            return targets;
+        }
+
+        HDC dc = CreateCompatibleDC(nullptr);
+        if (!dc) return targets;
+        HFONT font = nullptr;
+        HGDIOBJ originalFont = nullptr;
+        std::wstring fontName;
+        TextIndex index;
+        int characters = 0;
+
+        for (int r = 0; r < rangeCount; ++r) {
+            Microsoft::WRL::ComPtr<IUIAutomationTextRange> range;
+            if (FAILED(visible->GetElement(r, &range)) || !range) continue;
+
+            BSTR text = nullptr;
+            if (FAILED(range->GetText(MAX_RANGE_CHARS, &text)) || !text) continue;
+            std::wstring content(text, SysStringLen(text));
+            SysFreeString(text);
+            std::vector<Rect> lines = LineRects(range.Get());
+            if (content.empty() || lines.empty()) continue;
+
+            const std::wstring name = FontName(range.Get());
+            if (!font || name != fontName) {
+                HFONT next = CreateFontW(-REFERENCE_FONT_PX, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+                    OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY, DEFAULT_PITCH, name.c_str());
+                if (next) {
+                    HGDIOBJ previous = SelectObject(dc, next);
+                    if (!originalFont) originalFont = previous;
+                    if (font) DeleteObject(font);
+                    font = next;
+                    fontName = name;
+                }
+            }
+
+            index.Build(content.data(), content.size());
+            std::vector<int> advance = MeasureAdvances(dc, content, index);
+            std::vector<Rect> placed = LayoutTextStops(index, lines, advance);
+            characters += (int)content.size();
+
+            const int rangeIndex = (int)s_ranges.size();
+            s_ranges.push_back(range);
+            const std::vector<int>& stops = index.Stops();
+            int unit = 0;           // UTF-16 offset
+            int character = 0;      // the same offset in TextPattern characters
+            for (size_t k = 0; k < stops.size(); ++k) {
+                if (placed[k].Empty()) continue;
+                const int start = stops[k];
+                const int end = index.WordEnd(start);
+                character += CharactersBetween(content, unit, start);
+                unit = start;
+
+                HintTarget target;
+                target.rect = { placed[k].left, placed[k].top, placed[k].right, placed[k].bottom };
+                target.controlTypeId = UIA_TextControlTypeId;
+                target.name = content.substr(start, end - start);
+                targets.push_back(std::move(target));
+                s_stops.push_back({ rangeIndex, character, character + CharactersBetween(content, start, end) });
+            }
+        }
+
+        if (originalFont) SelectObject(dc, originalFont);
+        if (font) DeleteObject(font);
+        DeleteDC(dc);
+
+        wchar_t buf[128];
+        swprintf_s(buf, L"[hint_map] Text mode: %zu stops in %zu visible ranges (%d characters).\n",
+            targets.size(), s_ranges.size(), characters);
+        OutputDebugString(buf);
+        return targets;
+    }
+
+    // Empty range at offset characters into the stop's visible range
+    static Microsoft::WRL::ComPtr<IUIAutomationTextRange> PointInRange(const TextStop& stop, int offset) {
+        Microsoft::WRL::ComPtr<IUIAutomationTextRange> point;
+        if (FAILED(s_ranges[stop.range]->Clone(&point)) || !point) return point;
+        int moved = 0;
+        point->MoveEndpointByUnit(TextPatternRangeEndpoint_Start, TextUnit_Character, offset, &moved);
+        point->MoveEndpointByRange(TextPatternRangeEndpoint_End, point.Get(), TextPatternRangeEndpoint_Start);
+        return point;
+    }
+
+    bool SelectTextStop(int index, bool extend) {
+        if (index < 0 || index >= (int)s_stops.size() || !s_pattern) return false;
+        ScopedTrace trace("Select text");
+        const TextStop& stop = s_stops[index];
+        Microsoft::WRL::ComPtr<IUIAutomationTextRange> target = PointInRange(stop, stop.start);
+        if (!target) return false;
+
+        Microsoft::WRL::ComPtr<IUIAutomationTextRangeArray> selection;
+        Microsoft::WRL::ComPtr<IUIAutomationTextRange> current;
+        int count = 0;
+        if (extend && SUCCEEDED(s_pattern->GetSelection(&selection)) && selection &&
+            SUCCEEDED(selection->get_Length(&count)) && count > 0 &&
+            SUCCEEDED(selection->GetElement(0, &current)) && current) {
+            int order = 0;
+            current->CompareEndpoints(TextPatternRangeEndpoint_Start, target.Get(), TextPatternRangeEndpoint_Start, &order);
+            if (order <= 0) {
+                // At or past the selection's start: keep the start, end after the word
+                Microsoft::WRL::ComPtr<IUIAutomationTextRange> wordEnd = PointInRange(stop, stop.end);
+                if (wordEnd) current->MoveEndpointByRange(TextPatternRangeEndpoint_End, wordEnd.Get(), TextPatternRangeEndpoint_Start);
+            }
+            else {
+                current->MoveEndpointByRange(TextPatternRangeEndpoint_Start, target.Get(), TextPatternRangeEndpoint_Start);
+            }
+            target = current;
+        }
+
+        // Selecting an empty range puts the caret there
+        HRESULT hr = target->Select();
+        if (FAILED(hr)) {
+            wchar_t buf[96];
+            swprintf_s(buf, L"[hint_map] Text mode: Select failed (0x%08X).\n", (unsigned)hr);
+            OutputDebugString(buf);
+            return false;
+        }
+        return true;
+    }
+
+    void ClearTextStops() {
+        s_stops.clear();
+        s_ranges.clear();
+        s_pattern.Reset();
+    }
+
+}
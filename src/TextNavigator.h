@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include "UIElementScanner.h"
+
+namespace hint_map {
+
+    // Text mode: hints on the starts of words and lines in the visible text of the focused
+    // document or edit control. Each visible range is fetched through TextPattern once per
+    // activation (text, line rects, font) and indexed locally with TextIndex; no hint costs
+    // a call into the provider until one is picked.
+
+    // One target per stop that's on screen, named with its word for search mode. Empty if
+    // the focused element has no TextPattern or nothing visible.
+    std::vector<HintTarget> GetTextStopTargets();
+
+    // Puts the caret at the stop behind target index (from the last GetTextStopTargets).
+    // With extend, the selection grows from its far end to take in that word instead.
+    bool SelectTextStop(int index, bool extend);
+
+    // Drops the ranges and pattern held since the last GetTextStopTargets
+    void ClearTextStops();
+
+}
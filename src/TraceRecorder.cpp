@@ -0,0 +1,138 @@
+// TraceRecorder.cpp
+
+#include "TraceRecorder.h"
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace hint_map {
+
+    static const size_t TRACE_CAPACITY = 16384;
+
+    static std::atomic<bool> tracingEnabled{ false };
+    static std::atomic<uint32_t> currentActivation{ 0 };
+    static std::atomic<uint32_t> nextThreadId{ 1 };
+
+    // Ring of the most recent events. Tracing is opt-in and events are coarse
+    // (stages and keystrokes), so a plain mutex is cheap enough here.
+    static std::mutex traceMutex;
+    static std::vector<TraceEvent> traceRing;
+    static size_t traceNext = 0;
+    static size_t traceCount = 0;
+
+    static uint32_t CurrentThreadTraceId() {
+        static thread_local uint32_t id = nextThreadId.fetch_add(1);
+        return id;
+    }
+
+    static void Append(const TraceEvent& e) {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        if (traceRing.empty()) traceRing.resize(TRACE_CAPACITY);
+        traceRing[traceNext] = e;
+        traceNext = (traceNext + 1) % TRACE_CAPACITY;
+        if (traceCount < TRACE_CAPACITY) ++traceCount;
+    }
+
+    void SetTracingEnabled(bool enabled) {
+        tracingEnabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool IsTracingEnabled() {
+        return tracingEnabled.load(std::memory_order_relaxed);
+    }
+
+    uint32_t BeginTraceActivation() {
+        return currentActivation.fetch_add(1) + 1;
+    }
+
+    uint64_t TraceNowMicroseconds() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void TraceInstant(const char* name) {
+        if (!IsTracingEnabled()) return;
+        TraceEvent e;
+        e.name = name;
+        e.phase = 'i';
+        e.threadId = CurrentThreadTraceId();
+        e.activation = currentActivation.load(std::memory_order_relaxed);
+        e.startUs = TraceNowMicroseconds();
+        Append(e);
+    }
+
+    void TraceSpan(const char* name, uint64_t startUs, uint64_t durationUs) {
+        if (!IsTracingEnabled()) return;
+        TraceEvent e;
+        e.name = name;
+        e.phase = 'X';
+        e.threadId = CurrentThreadTraceId();
+        e.activation = currentActivation.load(std::memory_order_relaxed);
+        e.startUs = startUs;
+        e.durationUs = durationUs;
+        Append(e);
+    }
+
+    size_t TraceEventCount() {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        return traceCount;
+    }
+
+    void ClearTrace() {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        traceNext = 0;
+        traceCount = 0;
+    }
+
+    static void AppendJsonString(std::string& out, const char* s) {
+        out += '"';
+        for (; s && *s; ++s) {
+            char c = *s;
+            if (c == '"' || c == '\\') { out += '\\'; out += c; }
+            else if ((unsigned char)c < 0x20) {
+                char esc[8];
+                snprintf(esc, sizeof(esc), "\\u%04x", (unsigned)c);
+                out += esc;
+            }
+            else out += c;
+        }
+        out += '"';
+    }
+
+    std::string ExportChromeTrace() {
+        std::vector<TraceEvent> events;
+        {
+            std::lock_guard<std::mutex> lock(traceMutex);
+            events.reserve(traceCount);
+            size_t start = (traceNext + TRACE_CAPACITY - traceCount) % TRACE_CAPACITY;
+            for (size_t i = 0; i < traceCount; ++i) {
+                events.push_back(traceRing[(start + i) % TRACE_CAPACITY]);
+            }
+        }
+
+        std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        char buf[160];
+        for (size_t i = 0; i < events.size(); ++i) {
+            const TraceEvent& e = events[i];
+            out += "{\"name\":";
+            AppendJsonString(out, e.name);
+            if (e.phase == 'X') {
+                snprintf(buf, sizeof(buf), ",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu",
+                    (unsigned long long)e.startUs, (unsigned long long)e.durationUs);
+            }
+            else {
+                snprintf(buf, sizeof(buf), ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%llu",
+                    (unsigned long long)e.startUs);
+            }
+            out += buf;
+            snprintf(buf, sizeof(buf), ",\"pid\":1,\"tid\":%u,\"args\":{\"activation\":%u}}",
+                e.threadId, e.activation);
+            out += buf;
+            out += (i + 1 < events.size()) ? ",\n" : "\n";
+        }
+        out += "]}\n";
+        return out;
+    }
+
+}
@@ -0,0 +1,57 @@
+// TraceRecorder.h
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace hint_map {
+
+    // One recorded span or instant. Names must be string literals: they are stored
+    // by pointer so recording never allocates.
+    struct TraceEvent {
+        const char* name = nullptr;
+        char phase = 'X';           // 'X' complete span, 'i' instant
+        uint32_t threadId = 0;
+        uint32_t activation = 0;    // S+D+F activation the event belongs to, 0 if none
+        uint64_t startUs = 0;
+        uint64_t durationUs = 0;
+    };
+
+    // Opt-in: while disabled every call below costs one relaxed atomic load.
+    void SetTracingEnabled(bool enabled);
+    bool IsTracingEnabled();
+
+    // Starts a new activation; later events are tagged with its id until the next one.
+    uint32_t BeginTraceActivation();
+
+    void TraceInstant(const char* name);
+    void TraceSpan(const char* name, uint64_t startUs, uint64_t durationUs);
+    uint64_t TraceNowMicroseconds();
+
+    // Events still in the ring; it keeps only the most recent 16384
+    size_t TraceEventCount();
+    void ClearTrace();
+
+    // Chrome trace-event JSON ("traceEvents" array), loadable in chrome://tracing or Perfetto
+    std::string ExportChromeTrace();
+
+    class ScopedTrace {
+    public:
+        explicit ScopedTrace(const char* name)
+            : name(IsTracingEnabled() ? name : nullptr), start(this->name ? TraceNowMicroseconds() : 0) {}
+
+        ~ScopedTrace() {
+            if (name) TraceSpan(name, start, TraceNowMicroseconds() - start);
+        }
+
+        ScopedTrace(const ScopedTrace&) = delete;
+        ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+    private:
+        const char* name;
+        uint64_t start;
+    };
+
+}
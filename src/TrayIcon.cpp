@@ -1,10 +1,25 @@
 #include "TrayIcon.h"
 #include "../resources/resource.h"  // Your icon resource header
 #include <shellapi.h>
+#include <string>
+#include "CursorHalo.h"
+#include "InputHandler.h"
+#include "LatencyStats.h"
+#include "TraceRecorder.h"
+#include "VisionTargets.h"
 
 #define WM_TRAYICON (WM_USER + 1)
 #define ID_TRAY_ICON 1001
 #define ID_MENU_EXIT 2001
+#define ID_MENU_SAVE_INPUT_LOG 2002
+#define ID_MENU_LATENCY_STATS 2003
+#define ID_MENU_DUMP_LATENCY 2004
+#define ID_MENU_TRACING 2005
+#define ID_MENU_EXPORT_TRACE 2006
+#define ID_MENU_VISION 2007
+#define ID_MENU_HALO_GLOW 2008
+#define ID_MENU_HALO_RING 2009
+#define ID_MENU_HALO_PULSE 2010
 
 static NOTIFYICONDATAW g_nid = {};
 static HWND g_hwnd = nullptr;
@@ -73,6 +88,17 @@ void CleanupTrayIcon() {
     UnregisterClass(L"TrayIconHiddenWindow", g_hInst);
 }
 
+void ShowTrayNotification(const wchar_t* title, const wchar_t* text) {
+    if (!g_hwnd) return;
+    // A copy, so a worker thread never writes the shared icon data
+    NOTIFYICONDATAW nid = g_nid;
+    nid.uFlags = NIF_INFO;
+    nid.dwInfoFlags = NIIF_WARNING;
+    wcsncpy_s(nid.szInfoTitle, title, _TRUNCATE);
+    wcsncpy_s(nid.szInfo, text, _TRUNCATE);
+    Shell_NotifyIconW(NIM_MODIFY, &nid);
+}
+
 void ShowContextMenu(HWND hwnd) {
     POINT pt;
     GetCursorPos(&pt);
@@ -80,6 +106,26 @@ void ShowContextMenu(HWND hwnd) {
     HMENU hMenu = CreatePopupMenu();
     if (!hMenu) return;
 
+    InsertMenuW(hMenu, -1, MF_BYPOSITION, ID_MENU_LATENCY_STATS, L"Latency stats");
+    InsertMenuW(hMenu, -1, MF_BYPOSITION, ID_MENU_DUMP_LATENCY, L"Dump latency stats to file");
+    InsertMenuW(hMenu, -1, MF_BYPOSITION | (hint_map::IsVisionFallbackEnabled() ? MF_CHECKED : MF_UNCHECKED),
+        ID_MENU_VISION, L"Detect targets from pixels");
+
+    HMENU haloMenu = CreatePopupMenu();
+    if (haloMenu) {
+        InsertMenuW(haloMenu, -1, MF_BYPOSITION, ID_MENU_HALO_GLOW, L"Glow");
+        InsertMenuW(haloMenu, -1, MF_BYPOSITION, ID_MENU_HALO_RING, L"Ring");
+        InsertMenuW(haloMenu, -1, MF_BYPOSITION, ID_MENU_HALO_PULSE, L"Pulse");
+        CheckMenuRadioItem(haloMenu, ID_MENU_HALO_GLOW, ID_MENU_HALO_PULSE,
+            ID_MENU_HALO_GLOW + (UINT)GetCursorHaloStyle(), MF_BYCOMMAND);
+        // Destroyed with hMenu
+        InsertMenuW(hMenu, -1, MF_BYPOSITION | MF_POPUP, (UINT_PTR)haloMenu, L"Cursor halo");
+    }
+    InsertMenuW(hMenu, -1, MF_BYPOSITION | (hint_map::IsTracingEnabled() ? MF_CHECKED : MF_UNCHECKED),
+        ID_MENU_TRACING, L"Record activation trace");
+    InsertMenuW(hMenu, -1, MF_BYPOSITION, ID_MENU_EXPORT_TRACE, L"Export trace (Chrome JSON)");
+    InsertMenuW(hMenu, -1, MF_BYPOSITION, ID_MENU_SAVE_INPUT_LOG, L"Save input log");
+    InsertMenuW(hMenu, -1, MF_BYPOSITION | MF_SEPARATOR, 0, nullptr);
     InsertMenuW(hMenu, -1, MF_BYPOSITION, ID_MENU_EXIT, L"Exit");
 
     SetForegroundWindow(hwnd);
@@ -87,6 +133,75 @@ void ShowContextMenu(HWND hwnd) {
     DestroyMenu(hMenu);
 }
 
+// The latency histograms plus the cursor halo's last one-second window
+static std::string LatencyReport() {
+    std::string report = hint_map::FormatLatencyReport();
+    const CursorHaloMetrics halo = GetCursorHaloMetrics();
+    char line[160];
+    sprintf_s(line, "\nCursor halo: %.0f wakeups/s, %.0f frames/s, lag %.2f ms avg, %.2f ms max\n",
+        halo.wakeupsPerSecond, halo.framesPerSecond, halo.avgLagMs, halo.maxLagMs);
+    report += line;
+    return report;
+}
+
+static void ShowLatencyStats() {
+    std::string report = LatencyReport();
+    std::wstring text(report.begin(), report.end());
+    MessageBox(nullptr, text.c_str(), L"Latency (microseconds)", MB_OK | MB_ICONINFORMATION);
+}
+
+static void DumpLatencyStatsToTemp() {
+    wchar_t dir[MAX_PATH];
+    if (!GetTempPathW(MAX_PATH, dir)) return;
+    std::wstring path = std::wstring(dir) + L"NavKey-latency.txt";
+
+    std::string report = LatencyReport();
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    DWORD written = 0;
+    if (file == INVALID_HANDLE_VALUE || !WriteFile(file, report.data(), (DWORD)report.size(), &written, nullptr)) {
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        MessageBox(nullptr, L"Failed to write latency stats.", L"Error", MB_OK | MB_ICONERROR);
+        return;
+    }
+    CloseHandle(file);
+
+    std::wstring text = L"Latency stats written to\n" + path;
+    MessageBox(nullptr, text.c_str(), L"Shortcut Project", MB_OK | MB_ICONINFORMATION);
+}
+
+static void ExportTraceToTemp() {
+    wchar_t dir[MAX_PATH];
+    if (!GetTempPathW(MAX_PATH, dir)) return;
+    std::wstring path = std::wstring(dir) + L"NavKey-trace.json";
+
+    std::string json = hint_map::ExportChromeTrace();
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    DWORD written = 0;
+    if (file == INVALID_HANDLE_VALUE || !WriteFile(file, json.data(), (DWORD)json.size(), &written, nullptr)) {
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        MessageBox(nullptr, L"Failed to write the trace.", L"Error", MB_OK | MB_ICONERROR);
+        return;
+    }
+    CloseHandle(file);
+
+    std::wstring text = L"Trace written to\n" + path + L"\n\nOpen it in chrome://tracing or ui.perfetto.dev.";
+    MessageBox(nullptr, text.c_str(), L"Shortcut Project", MB_OK | MB_ICONINFORMATION);
+}
+
+static void SaveInputLogToTemp() {
+    wchar_t dir[MAX_PATH];
+    if (!GetTempPathW(MAX_PATH, dir)) return;
+    std::wstring path = std::wstring(dir) + L"NavKey-input.nklog";
+
+    if (hint_map::SaveInputLog(path.c_str())) {
+        std::wstring text = L"Input log written to\n" + path;
+        MessageBox(nullptr, text.c_str(), L"Shortcut Project", MB_OK | MB_ICONINFORMATION);
+    }
+    else {
+        MessageBox(nullptr, L"Failed to write the input log.", L"Error", MB_OK | MB_ICONERROR);
+    }
+}
+
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
     case WM_TRAYICON:
@@ -98,9 +213,14 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 nullptr,
                 L"Keyboard Shortcuts\n\n"
                 L"S + D + F    Enter hint mode\n"
+                L"S + D + T    Text mode: caret to a word (Shift: extend selection)\n"
                 L"ESC          Exit hint mode\n"
                 L"AZ          Select hint\n"
-                L"G + H        Switch window (Alt+Tab)\n"
+                L"Tab          Walk hints (H J K L, Enter)\n"
+                L"/            Search hints by name\n"
+                L"Shift + B/E/L/I/C  Only buttons/edits/links/items/checks (Shift + A: all)\n"
+                L"Space        Multi-select: labels queue, Enter runs them all\n"
+                L"G + H        Switch window (hints)\n"
                 L"Ctrl        - Toggle Insert Mode\n\n"
                 L"Ctrl shortcuts always pass through",
                 L"Shortcut Project",
@@ -113,6 +233,27 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         if (LOWORD(wParam) == ID_MENU_EXIT) {
             DestroyWindow(hwnd);  // This will trigger WM_DESTROY
         }
+        else if (LOWORD(wParam) == ID_MENU_SAVE_INPUT_LOG) {
+            SaveInputLogToTemp();
+        }
+        else if (LOWORD(wParam) == ID_MENU_LATENCY_STATS) {
+            ShowLatencyStats();
+        }
+        else if (LOWORD(wParam) == ID_MENU_DUMP_LATENCY) {
+            DumpLatencyStatsToTemp();
+        }
+        else if (LOWORD(wParam) == ID_MENU_TRACING) {
+            hint_map::SetTracingEnabled(!hint_map::IsTracingEnabled());
+        }
+        else if (LOWORD(wParam) == ID_MENU_EXPORT_TRACE) {
+            ExportTraceToTemp();
+        }
+        else if (LOWORD(wParam) == ID_MENU_VISION) {
+            hint_map::SetVisionFallbackEnabled(!hint_map::IsVisionFallbackEnabled());
+        }
+        else if (LOWORD(wParam) >= ID_MENU_HALO_GLOW && LOWORD(wParam) <= ID_MENU_HALO_PULSE) {
+            SetCursorHaloStyle((HaloStyle)(LOWORD(wParam) - ID_MENU_HALO_GLOW));
+        }
         break;
 
     case WM_DESTROY:
@@ -3,4 +3,6 @@
 
 void InitTrayIcon(HINSTANCE hInstance);
 void CleanupTrayIcon();
+// Balloon from the tray icon; safe to call from any thread
+void ShowTrayNotification(const wchar_t* title, const wchar_t* text);
 extern bool app_is_running;
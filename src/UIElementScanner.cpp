@@ -1,12 +1,16 @@
 // UIElementScanner.cpp
 
 #include "UIElementScanner.h"
+#include "MonitorCache.h"
+#include "LatencyStats.h"
+#include "TraceRecorder.h"
 #include <Windows.h>
 #include <UIAutomation.h>
 #include <UIAutomationClient.h>
 #include <wrl/client.h>
 #include <comdef.h>
-#include <unordered_set>
+#include <mutex>
+#include <string>
 
 using Microsoft::WRL::ComPtr;
 
@@ -14,18 +18,245 @@ using Microsoft::WRL::ComPtr;
 
 namespace hint_map {
 
-    // a set of control types that are generally not useful for clickable elements
-    static const std::unordered_set<LONG> controlTypesToSkip = {
-        UIA_PaneControlTypeId,
-        UIA_GroupControlTypeId,
-        UIA_TextControlTypeId,
-        UIA_CustomControlTypeId,
-        UIA_DocumentControlTypeId,
-        UIA_ListItemControlTypeId
+    // Built-in profiles, then the user's file on top
+    static ScanProfiles LoadScanProfiles() {
+        ScanProfiles profiles;
+        std::vector<std::string> errors;
+        profiles.Load(BuiltInScanProfiles(), &errors);
+
+        wchar_t path[MAX_PATH];
+        const DWORD length = GetModuleFileNameW(nullptr, path, MAX_PATH);
+        std::wstring file(path, length < MAX_PATH ? length : 0);
+        file = file.substr(0, file.find_last_of(L'\\') + 1) + L"NavKey-profiles.ini";
+
+        HANDLE handle = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle != INVALID_HANDLE_VALUE) {
+            LARGE_INTEGER size = {};
+            std::string text;
+            DWORD read = 0;
+            if (GetFileSizeEx(handle, &size) && size.QuadPart < (1 << 20)) {
+                text.resize((size_t)size.QuadPart);
+                if (!ReadFile(handle, &text[0], (DWORD)text.size(), &read, nullptr)) read = 0;
+                text.resize(read);
+            }
+            CloseHandle(handle);
+            profiles.Load(text, &errors);
+        }
+
+        for (const std::string& error : errors) {
+            OutputDebugStringA(("[hint_map] NavKey-profiles.ini " + error + "\n").c_str());
+        }
+        wchar_t buf[80];
+        swprintf_s(buf, L"[hint_map] %zu scan profiles loaded.\n", profiles.Count());
+        OutputDebugString(buf);
+        return profiles;
+    }
+
+    // Naming the exe takes an OpenProcess, and activation, every rescan and the scroll
+    // engine's thread all ask, so the last few windows are remembered. A handle reused by
+    // another process fails the pid check.
+    struct ProfileCacheEntry {
+        HWND window;
+        DWORD pid;
+        const CompiledScanProfile* profile;
     };
+    static const int PROFILE_CACHE_SIZE = 8;
+    static std::mutex profileCacheMutex;
+    static ProfileCacheEntry profileCache[PROFILE_CACHE_SIZE] = {};
+    static int profileCacheNext = 0;
+
+    const CompiledScanProfile& ScanProfileFor(HWND window) {
+        static const ScanProfiles profiles = LoadScanProfiles();
+
+        DWORD pid = 0;
+        if (window) GetWindowThreadProcessId(window, &pid);
+        if (!pid) return profiles.Default();
+        {
+            std::lock_guard<std::mutex> lock(profileCacheMutex);
+            for (const ProfileCacheEntry& entry : profileCache) {
+                if (entry.window == window && entry.pid == pid) return *entry.profile;
+            }
+        }
+
+        std::wstring exe;
+        HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+        if (process) {
+            wchar_t path[MAX_PATH];
+            DWORD size = MAX_PATH;
+            if (QueryFullProcessImageNameW(process, 0, path, &size)) {
+                const wchar_t* slash = wcsrchr(path, L'\\');
+                exe = slash ? slash + 1 : path;
+            }
+            CloseHandle(process);
+        }
+        const CompiledScanProfile& profile = profiles.ForProcess(exe);
 
+        std::lock_guard<std::mutex> lock(profileCacheMutex);
+        profileCache[profileCacheNext] = { window, pid, &profile };
+        profileCacheNext = (profileCacheNext + 1) % PROFILE_CACHE_SIZE;
+        return profile;
+    }
+
+    static TreeScope ToTreeScope(ScanScope scope) {
+        switch (scope) {
+        case ScanScope::CHILDREN: return TreeScope_Children;
+        case ScanScope::SUBTREE:  return TreeScope_Subtree;
+        default:                  return TreeScope_Descendants;
+        }
+    }
+
+    static ComPtr<IUIAutomationCondition> AnyOf(IUIAutomation* automation, const std::vector<ComPtr<IUIAutomationCondition>>& conditions) {
+        ComPtr<IUIAutomationCondition> any;
+        if (conditions.size() == 1) return conditions.front();
+        std::vector<IUIAutomationCondition*> raw;
+        for (const auto& c : conditions) {
+            if (c) raw.push_back(c.Get());
+        }
+        if (!raw.empty()) automation->CreateOrConditionFromNativeArray(raw.data(), (int)raw.size(), &any);
+        return any;
+    }
 
     std::vector<HintTarget> GetClickableElements() {
+        return GetClickableElements(GetForegroundWindow());
+    }
+
+    // VT_I4 | VT_ARRAY property value to ints
+    static void ReadIntArray(const VARIANT& value, std::vector<int>& out) {
+        out.clear();
+        if (value.vt != (VT_I4 | VT_ARRAY) || !value.parray) return;
+        LONG lower = 0, upper = -1;
+        SafeArrayGetLBound(value.parray, 1, &lower);
+        SafeArrayGetUBound(value.parray, 1, &upper);
+        int* data = nullptr;
+        if (upper < lower || FAILED(SafeArrayAccessData(value.parray, (void**)&data))) return;
+        out.assign(data, data + (upper - lower + 1));
+        SafeArrayUnaccessData(value.parray);
+    }
+
+    // Elements that take a click and are on screen, with what a HintTarget needs cached
+    static bool CreateScanQuery(IUIAutomation* automation, const CompiledScanProfile& profile,
+        ComPtr<IUIAutomationCondition>& finalCond, ComPtr<IUIAutomationCacheRequest>& cacheRequest) {
+        // Filter to elements that are:
+        // - one of the profile's tests: InvokePatternAvailable, SelectionItemPatternAvailable, Keyboard focusable
+        // - NOT offscreen
+        // - NOT of a skipped control type (items are sorted out after the scan)
+        std::vector<ComPtr<IUIAutomationCondition>> tests;
+        const struct { uint32_t flag; PROPERTYID property; } matches[] = {
+            { MATCH_INVOKE, UIA_IsInvokePatternAvailablePropertyId },
+            { MATCH_SELECTION_ITEM, UIA_IsSelectionItemPatternAvailablePropertyId },
+            { MATCH_KEYBOARD_FOCUSABLE, UIA_IsKeyboardFocusablePropertyId },
+        };
+        for (const auto& m : matches) {
+            if (!(profile.match & m.flag)) continue;
+            ComPtr<IUIAutomationCondition> cond;
+            automation->CreatePropertyCondition(m.property, _variant_t(true), &cond);
+            tests.push_back(cond);
+        }
+        ComPtr<IUIAutomationCondition> clickableCond = AnyOf(automation, tests);
+
+        ComPtr<IUIAutomationCondition> offscreenFalseCond;
+        automation->CreatePropertyCondition(UIA_IsOffscreenPropertyId, _variant_t(false), &offscreenFalseCond);
+
+        ComPtr<IUIAutomationCondition> shownCond;
+        automation->CreateAndCondition(clickableCond.Get(), offscreenFalseCond.Get(), &shownCond);
+
+        // Skipped types are left in the provider rather than marshalled over and dropped
+        std::vector<ComPtr<IUIAutomationCondition>> skipped;
+        for (int slot = 0; slot < TargetBuckets::TYPE_COUNT; ++slot) {
+            const int type = TargetBuckets::FIRST_TYPE + slot;
+            if (profile.Keeps(type) || profile.MayBeItem(type)) continue;
+            ComPtr<IUIAutomationCondition> cond;
+            automation->CreatePropertyCondition(UIA_ControlTypePropertyId, _variant_t((long)type), &cond);
+            skipped.push_back(cond);
+        }
+        ComPtr<IUIAutomationCondition> notSkippedCond;
+        if (!skipped.empty()) {
+            ComPtr<IUIAutomationCondition> skippedCond = AnyOf(automation, skipped);
+            if (skippedCond) automation->CreateNotCondition(skippedCond.Get(), &notSkippedCond);
+        }
+
+        if (notSkippedCond) automation->CreateAndCondition(shownCond.Get(), notSkippedCond.Get(), &finalCond);
+        else finalCond = shownCond;
+
+        HRESULT hr = automation->CreateCacheRequest(&cacheRequest);
+        if (FAILED(hr) || !cacheRequest || !finalCond) {
+            OutputDebugStringW(L"[hint_map] CreateCacheRequest failed\n");
+            return false;
+        }
+
+        // Add properties you want cached:
+        cacheRequest->AddProperty(UIA_BoundingRectanglePropertyId);
+        cacheRequest->AddProperty(UIA_ControlTypePropertyId);
+        cacheRequest->AddProperty(UIA_IsOffscreenPropertyId);
+        if (profile.cache & CACHE_NAME) cacheRequest->AddProperty(UIA_NamePropertyId);
+        if (profile.cache & CACHE_AUTOMATION_ID) cacheRequest->AddProperty(UIA_AutomationIdPropertyId);
+        cacheRequest->AddProperty(UIA_RuntimeIdPropertyId);
+        cacheRequest->AddProperty(UIA_IsSelectionItemPatternAvailablePropertyId);
+        return true;
+    }
+
+    // Items of list views, grids and trees: they can be selected, unlike the list items web
+    // pages expose for every <li>. Rows of a wide grid may be any width.
+    static bool IsContainerItem(IUIAutomationElement* element, int controlType, const CompiledScanProfile& profile) {
+        if (!profile.MayBeItem(controlType)) return false;
+        VARIANT selectable;
+        VariantInit(&selectable);
+        const bool item = SUCCEEDED(element->GetCachedPropertyValue(UIA_IsSelectionItemPatternAvailablePropertyId, &selectable)) &&
+            selectable.vt == VT_BOOL && selectable.boolVal == VARIANT_TRUE;
+        VariantClear(&selectable);
+        return item;
+    }
+
+    // Appends the elements of found inside clip that are worth a hint
+    static void CollectTargets(IUIAutomationElementArray* found, const RECT& clip, const CompiledScanProfile& profile,
+        std::vector<HintTarget>& targets) {
+        int length = 0;
+        found->get_Length(&length);
+
+        for (int i = 0; i < length; ++i) {
+            ComPtr<IUIAutomationElement> element;
+            if (FAILED(found->GetElement(i, &element)) || !element) continue;
+
+            RECT r{};
+            if (FAILED(element->get_CachedBoundingRectangle(&r))) continue;
+            RECT intersect;
+            if (!IntersectRect(&intersect, &clip, &r)) continue;
+
+            int controlType = 0;
+            if (FAILED(element->get_CachedControlType(&controlType))) continue;
+            const bool item = IsContainerItem(element.Get(), controlType, profile);
+            if (!item && !profile.Keeps(controlType)) continue;
+            if (!profile.FitsSize(r.right - r.left, r.bottom - r.top, item)) continue;
+
+            HintTarget target;
+            // Wide rows keep only their visible part, so the label lands on screen
+            target.rect = item ? intersect : r;
+            target.element = element;
+            target.controlTypeId = controlType;
+
+            BSTR text = nullptr;
+            if ((profile.cache & CACHE_NAME) && SUCCEEDED(element->get_CachedName(&text)) && text) {
+                target.name.assign(text, SysStringLen(text));
+                SysFreeString(text);
+            }
+            text = nullptr;
+            if ((profile.cache & CACHE_AUTOMATION_ID) && SUCCEEDED(element->get_CachedAutomationId(&text)) && text) {
+                target.automationId.assign(text, SysStringLen(text));
+                SysFreeString(text);
+            }
+            VARIANT runtimeId;
+            VariantInit(&runtimeId);
+            if (SUCCEEDED(element->GetCachedPropertyValue(UIA_RuntimeIdPropertyId, &runtimeId))) {
+                ReadIntArray(runtimeId, target.runtimeId);
+            }
+            VariantClear(&runtimeId);
+            targets.push_back(target);
+        }
+    }
+
+    std::vector<HintTarget> GetClickableElements(HWND window, ScanStageTimes* stages) {
+        ScopedLatencyTimer timer(LatencyMetric::ScanElements);
+        const uint64_t setupStart = TraceNowMicroseconds();
         std::vector<HintTarget> targets;
 
         // Initialize COM as multithreaded (MTA is generally safe for UIAutomation client usage here)
@@ -45,7 +276,7 @@ namespace hint_map {
 
         // Get the root element: try foreground window first, fallback to root
         Microsoft::WRL::ComPtr<IUIAutomationElement> root;
-        HWND foregroundHwnd = GetForegroundWindow();
+        HWND foregroundHwnd = window;
         if (foregroundHwnd) {
             hr = automation->ElementFromHandle(foregroundHwnd, &root);
             if (FAILED(hr) || !root) {
@@ -57,6 +288,13 @@ namespace hint_map {
         RECT foregroundRect;
         GetWindowRect(foregroundHwnd, &foregroundRect);
 
+        // Nothing outside the virtual screen can be labelled
+        const Rect& screen = CurrentMonitorTopology().VirtualScreen();
+        if (!screen.Empty()) {
+            RECT screenRect = { screen.left, screen.top, screen.right, screen.bottom };
+            IntersectRect(&foregroundRect, &foregroundRect, &screenRect);
+        }
+
 
         if (!root) {
             hr = automation->GetRootElement(&root);
@@ -67,62 +305,24 @@ namespace hint_map {
             }
         }
 
-        // Build clickable condition: InvokePatternAvailable OR LegacyIAccessibleAvailable OR KeyboardFocusable
-        //ComPtr<IUIAutomationCondition> invokeCond;
-        //automation->CreatePropertyCondition(UIA_IsInvokePatternAvailablePropertyId, _variant_t(true), &invokeCond);
-
-        //ComPtr<IUIAutomationCondition> focusableCond;
-        //automation->CreatePropertyCondition(UIA_IsKeyboardFocusablePropertyId, _variant_t(true), &focusableCond);
-
-        //// Combine
-        //ComPtr<IUIAutomationCondition> clickableCond;
-        //automation->CreateOrCondition(invokeCond.Get(), focusableCond.Get(), &clickableCond);
-
-        //// Add IsOffscreen == false
-        //ComPtr<IUIAutomationCondition> offscreenFalseCond;
-        //automation->CreatePropertyCondition(UIA_IsOffscreenPropertyId, _variant_t(false), &offscreenFalseCond);
-
-        //// Final combined condition
-        //ComPtr<IUIAutomationCondition> finalCond;
-        //automation->CreateAndCondition(clickableCond.Get(), offscreenFalseCond.Get(), &finalCond); 
-        // Filter to elements that are:
-   // - InvokePatternAvailable OR SelectionItemPatternAvailable
-   // - NOT offscreen
-   // - Keyboard focusable
-
-        ComPtr<IUIAutomationCondition> invokeCond, focusableCond, selectCond;
-        automation->CreatePropertyCondition(UIA_IsInvokePatternAvailablePropertyId, _variant_t(true), &invokeCond);
-        automation->CreatePropertyCondition(UIA_IsKeyboardFocusablePropertyId, _variant_t(true), &focusableCond);
-        automation->CreatePropertyCondition(UIA_IsSelectionItemPatternAvailablePropertyId, _variant_t(true), &selectCond);
-
-        ComPtr<IUIAutomationCondition> interactionCond;
-        automation->CreateOrCondition(invokeCond.Get(), selectCond.Get(), &interactionCond);
-
-        ComPtr<IUIAutomationCondition> clickableCond;
-        automation->CreateOrCondition(interactionCond.Get(), focusableCond.Get(), &clickableCond);
-
-        ComPtr<IUIAutomationCondition> offscreenFalseCond;
-        automation->CreatePropertyCondition(UIA_IsOffscreenPropertyId, _variant_t(false), &offscreenFalseCond);
-
+        const CompiledScanProfile& profile = ScanProfileFor(foregroundHwnd);
         ComPtr<IUIAutomationCondition> finalCond;
-        automation->CreateAndCondition(clickableCond.Get(), offscreenFalseCond.Get(), &finalCond);
-
         ComPtr<IUIAutomationCacheRequest> cacheRequest;
-        hr = automation->CreateCacheRequest(&cacheRequest);
-        if (FAILED(hr) || !cacheRequest) {
-            OutputDebugStringW(L"[hint_map] CreateCacheRequest failed\n");
+        if (!CreateScanQuery(automation.Get(), profile, finalCond, cacheRequest)) {
             CoUninitialize();
             return targets;
         }
 
-        // Add properties you want cached:
-        cacheRequest->AddProperty(UIA_BoundingRectanglePropertyId);
-        cacheRequest->AddProperty(UIA_ControlTypePropertyId);
-        cacheRequest->AddProperty(UIA_IsOffscreenPropertyId);
+        const uint64_t findStart = TraceNowMicroseconds();
+        TraceSpan("Scan setup", setupStart, findStart - setupStart);
+        if (stages) stages->setupUs = findStart - setupStart;
 
         // Query matching elements in subtree
         Microsoft::WRL::ComPtr<IUIAutomationElementArray> found;
-        hr = root->FindAllBuildCache(TreeScope_Descendants, finalCond.Get(), cacheRequest.Get(), &found);
+        hr = root->FindAllBuildCache(ToTreeScope(profile.scope), finalCond.Get(), cacheRequest.Get(), &found);
+        const uint64_t filterStart = TraceNowMicroseconds();
+        TraceSpan("FindAllBuildCache", findStart, filterStart - findStart);
+        if (stages) stages->findUs = filterStart - findStart;
         if (FAILED(hr) || !found) {
             OutputDebugStringW(L"[hint_map] FindAllBuildCache failed\n");
             CoUninitialize();
@@ -133,80 +333,83 @@ namespace hint_map {
         found->get_Length(&length);
 
         wchar_t buf[100];
-        swprintf(buf, 100, L"[hint_map] Elements found: %d\n", length);
+        swprintf(buf, 100, L"[hint_map] Elements found: %d (profile %hs)\n", length, profile.name.c_str());
         OutputDebugStringW(buf);
 
-        for (int i = 0; i < length; ++i) {
-            ComPtr<IUIAutomationElement> element;
-            if (FAILED(found->GetElement(i, &element)) || !element) continue;
-
-            RECT r{};
-            if (SUCCEEDED(element->get_CachedBoundingRectangle(&r))) {
-                OutputDebugString(L"Got cached bounding Rectangle");
-                RECT intersect;
-                if (!IntersectRect(&intersect, &foregroundRect, &r)) continue;
-
-                LONG width = r.right - r.left;
-                LONG height = r.bottom - r.top;
-
-                if (width > 5 && height > 5 && width < 1000 && height < 1000) {
-                    int controlType = 0;
-                    if (SUCCEEDED(element->get_CachedControlType(&controlType))) {
-                        OutputDebugString(L"Code found a cached control type");
-                        if (controlTypesToSkip.count(controlType)) continue;
-
-                        HintTarget target;
-                        target.rect = r;
-                        target.element = element;
-                        target.controlTypeId = controlType;
-                        targets.push_back(target);
-                        //int length = 0;
-                        //found->get_Length(&length);
-                        //for (int i = 0; i < length; ++i) {
-
-                        //    Microsoft::WRL::ComPtr<IUIAutomationElement> element;
-                        //    if (FAILED(found->GetElement(i, &element)) || !element) continue;
-
-                        //    BOOL isOffscreen = TRUE;
-                        //    element->get_CurrentIsOffscreen(&isOffscreen);
-                        //    if (isOffscreen) continue;
-
-                        //    RECT r{};
-                        //    if (SUCCEEDED(element->get_CurrentBoundingRectangle(&r))) {
+        CollectTargets(found.Get(), foregroundRect, profile, targets);
+        const uint64_t filterEnd = TraceNowMicroseconds();
+        TraceSpan("Filter elements", filterStart, filterEnd - filterStart);
+        if (stages) stages->filterUs = filterEnd - filterStart;
 
-                        //        // FILTER: Only elements inside the active window
-                        //        RECT intersect;
-                        //        if (!IntersectRect(&intersect, &foregroundRect, &r)) continue;
-
-                        //        LONG width = r.right - r.left;
-                        //        LONG height = r.bottom - r.top;
+        CoUninitialize();
+        return targets;
+    }
 
-                        //        if (width > 5 && height > 5 &&
-                        //            width < 1000 && height < 1000){
+    static bool HasPattern(IUIAutomationElement* element, PROPERTYID availableProperty) {
+        VARIANT value;
+        VariantInit(&value);
+        const bool has = SUCCEEDED(element->GetCurrentPropertyValue(availableProperty, &value)) &&
+            value.vt == VT_BOOL && value.boolVal == VARIANT_TRUE;
+        VariantClear(&value);
+        return has;
+    }
 
-                        //            
-                        //            int controlType = 0;
-                        //            element->get_CurrentControlType(&controlType);
+    // Nearest ancestor (or self) that holds items and scrolls them
+    static ComPtr<IUIAutomationElement> FindItemContainer(IUIAutomationTreeWalker* walker, ComPtr<IUIAutomationElement> element) {
+        for (int depth = 0; element && depth < 12; ++depth) {
+            if (HasPattern(element.Get(), UIA_IsItemContainerPatternAvailablePropertyId) ||
+                HasPattern(element.Get(), UIA_IsScrollPatternAvailablePropertyId)) return element;
+            ComPtr<IUIAutomationElement> parent;
+            if (FAILED(walker->GetParentElement(element.Get(), &parent))) break;
+            element = parent;
+        }
+        return nullptr;
+    }
 
-                        //            // Skip certain generic or noisy control types
-                        //            if (controlTypesToSkip.count(controlType)) {
-                        //                continue;  // don't add this element
-                        //            }
+    bool GetContainerItemsAt(POINT pt, std::vector<HintTarget>& items, RECT& viewport) {
+        ScopedTrace trace("Container scan");
+        items.clear();
 
-                        //            HintTarget target;
-                        //            target.rect = r;
-                        //            target.element = element;
-                        //            target.controlTypeId = controlType; // Store control type
-                        //            targets.push_back(target);
+        HRESULT hr = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+        if (FAILED(hr)) {
+            OutputDebugStringW(L"[hint_map] CoInitializeEx failed in GetContainerItemsAt\n");
+            return false;
+        }
 
+        bool found = false;
+        {
+            const CompiledScanProfile& profile = ScanProfileFor(GetAncestor(WindowFromPoint(pt), GA_ROOT));
+            ComPtr<IUIAutomation> automation;
+            ComPtr<IUIAutomationElement> hit;
+            ComPtr<IUIAutomationTreeWalker> walker;
+            ComPtr<IUIAutomationCondition> condition;
+            ComPtr<IUIAutomationCacheRequest> cacheRequest;
+            if (SUCCEEDED(CoCreateInstance(__uuidof(CUIAutomation), NULL, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&automation))) &&
+                automation && SUCCEEDED(automation->ElementFromPoint(pt, &hit)) && hit &&
+                SUCCEEDED(automation->get_ControlViewWalker(&walker)) && walker &&
+                CreateScanQuery(automation.Get(), profile, condition, cacheRequest)) {
+
+                ComPtr<IUIAutomationElement> container = FindItemContainer(walker.Get(), hit);
+                if (container && SUCCEEDED(container->get_CurrentBoundingRectangle(&viewport))) {
+                    const Rect& screen = CurrentMonitorTopology().VirtualScreen();
+                    if (!screen.Empty()) {
+                        RECT screenRect = { screen.left, screen.top, screen.right, screen.bottom };
+                        IntersectRect(&viewport, &viewport, &screenRect);
+                    }
 
+                    // Only realized items are in the tree; virtualized ones come and go as it scrolls
+                    ComPtr<IUIAutomationElementArray> realized;
+                    hr = container->FindAllBuildCache(TreeScope_Descendants, condition.Get(), cacheRequest.Get(), &realized);
+                    if (SUCCEEDED(hr) && realized) {
+                        CollectTargets(realized.Get(), viewport, profile, items);
+                        found = true;
                     }
                 }
             }
         }
 
         CoUninitialize();
-        return targets;
+        return found;
     }
 
 }
@@ -3,8 +3,10 @@
 
 #include <Windows.h>
 #include <vector>
+#include <string>
 #include <UIAutomation.h>
 #include <wrl/client.h>
+#include "ScanProfile.h"
 
 namespace hint_map {
 
@@ -12,8 +14,30 @@ namespace hint_map {
         RECT rect;
         Microsoft::WRL::ComPtr<IUIAutomationElement> element;
         int controlTypeId = 0; // <-- Add this line
+        HWND hwnd = nullptr;   // set for window-switch targets: activate instead of invoking
+        std::wstring name;          // cached UIA Name, for search mode
+        std::wstring automationId;
+        std::vector<int> runtimeId; // UIA runtime id; identifies the element across processes
     };
 
+    // How long the stages of one scan took; the scan worker sends these back for the trace
+    struct ScanStageTimes {
+        uint64_t setupUs = 0;       // COM, root element, query
+        uint64_t findUs = 0;        // FindAllBuildCache
+        uint64_t filterUs = 0;      // CollectTargets
+    };
+
+    // Clickable elements of the foreground window
     std::vector<HintTarget> GetClickableElements();
+    std::vector<HintTarget> GetClickableElements(HWND window, ScanStageTimes* stages = nullptr);
+
+    // Realized items of the scrollable container (list view, grid, tree) under pt, for
+    // relabelling just that container after it scrolls. False if pt isn't over one;
+    // viewport is the container's on-screen rect.
+    bool GetContainerItemsAt(POINT pt, std::vector<HintTarget>& items, RECT& viewport);
+
+    // Scan profile for the process that owns window: the built-in profiles, overridden by
+    // NavKey-profiles.ini next to the exe, loaded on first use
+    const CompiledScanProfile& ScanProfileFor(HWND window);
 
 }
@@ -0,0 +1,108 @@
+// VisionTargets.cpp
+
+#include "VisionTargets.h"
+#include <atomic>
+#include "RegionDetector.h"
+#include "MonitorCache.h"
+#include "TraceRecorder.h"
+
+namespace hint_map {
+
+    static std::atomic<bool> visionEnabled{ false };
+
+    void SetVisionFallbackEnabled(bool enabled) {
+        visionEnabled.store(enabled);
+    }
+
+    bool IsVisionFallbackEnabled() {
+        return visionEnabled.load();
+    }
+
+    // Screen pixels of the window's visible area as top-down BGRA; the overlay is not up yet,
+    // so this is what the user sees
+    static bool CaptureScreenRect(const Rect& area, std::vector<uint8_t>& pixels) {
+        ScopedTrace trace("Capture window");
+
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = area.Width();
+        bmi.bmiHeader.biHeight = -area.Height();   // top-down
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        HDC screen = GetDC(nullptr);
+        if (!screen) return false;
+        HDC memDC = CreateCompatibleDC(screen);
+        void* bits = nullptr;
+        HBITMAP dib = CreateDIBSection(screen, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+
+        bool ok = false;
+        if (memDC && dib && bits) {
+            HGDIOBJ old = SelectObject(memDC, dib);
+            ok = BitBlt(memDC, 0, 0, area.Width(), area.Height(), screen, area.left, area.top, SRCCOPY) != FALSE;
+            SelectObject(memDC, old);
+            GdiFlush();
+            if (ok) {
+                const uint8_t* src = (const uint8_t*)bits;
+                pixels.assign(src, src + (size_t)area.Width() * area.Height() * 4);
+            }
+        }
+
+        if (dib) DeleteObject(dib);
+        if (memDC) DeleteDC(memDC);
+        ReleaseDC(nullptr, screen);
+        return ok;
+    }
+
+    // True if most of r is already covered by one of the UIA targets
+    static bool OverlapsExisting(const Rect& r, const std::vector<HintTarget>& existing) {
+        const long long area = (long long)r.Width() * r.Height();
+        for (const auto& t : existing) {
+            Rect o = Intersection(r, MakeRect(t.rect.left, t.rect.top, t.rect.right, t.rect.bottom));
+            if (!o.Empty() && (long long)o.Width() * o.Height() * 2 >= area) return true;
+        }
+        return false;
+    }
+
+    std::vector<HintTarget> DetectVisualTargets(HWND hwnd, const std::vector<HintTarget>& existing) {
+        std::vector<HintTarget> targets;
+        RECT wr;
+        if (!hwnd || IsIconic(hwnd) || !GetWindowRect(hwnd, &wr)) return targets;
+
+        const Rect area = Intersection(MakeRect(wr.left, wr.top, wr.right, wr.bottom), CurrentMonitorTopology().VirtualScreen());
+        if (area.Empty()) return targets;
+
+        std::vector<uint8_t> pixels;
+        if (!CaptureScreenRect(area, pixels)) {
+            OutputDebugString(L"[hint_map] Vision capture failed.\n");
+            return targets;
+        }
+
+        std::vector<Rect> regions;
+        {
+            ScopedTrace trace("Detect regions");
+            ImageView image;
+            image.pixels = pixels.data();
+            image.width = area.Width();
+            image.height = area.Height();
+            image.stride = area.Width() * 4;
+            regions = DetectRegions(image);
+        }
+
+        for (const Rect& region : regions) {
+            Rect r = MakeRect(region.left + area.left, region.top + area.top, region.right + area.left, region.bottom + area.top);
+            if (OverlapsExisting(r, existing)) continue;
+
+            HintTarget target;
+            target.rect = { r.left, r.top, r.right, r.bottom };
+            targets.push_back(target);
+        }
+
+        wchar_t buf[96];
+        swprintf_s(buf, L"[hint_map] Vision: %zu regions, %zu new targets.\n", regions.size(), targets.size());
+        OutputDebugString(buf);
+        return targets;
+    }
+
+}
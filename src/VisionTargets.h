@@ -0,0 +1,19 @@
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include "UIElementScanner.h"
+
+namespace hint_map {
+
+    // Hint targets found by looking at the pixels of a window rather than its UIA tree:
+    // buttons, icons and text drawn by apps with no (or a poor) accessibility tree. The
+    // returned targets have no element; activating one clicks its centre. Rects that
+    // overlap an existing target are dropped, so the result can be appended to a scan.
+    std::vector<HintTarget> DetectVisualTargets(HWND hwnd, const std::vector<HintTarget>& existing);
+
+    // Off by default: a capture costs far more than a UIA scan of a well-behaved app
+    void SetVisionFallbackEnabled(bool enabled);
+    bool IsVisionFallbackEnabled();
+
+}
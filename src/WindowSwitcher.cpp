@@ -0,0 +1,214 @@
+// WindowSwitcher.cpp
+
+#include "WindowSwitcher.h"
+#include <dwmapi.h>
+#include <algorithm>
+#pragma comment(lib, "Dwmapi.lib")
+
+#ifndef EVENT_OBJECT_CLOAKED
+#define EVENT_OBJECT_CLOAKED 0x8017
+#define EVENT_OBJECT_UNCLOAKED 0x8018
+#endif
+
+namespace hint_map {
+
+    struct TrackedWindow {
+        HWND hwnd;
+        bool eligible;
+    };
+
+    // Most recently activated first. UI thread only.
+    static std::vector<TrackedWindow> windows;
+    static std::vector<HWINEVENTHOOK> eventHooks;
+
+    static bool IsCloaked(HWND hwnd) {
+        DWORD cloaked = 0;
+        return SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) && cloaked != 0;
+    }
+
+    // Same rules the shell uses for Alt+Tab: visible, unowned or app windows, no tool
+    // windows. Cloaked windows (other virtual desktops, suspended UWP frames) are skipped.
+    static bool IsSwitchable(HWND hwnd) {
+        if (!IsWindow(hwnd) || !IsWindowVisible(hwnd)) return false;
+
+        DWORD pid = 0;
+        GetWindowThreadProcessId(hwnd, &pid);
+        if (pid == GetCurrentProcessId()) return false;   // our own overlay and sink windows
+
+        const LONG_PTR exStyle = GetWindowLongPtr(hwnd, GWL_EXSTYLE);
+        if (exStyle & WS_EX_NOACTIVATE) return false;
+        if (!(exStyle & WS_EX_APPWINDOW)) {
+            if (exStyle & WS_EX_TOOLWINDOW) return false;
+            if (GetWindow(hwnd, GW_OWNER) != nullptr) return false;
+        }
+        return !IsCloaked(hwnd);
+    }
+
+    static std::vector<TrackedWindow>::iterator FindWindowEntry(HWND hwnd) {
+        return std::find_if(windows.begin(), windows.end(),
+            [hwnd](const TrackedWindow& w) { return w.hwnd == hwnd; });
+    }
+
+    static void TouchMruEntry(HWND hwnd, bool activated) {
+        auto it = FindWindowEntry(hwnd);
+        const bool eligible = IsSwitchable(hwnd);
+
+        if (it == windows.end()) {
+            if (!IsWindow(hwnd)) return;
+            TrackedWindow entry = { hwnd, eligible };
+            if (activated) windows.insert(windows.begin(), entry);
+            else windows.push_back(entry);
+            return;
+        }
+
+        it->eligible = eligible;
+        if (activated && it != windows.begin()) {
+            // Move to the front, keeping everyone else's order
+            std::rotate(windows.begin(), it, it + 1);
+        }
+    }
+
+    static void CALLBACK WinEventProc(HWINEVENTHOOK, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD, DWORD) {
+        if (!hwnd || idObject != OBJID_WINDOW || idChild != CHILDID_SELF) return;
+
+        if (event == EVENT_OBJECT_DESTROY) {
+            auto it = FindWindowEntry(hwnd);
+            if (it != windows.end()) windows.erase(it);
+            return;
+        }
+
+        // Only top-level windows matter; child create/show events are the bulk of the traffic
+        if (GetAncestor(hwnd, GA_ROOT) != hwnd) return;
+
+        TouchMruEntry(hwnd, event == EVENT_SYSTEM_FOREGROUND);
+    }
+
+    static BOOL CALLBACK SeedWindow(HWND hwnd, LPARAM) {
+        // EnumWindows walks in z-order, which is the best MRU guess at startup
+        windows.push_back({ hwnd, IsSwitchable(hwnd) });
+        return TRUE;
+    }
+
+    void InitWindowSwitcher() {
+        if (!eventHooks.empty()) return;
+
+        windows.clear();
+        EnumWindows(SeedWindow, 0);
+
+        const DWORD flags = WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS;
+        const DWORD ranges[][2] = {
+            { EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND },
+            { EVENT_OBJECT_CREATE, EVENT_OBJECT_HIDE },         // create, destroy, show, hide
+            { EVENT_OBJECT_CLOAKED, EVENT_OBJECT_UNCLOAKED },
+        };
+        for (const auto& range : ranges) {
+            HWINEVENTHOOK hook = SetWinEventHook(range[0], range[1], nullptr, WinEventProc, 0, 0, flags);
+            if (hook) eventHooks.push_back(hook);
+            else OutputDebugString(L"[hint_map] SetWinEventHook failed for window switcher.\n");
+        }
+    }
+
+    void ShutdownWindowSwitcher() {
+        for (HWINEVENTHOOK hook : eventHooks) UnhookWinEvent(hook);
+        eventHooks.clear();
+        windows.clear();
+    }
+
+    std::vector<HWND> SwitchableWindows() {
+        std::vector<HWND> result;
+        for (const TrackedWindow& w : windows) {
+            if (w.eligible && IsWindow(w.hwnd)) result.push_back(w.hwnd);
+        }
+        return result;
+    }
+
+    static const LONG ANCHOR_WIDTH = 80;
+    static const LONG ANCHOR_HEIGHT = 32;
+    static const LONG ANCHOR_GAP = 4;
+
+    // Where a minimized window will be restored, in screen coordinates
+    static bool RestoredRect(HWND hwnd, RECT* r) {
+        WINDOWPLACEMENT placement = { sizeof(placement) };
+        if (!GetWindowPlacement(hwnd, &placement)) return false;
+        *r = placement.rcNormalPosition;
+
+        // Placement rects are in workspace coordinates (relative to the work area, so a
+        // top or left taskbar shifts them) except for tool windows
+        if (GetWindowLongPtr(hwnd, GWL_EXSTYLE) & WS_EX_TOOLWINDOW) return true;
+        MONITORINFO info = { sizeof(info) };
+        if (GetMonitorInfo(MonitorFromRect(r, MONITOR_DEFAULTTOPRIMARY), &info)) {
+            OffsetRect(r, info.rcWork.left - info.rcMonitor.left, info.rcWork.top - info.rcMonitor.top);
+        }
+        return true;
+    }
+
+    static bool OverlapsAny(const RECT& rect, const std::vector<HintTarget>& targets) {
+        RECT overlap;
+        for (const HintTarget& t : targets) {
+            if (IntersectRect(&overlap, &rect, &t.rect)) return true;
+        }
+        return false;
+    }
+
+    std::vector<HintTarget> GetWindowTargets() {
+        std::vector<HintTarget> targets;
+        for (HWND hwnd : SwitchableWindows()) {
+            RECT r;
+            if (IsIconic(hwnd)) {
+                // Minimized windows sit at -32000; label them where they will be restored
+                if (!RestoredRect(hwnd, &r)) continue;
+            }
+            else if (FAILED(DwmGetWindowAttribute(hwnd, DWMWA_EXTENDED_FRAME_BOUNDS, &r, sizeof(r)))) {
+                if (!GetWindowRect(hwnd, &r)) continue;
+            }
+
+            // A small anchor in the title area; whole-window rects would all overlap.
+            // Maximized and stacked windows share a title area, so anchors that would
+            // collide go down a column under the first one, in MRU order, starting a new
+            // column to the right when one reaches the bottom of the work area.
+            MONITORINFO info = { sizeof(info) };
+            GetMonitorInfo(MonitorFromRect(&r, MONITOR_DEFAULTTONEAREST), &info);
+            const LONG cx = (r.left + r.right) / 2;
+            RECT anchor = { cx - ANCHOR_WIDTH / 2, r.top, cx + ANCHOR_WIDTH / 2, r.top + ANCHOR_HEIGHT };
+            while (OverlapsAny(anchor, targets)) {
+                OffsetRect(&anchor, 0, ANCHOR_HEIGHT + ANCHOR_GAP);
+                if (anchor.bottom > info.rcWork.bottom && anchor.top > r.top + ANCHOR_HEIGHT) {
+                    OffsetRect(&anchor, ANCHOR_WIDTH + ANCHOR_GAP, r.top - anchor.top);
+                }
+            }
+
+            HintTarget target;
+            target.rect = anchor;
+            target.controlTypeId = UIA_WindowControlTypeId;
+            target.hwnd = hwnd;
+
+            // Title for search mode; InternalGetWindowText never waits on a hung window
+            wchar_t title[256];
+            int length = InternalGetWindowText(hwnd, title, 256);
+            if (length > 0) target.name.assign(title, length);
+            targets.push_back(target);
+        }
+        return targets;
+    }
+
+    bool ActivateWindow(HWND hwnd) {
+        if (!IsWindow(hwnd)) return false;
+        if (IsIconic(hwnd)) ShowWindow(hwnd, SW_RESTORE);
+
+        if (SetForegroundWindow(hwnd)) return true;
+
+        // Foreground lock: borrow the current foreground thread's input state
+        HWND foreground = GetForegroundWindow();
+        DWORD foregroundThread = foreground ? GetWindowThreadProcessId(foreground, nullptr) : 0;
+        DWORD thisThread = GetCurrentThreadId();
+        bool attached = foregroundThread && foregroundThread != thisThread
+            && AttachThreadInput(thisThread, foregroundThread, TRUE);
+
+        BringWindowToTop(hwnd);
+        bool ok = SetForegroundWindow(hwnd) != FALSE;
+
+        if (attached) AttachThreadInput(thisThread, foregroundThread, FALSE);
+        return ok;
+    }
+
+}
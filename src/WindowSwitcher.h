@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+#include "UIElementScanner.h"
+
+namespace hint_map {
+
+    // Keeps an MRU list of Alt+Tab-eligible top-level windows current from WinEvents,
+    // so switch mode never has to enumerate windows. Call on the UI thread: the
+    // out-of-context WinEvent callbacks arrive through its message loop.
+    void InitWindowSwitcher();
+    void ShutdownWindowSwitcher();
+
+    // Eligible windows, most recently active first
+    std::vector<HWND> SwitchableWindows();
+
+    // One hint target per switchable window, anchored at the top centre of the window.
+    // Anchors that would land on an earlier window's stack below it instead.
+    std::vector<HintTarget> GetWindowTargets();
+
+    // Restores (if minimized) and brings hwnd to the foreground
+    bool ActivateWindow(HWND hwnd);
+
+}
@@ -1,7 +0,0 @@
-// global.h
-#pragma once
-#include <unordered_set>
-#include <Windows.h>
-
-extern std::unordered_set<UINT> keysDown;
-
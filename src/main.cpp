@@ -10,9 +10,15 @@
 #include <thread>
 #include <chrono>
 #include "TrayIcon.h"
+#include "MonitorCache.h"
+#include "LatencyStats.h"
+#include "ScrollEngine.h"
+#include "FocusTracker.h"
+#include "WindowSwitcher.h"
+#include "ScanWorker.h"
+#include "BatchActions.h"
 #include <unordered_set>
 #include <algorithm>
-#include "global.h"
 #include <ShellScalingApi.h>
 #pragma comment(lib, "Shcore.lib")
 
@@ -20,9 +26,12 @@
 using namespace hint_map;
 
 static HHOOK g_suppressHook = nullptr;
+static std::thread g_hookThread;
+static DWORD g_hookThreadId = 0;
 
 static LRESULT CALLBACK SuppressKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
     if (nCode != HC_ACTION) return CallNextHookEx(g_suppressHook, nCode, wParam, lParam);
+    ScopedLatencyTimer timer(LatencyMetric::HookProc);
 
     const KBDLLHOOKSTRUCT* k = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
     const bool isDown = (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN);
@@ -41,7 +50,7 @@ static LRESULT CALLBACK SuppressKeyboardProc(int nCode, WPARAM wParam, LPARAM lP
     if (!hint_map::IsInsertMode()) {
         const bool isCtrl = (vk == VK_LCONTROL || vk == VK_RCONTROL || vk == VK_CONTROL);
 
-        // Still update our internal state (shortcuts, overlay, etc.)
+        // Queue the event for the UI thread (shortcuts, overlay, etc.)
         (void)hint_map::HandleKeyFromHook(vk, isDown);
 
         if (!isCtrl) {
@@ -64,6 +73,31 @@ static LRESULT CALLBACK SuppressKeyboardProc(int nCode, WPARAM wParam, LPARAM lP
 
 
 
+// The LL hook gets its own thread so a scan, overlay paint or UIA call on the UI thread
+// can never delay keystrokes system-wide or trip the hook timeout.
+static void HookThreadMain(HANDLE ready) {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+    g_hookThreadId = GetCurrentThreadId();
+
+    // Create the message queue before anyone can PostThreadMessage to us
+    MSG msg;
+    PeekMessage(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+
+    g_suppressHook = SetWindowsHookEx(WH_KEYBOARD_LL, SuppressKeyboardProc, GetModuleHandle(NULL), 0);
+    SetEvent(ready);
+    if (!g_suppressHook) return;
+
+    // Hook callbacks are delivered while this thread waits in GetMessage
+    while (GetMessage(&msg, nullptr, 0, 0) > 0) {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+
+    UnhookWindowsHookEx(g_suppressHook);
+    g_suppressHook = nullptr;
+}
+
+
 bool app_is_running = true;
 
 int WINAPI WinMain(
@@ -76,44 +110,71 @@ int WINAPI WinMain(
 	// Set DPI awareness
     SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
 
+    // Started by ourselves to run UIA scans out of process: no hook, tray or shortcuts
+    DWORD scanParentPid = 0;
+    if (hint_map::ParseScanWorkerCommandLine(lpCmdLine, scanParentPid)) {
+        return hint_map::RunScanWorker(hInstance, scanParentPid);
+    }
+
+    // Monitor rects and DPI, shared by the halo, overlay and scanner
+    hint_map::InitMonitorCache(hInstance);
+
     // Tray Icon Initialization
     InitTrayIcon(hInstance);
 
     // Initialize the dedicated Raw Input sink window
     hint_map::InitInputSink(hInstance);
 
+    // Held-key scrolling runs on its own thread
+    hint_map::StartScrollEngine();
+
+    // Focused control type / editability, kept current from UIA focus events
+    hint_map::StartFocusTracker();
+
+    // MRU list of switchable windows for G+H, maintained from WinEvents on this thread
+    hint_map::InitWindowSwitcher();
+
+    // Child process that runs the S+D+F scans
+    hint_map::StartScanWorker();
+
+    // Runs multi-select batches off the UI thread
+    hint_map::StartBatchWorker();
+
     // Initialize shortcut handling 
     shortcut::InitShortcuts(hInstance);
 
-    // Install suppression hook (for non-insert mode)
-    g_suppressHook = SetWindowsHookEx(WH_KEYBOARD_LL, SuppressKeyboardProc, GetModuleHandle(NULL), 0);
+    // Install suppression hook (for non-insert mode) on its own thread
+    HANDLE hookReady = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    g_hookThread = std::thread(HookThreadMain, hookReady);
+    WaitForSingleObject(hookReady, INFINITE);
+    CloseHandle(hookReady);
     if (!g_suppressHook) {
         MessageBox(NULL, L"Failed to install suppression hook.", L"Error", MB_ICONERROR);
     }
 
-    while (app_is_running) {
-        MSG msg;
-        while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
-        }
-
-        // Optional: You can omit this because WM_INPUT already triggers it.
-        // if (!hint_map::IsInsertMode()) {
-        //     shortcut::ProcessShortcuts(keysDown);
-        // }
-
-        Sleep(10);
+    // Block until there is work: the hook, Raw Input and timers all arrive as messages,
+    // so an idle app never wakes up. The tray window posts WM_QUIT on exit.
+    MSG msg;
+    while (app_is_running && GetMessage(&msg, nullptr, 0, 0) > 0) {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
     }
 
-    // Cleanup
+    // Cleanup: stop the hook thread first so nothing is queued to a destroyed sink window
+    if (g_hookThread.joinable()) {
+        PostThreadMessage(g_hookThreadId, WM_QUIT, 0, 0);
+        g_hookThread.join();
+    }
     shortcut::ClearShortcuts();
+    hint_map::StopScrollEngine();
+    hint_map::StopFocusTracker();
+    hint_map::ShutdownWindowSwitcher();
+    hint_map::StopBatchWorker();
+    hint_map::ShutdownHintOverlay();
+    hint_map::StopScanWorker();
     hint_map::ShutdownInputSink();
-    if (g_suppressHook) {
-        UnhookWindowsHookEx(g_suppressHook);
-        g_suppressHook = nullptr;
-    }
     CleanupTrayIcon();
+    hint_map::ShutdownMonitorCache();
 
     return 0;
 }
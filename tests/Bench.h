@@ -0,0 +1,50 @@
+// Bench.h
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// Timing for the core benchmarks: best of a few runs of each case, in milliseconds.
+// --quick runs each case once, which is what ctest does to keep them working.
+namespace bench {
+
+    struct Options {
+        int repeats = 7;
+        bool quick = false;
+    };
+
+    inline Options ParseOptions(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            if (!std::strcmp(argv[i], "--quick")) {
+                options.quick = true;
+                options.repeats = 1;
+            }
+        }
+        return options;
+    }
+
+    // Keeps a result alive so the work producing it isn't optimised away
+    inline void Keep(size_t value) {
+        static volatile size_t sink = 0;
+        sink = sink + value;
+    }
+
+    template <typename F>
+    double BestMs(const Options& options, F run) {
+        double best = 0.0;
+        for (int i = 0; i < options.repeats; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            run();
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (i == 0 || ms < best) best = ms;
+        }
+        return best;
+    }
+
+    inline void Report(const char* what, double ms) {
+        std::printf("%-48s %10.3f ms\n", what, ms);
+    }
+
+}
@@ -0,0 +1,49 @@
+// Fixtures.h
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Text fixtures under tests/fixtures. They are ASCII, so bytes widen straight to wchar_t.
+namespace test {
+
+    inline std::string FixturePath(const char* name) {
+        return std::string(NAVKEY_FIXTURES) + "/" + name;
+    }
+
+    // Whole file, CRLF left as it is. False if it can't be read.
+    inline bool ReadFixtureText(const char* name, std::wstring& text) {
+        FILE* file = std::fopen(FixturePath(name).c_str(), "rb");
+        if (!file) {
+            std::fprintf(stderr, "can't open fixture %s\n", FixturePath(name).c_str());
+            return false;
+        }
+        text.clear();
+        char buffer[4096];
+        size_t read;
+        while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            for (size_t i = 0; i < read; ++i) text.push_back((wchar_t)(unsigned char)buffer[i]);
+        }
+        std::fclose(file);
+        return true;
+    }
+
+    // One entry per line, skipping "#" comment lines; empty lines stay as empty entries
+    inline bool ReadFixtureLines(const char* name, std::vector<std::wstring>& lines) {
+        std::wstring text;
+        if (!ReadFixtureText(name, text)) return false;
+        lines.clear();
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find(L'\n', start);
+            if (end == std::wstring::npos) end = text.size();
+            size_t length = end - start;
+            if (length > 0 && text[start + length - 1] == L'\r') --length;
+            if (length == 0 || text[start] != L'#') lines.push_back(text.substr(start, length));
+            start = end + 1;
+        }
+        return true;
+    }
+
+}
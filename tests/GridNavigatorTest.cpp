@@ -0,0 +1,175 @@
+// GridNavigatorTest.cpp
+//
+// Grid fallback: the nine cells tile the area exactly (shared edges, no gaps, every pixel
+// covered once) for sizes that don't divide by 3 and offset origins; Select stops at the
+// depth limit and the minimum cell size; Back walks the stack back to the root.
+
+#include <vector>
+#include "GridNavigator.h"
+#include "TestCheck.h"
+
+using namespace hint_map;
+
+// Every pixel of the area in exactly one cell, and nothing outside it
+static void CheckTiling(const GridNavigator& grid) {
+    const Rect& area = grid.Area();
+    std::vector<int> hits((size_t)area.Width() * area.Height(), 0);
+    for (int i = 0; i < GridNavigator::CELLS; ++i) {
+        const Rect cell = grid.Cell(i);
+        CHECK(cell.left >= area.left && cell.right <= area.right);
+        CHECK(cell.top >= area.top && cell.bottom <= area.bottom);
+        for (int y = cell.top; y < cell.bottom; ++y) {
+            for (int x = cell.left; x < cell.right; ++x) {
+                ++hits[(size_t)(y - area.top) * area.Width() + (x - area.left)];
+            }
+        }
+    }
+    int wrong = 0;
+    for (int h : hits) {
+        if (h != 1) ++wrong;
+    }
+    CHECK_EQ(wrong, 0);
+}
+
+// Neighbours meet on the same coordinate, and the outer cells sit on the area's edges
+static void CheckSharedEdges(const GridNavigator& grid) {
+    const int C = GridNavigator::COLUMNS, R = GridNavigator::ROWS;
+    for (int row = 0; row < R; ++row) {
+        for (int col = 0; col < C; ++col) {
+            const Rect cell = grid.Cell(row * C + col);
+            if (col + 1 < C) CHECK_EQ(cell.right, grid.Cell(row * C + col + 1).left);
+            if (row + 1 < R) CHECK_EQ(cell.bottom, grid.Cell((row + 1) * C + col).top);
+            if (col == 0) CHECK_EQ(cell.left, grid.Area().left);
+            if (col == C - 1) CHECK_EQ(cell.right, grid.Area().right);
+            if (row == 0) CHECK_EQ(cell.top, grid.Area().top);
+            if (row == R - 1) CHECK_EQ(cell.bottom, grid.Area().bottom);
+            // Floor edges: no cell more than one pixel off a third
+            CHECK(cell.Width() * 3 >= grid.Area().Width() - 2 && cell.Width() * 3 <= grid.Area().Width() + 2);
+            CHECK(cell.Height() * 3 >= grid.Area().Height() - 2 && cell.Height() * 3 <= grid.Area().Height() + 2);
+        }
+    }
+}
+
+static void TestTiling() {
+    const Rect areas[] = {
+        MakeRect(0, 0, 300, 300),
+        MakeRect(0, 0, 1920, 1080),
+        MakeRect(-1920, 0, 0, 1200),            // monitor left of the primary
+        MakeRect(7, -13, 7 + 100, -13 + 101),   // sizes that don't divide by 3
+        MakeRect(0, 0, 4, 5),
+        MakeRect(100, 100, 102, 101),           // smaller than the grid: some cells empty
+    };
+    for (const Rect& area : areas) {
+        GridNavigator grid(area);
+        CheckTiling(grid);
+        if (area.Width() >= 3 && area.Height() >= 3) CheckSharedEdges(grid);
+    }
+
+    // Still exact a few levels down, where the areas are odd sizes at odd offsets
+    GridNavigator grid(MakeRect(13, 29, 13 + 2557, 29 + 1439), 1);
+    const int path[] = { 4, 8, 0, 5, 3 };
+    for (int cell : path) {
+        CHECK(grid.Select(cell));
+        CheckTiling(grid);
+        CheckSharedEdges(grid);
+    }
+}
+
+static void TestKeys() {
+    for (int i = 0; i < GridNavigator::CELLS; ++i) {
+        CHECK_EQ(GridNavigator::CellForKey(GridNavigator::CellKey(i)), i);
+    }
+    CHECK_EQ(GridNavigator::CellKey(-1), 0);
+    CHECK_EQ(GridNavigator::CellKey(GridNavigator::CELLS), 0);
+    CHECK_EQ(GridNavigator::CellForKey('q'), -1);   // upper case only
+    CHECK_EQ(GridNavigator::CellForKey('R'), -1);
+    CHECK_EQ(GridNavigator::CellForKey(0), -1);
+}
+
+static void TestSelectAndCentre() {
+    GridNavigator grid(MakeRect(0, 0, 900, 600));
+    CHECK(!grid.Select(-1));
+    CHECK(!grid.Select(GridNavigator::CELLS));
+    CHECK_EQ(grid.Depth(), 0);
+
+    CHECK(grid.Select(8));   // bottom right
+    CHECK_EQ(grid.Area().left, 600);
+    CHECK_EQ(grid.Area().top, 400);
+    CHECK_EQ(grid.Area().right, 900);
+    CHECK_EQ(grid.Area().bottom, 600);
+    CHECK_EQ(grid.CenterX(), 750);
+    CHECK_EQ(grid.CenterY(), 500);
+}
+
+static void TestDepthLimit() {
+    // Big enough that only the stack can stop it: 3^17 > 2^26
+    GridNavigator grid(MakeRect(0, 0, 1 << 30, 1 << 30), 1);
+    for (int i = 0; i < GridNavigator::MAX_DEPTH; ++i) {
+        CHECK(grid.Select(4));
+    }
+    CHECK_EQ(grid.Depth(), GridNavigator::MAX_DEPTH);
+    const Rect before = grid.Area();
+    CHECK(!grid.Select(4));
+    CHECK_EQ(grid.Depth(), GridNavigator::MAX_DEPTH);
+    CHECK_EQ(grid.Area().left, before.left);
+    CHECK_EQ(grid.Area().right, before.right);
+
+    // Minimum cell size stops it first on a real screen
+    GridNavigator small(MakeRect(0, 0, 1920, 1080));   // default minimum of 4
+    int levels = 0;
+    while (small.Select(0)) ++levels;
+    CHECK(levels > 0 && levels < GridNavigator::MAX_DEPTH);
+    CHECK(small.Area().Width() >= 4 && small.Area().Height() >= 4);
+    CHECK(small.Cell(0).Width() < 4 || small.Cell(0).Height() < 4);
+    CHECK_EQ(small.Depth(), levels);
+
+    // A minimum below one is treated as one
+    GridNavigator tiny(MakeRect(0, 0, 3, 3), 0);
+    CHECK(tiny.Select(4));
+    CHECK(!tiny.Select(4));
+}
+
+static void TestBack() {
+    const Rect root = MakeRect(10, 20, 1010, 920);
+    GridNavigator grid(root);
+    CHECK(!grid.Back());
+    CHECK_EQ(grid.Depth(), 0);
+
+    std::vector<Rect> visited;
+    const int path[] = { 0, 4, 8, 2 };
+    for (int cell : path) {
+        visited.push_back(grid.Area());
+        CHECK(grid.Select(cell));
+    }
+    for (size_t i = visited.size(); i-- > 0;) {
+        CHECK(grid.Back());
+        CHECK_EQ(grid.Depth(), (int)i);
+        CHECK_EQ(grid.Area().left, visited[i].left);
+        CHECK_EQ(grid.Area().top, visited[i].top);
+        CHECK_EQ(grid.Area().right, visited[i].right);
+        CHECK_EQ(grid.Area().bottom, visited[i].bottom);
+    }
+    CHECK(!grid.Back());
+
+    // Back then a different cell goes to the sibling, not the old child
+    CHECK(grid.Select(0));
+    CHECK(grid.Back());
+    CHECK(grid.Select(2));
+    CHECK_EQ(grid.Area().right, root.right);
+    CHECK_EQ(grid.Area().top, root.top);
+
+    // Reset drops the whole stack
+    grid.Reset(MakeRect(0, 0, 90, 90));
+    CHECK_EQ(grid.Depth(), 0);
+    CHECK(!grid.Back());
+    CHECK_EQ(grid.Area().right, 90);
+}
+
+int main() {
+    TestTiling();
+    TestKeys();
+    TestSelectAndCentre();
+    TestDepthLimit();
+    TestBack();
+    return test::TestExitCode("GridNavigatorTest");
+}
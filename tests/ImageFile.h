@@ -0,0 +1,72 @@
+// ImageFile.h
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace test {
+
+    // Canvas pixels as a PAM file (P7, RGB_ALPHA), the simplest format image viewers and
+    // diff tools read with alpha. Pixels stay premultiplied; it's for comparing, not viewing.
+    struct Image {
+        int width = 0;
+        int height = 0;
+        std::vector<uint32_t> pixels;   // 0xAARRGGBB, premultiplied, top-down
+    };
+
+    inline bool WritePam(const std::string& path, const Image& image) {
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) return false;
+        std::fprintf(f, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n",
+            image.width, image.height);
+        for (uint32_t p : image.pixels) {
+            const unsigned char rgba[4] = { (unsigned char)(p >> 16), (unsigned char)(p >> 8),
+                                            (unsigned char)p, (unsigned char)(p >> 24) };
+            std::fwrite(rgba, 1, 4, f);
+        }
+        return std::fclose(f) == 0;
+    }
+
+    inline bool ReadPam(const std::string& path, Image& image) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        int depth = 0, maxval = 0;
+        const bool header = std::fscanf(f, "P7 WIDTH %d HEIGHT %d DEPTH %d MAXVAL %d TUPLTYPE RGB_ALPHA ENDHDR",
+            &image.width, &image.height, &depth, &maxval) == 4 && std::fgetc(f) == '\n';
+        if (!header || depth != 4 || maxval != 255 || image.width <= 0 || image.height <= 0) {
+            std::fclose(f);
+            return false;
+        }
+        image.pixels.resize((size_t)image.width * image.height);
+        bool complete = true;
+        for (uint32_t& p : image.pixels) {
+            unsigned char rgba[4];
+            if (std::fread(rgba, 1, 4, f) != 4) {
+                complete = false;
+                break;
+            }
+            p = ((uint32_t)rgba[3] << 24) | ((uint32_t)rgba[0] << 16) | ((uint32_t)rgba[1] << 8) | rgba[2];
+        }
+        std::fclose(f);
+        return complete;
+    }
+
+    // Pixels whose channels differ by more than tolerance
+    inline int CountDifferentPixels(const Image& a, const Image& b, int tolerance) {
+        if (a.width != b.width || a.height != b.height) return -1;
+        int count = 0;
+        for (size_t i = 0; i < a.pixels.size(); ++i) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                const int d = (int)((a.pixels[i] >> shift) & 0xFF) - (int)((b.pixels[i] >> shift) & 0xFF);
+                if (d > tolerance || d < -tolerance) {
+                    ++count;
+                    break;
+                }
+            }
+        }
+        return count;
+    }
+
+}
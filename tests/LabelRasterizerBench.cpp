@@ -0,0 +1,54 @@
+// LabelRasterizerBench.cpp
+//
+// Label drawing on a 4K canvas: boxes alone, then whole labels with text, at the counts a
+// dense window produces.
+
+#include <cstdio>
+#include <vector>
+#include "Bench.h"
+#include "LabelRasterizer.h"
+#include "TestGlyphs.h"
+
+using namespace hint_map;
+
+int main(int argc, char** argv) {
+    const bench::Options options = bench::ParseOptions(argc, argv);
+    const int width = 3840, height = 2160;
+    std::vector<uint32_t> pixels((size_t)width * height);
+    Canvas canvas;
+    canvas.pixels = pixels.data();
+    canvas.width = width;
+    canvas.height = height;
+    canvas.stride = width;
+
+    const GlyphAtlas atlas = test::SyntheticAtlas(16);
+    const LabelStyle style;
+    const wchar_t* const texts[] = { L"E", L"AS", L"JK", L"MW", L"DF" };
+    const int counts[] = { 500, 2000, 5000 };
+
+    double ms = bench::BestMs(options, [&]() { ClearCanvas(canvas); });
+    bench::Report("ClearCanvas 3840x2160", ms);
+
+    for (int count : counts) {
+        std::vector<Rect> boxes;
+        for (int i = 0; i < count; ++i) {
+            const int x = (i * 37) % (width - 40), y = (i * 53) % (height - 24);
+            boxes.push_back(MakeRect(x, y, x + 34, y + 22));
+        }
+        char what[96];
+
+        ms = bench::BestMs(options, [&]() {
+            for (const Rect& box : boxes) FillRoundedRect(canvas, box, style.radius, style.fill);
+        });
+        std::snprintf(what, sizeof(what), "FillRoundedRect x%d", count);
+        bench::Report(what, ms);
+
+        ms = bench::BestMs(options, [&]() {
+            for (size_t i = 0; i < boxes.size(); ++i) DrawLabel(canvas, boxes[i], texts[i % 5], atlas, style);
+        });
+        std::snprintf(what, sizeof(what), "DrawLabel x%d", count);
+        bench::Report(what, ms);
+    }
+    bench::Keep(pixels[(size_t)width * 100 + 100]);
+    return 0;
+}
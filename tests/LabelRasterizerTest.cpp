@@ -0,0 +1,119 @@
+// LabelRasterizerTest.cpp
+//
+// Image-diff test for the label rasteriser: a fixed scene of labels, rounded rects and
+// masks is drawn and compared with fixtures/labels.pam. The SSE2 and scalar paths must
+// both reproduce it; one channel of rounding slack covers compilers' float differences.
+// Run with --update to rewrite the reference after an intended change.
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "ImageFile.h"
+#include "LabelRasterizer.h"
+#include "TestCheck.h"
+#include "TestGlyphs.h"
+
+using namespace hint_map;
+
+static const int WIDTH = 240;
+static const int HEIGHT = 96;
+static const int STRIDE = WIDTH + 8;            // padding columns must never be written
+static const uint32_t GUARD = 0xDEADBEEF;
+
+static void DrawScene(Canvas& canvas, const GlyphAtlas& atlas) {
+    ClearCanvas(canvas);
+
+    LabelStyle plain;
+    DrawLabel(canvas, MakeRect(4, 4, 4 + MeasureLabel(L"AB", atlas, plain.padX, plain.padY).width,
+        4 + MeasureLabel(L"AB", atlas, plain.padX, plain.padY).height), L"AB", atlas, plain);
+
+    LabelStyle selected;
+    selected.fill = 0xFFFFD700;
+    selected.border = 0xFF804000;
+    selected.text = 0xFF202080;
+    selected.radius = 6.0f;
+    selected.borderWidth = 2;
+    selected.padX = 4;
+    selected.padY = 2;
+    const Size wide = MeasureLabel(L"QZM", atlas, selected.padX, selected.padY);
+    DrawLabel(canvas, MakeRect(40, 8, 40 + wide.width, 8 + wide.height), L"QZM", atlas, selected);
+
+    // Translucent style, as marked (queued) labels are drawn
+    LabelStyle translucent = plain;
+    translucent.fill = 0x80FF4040;
+    translucent.radius = 0.0f;
+    DrawLabel(canvas, MakeRect(100, 30, 140, 52), L"EW", atlas, translucent);
+
+    // Clipped by every edge of the canvas
+    DrawLabel(canvas, MakeRect(-10, 60, 20, 82), L"KL", atlas, plain);
+    DrawLabel(canvas, MakeRect(220, -6, 260, 16), L"GH", atlas, selected);
+    DrawLabel(canvas, MakeRect(200, 80, 250, 110), L"XC", atlas, plain);
+
+    // Overlapping translucent shapes, radius larger than half the box
+    FillRoundedRect(canvas, MakeRect(60, 40, 110, 90), 40.0f, 0x6000A0FF);
+    FillRoundedRect(canvas, MakeRect(80, 50, 130, 70), 3.5f, 0xC0FF00FF);
+
+    // Gradient mask, partly off the left edge
+    std::vector<uint8_t> mask(64 * 16);
+    for (int y = 0; y < 16; ++y) {
+        for (int x = 0; x < 64; ++x) mask[(size_t)y * 64 + x] = (uint8_t)((x * 4 + y * 8) & 0xFF);
+    }
+    BlendMask(canvas, -20, 40, mask.data(), 64, 16, 64, 0xFF00FF80);
+    BlendMask(canvas, 150, 60, mask.data(), 64, 16, 64, 0x8040C0FF);
+}
+
+int main(int argc, char** argv) {
+    const bool update = argc > 1 && !std::strcmp(argv[1], "--update");
+    const std::string reference = std::string(NAVKEY_FIXTURES) + "/labels.pam";
+    const GlyphAtlas atlas = test::SyntheticAtlas(12);
+
+    // MeasureLabel: advances plus padding, line height plus padding
+    const Size size = MeasureLabel(L"AB?", atlas, 3, 2);
+    CHECK_EQ(size.width, 2 * atlas.glyphs[0].advance + 6);
+    CHECK_EQ(size.height, atlas.lineHeight + 4);
+
+    std::vector<uint32_t> storage((size_t)STRIDE * HEIGHT, GUARD);
+    Canvas canvas;
+    canvas.pixels = storage.data();
+    canvas.width = WIDTH;
+    canvas.height = HEIGHT;
+    canvas.stride = STRIDE;
+    DrawScene(canvas, atlas);
+
+    test::Image image;
+    image.width = WIDTH;
+    image.height = HEIGHT;
+    for (int y = 0; y < HEIGHT; ++y) {
+        for (int x = 0; x < STRIDE; ++x) {
+            const uint32_t p = canvas.Row(y)[x];
+            if (x >= WIDTH) {
+                CHECK(p == GUARD);
+                continue;
+            }
+            image.pixels.push_back(p);
+            // Premultiplied: no colour channel above alpha
+            const uint32_t a = p >> 24;
+            CHECK(((p >> 16) & 0xFF) <= a && ((p >> 8) & 0xFF) <= a && (p & 0xFF) <= a);
+        }
+    }
+
+    // Drawing the same scene again gives the same bytes (ClearCanvas really clears)
+    std::vector<uint32_t> first(storage);
+    DrawScene(canvas, atlas);
+    CHECK(first == storage);
+
+    if (update) {
+        CHECK(test::WritePam(reference, image));
+        return test::TestExitCode("LabelRasterizerTest --update");
+    }
+
+    test::Image expected;
+    CHECK(test::ReadPam(reference, expected));
+    const int different = test::CountDifferentPixels(image, expected, 1);
+    CHECK_EQ(different, 0);
+    if (different) {
+        test::WritePam("labels.actual.pam", image);
+        std::fprintf(stderr, "wrote labels.actual.pam for comparison with %s\n", reference.c_str());
+    }
+    return test::TestExitCode("LabelRasterizerTest");
+}
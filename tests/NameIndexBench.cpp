@@ -0,0 +1,63 @@
+// NameIndexBench.cpp
+//
+// Search-mode index on captured window snapshots (fixtures/names_*.txt): Build once per
+// activation, then one Search per keystroke as the query is typed. Each snapshot is also
+// run repeated 10x, about the size of the densest windows seen.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Bench.h"
+#include "Fixtures.h"
+#include "NameIndex.h"
+
+using namespace hint_map;
+
+struct Snapshot {
+    const char* file;
+    const wchar_t* queries[4];      // typed one character at a time
+};
+
+static const Snapshot SNAPSHOTS[] = {
+    { "names_browser.txt", { L"reload", L"comments", L"perfromance", L"next page" } },
+    { "names_explorer.txt", { L"invoice", L"screenshot 2025", L"copy path", L"pdf document" } },
+    { "names_ide.txt", { L"scanworker", L"source control", L"hint overlay h", L"never referenced" } },
+};
+
+static void RunSnapshot(const bench::Options& options, const char* file, const Snapshot& snapshot,
+    const std::vector<std::wstring>& names) {
+    char what[96];
+    NameIndex index;
+    double ms = bench::BestMs(options, [&]() { index.Build(names); });
+    std::snprintf(what, sizeof(what), "Build %s (%d names)", file, (int)names.size());
+    bench::Report(what, ms);
+
+    for (const wchar_t* query : snapshot.queries) {
+        const std::wstring full(query);
+        size_t found = 0;
+        ms = bench::BestMs(options, [&]() {
+            for (size_t length = 1; length <= full.size(); ++length) {
+                found += index.Search(full.substr(0, length)).size();
+            }
+        });
+        std::snprintf(what, sizeof(what), "  type \"%ls\"", query);
+        bench::Report(what, ms);
+        bench::Keep(found);
+    }
+}
+
+int main(int argc, char** argv) {
+    const bench::Options options = bench::ParseOptions(argc, argv);
+    for (const Snapshot& snapshot : SNAPSHOTS) {
+        std::vector<std::wstring> names;
+        if (!test::ReadFixtureLines(snapshot.file, names) || names.empty()) return 1;
+        RunSnapshot(options, snapshot.file, snapshot, names);
+
+        std::vector<std::wstring> repeated;
+        for (int copy = 0; copy < 10; ++copy) repeated.insert(repeated.end(), names.begin(), names.end());
+        char label[64];
+        std::snprintf(label, sizeof(label), "%s x10", snapshot.file);
+        RunSnapshot(options, label, snapshot, repeated);
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+// RegionAlgebraBench.cpp
+//
+// Occlusion-sized workloads with thousands of rects: the visible part of a 4K window under
+// many occluders, built with FromRects and by folding Union, then the per-target
+// IntersectArea queries hint mode makes against it.
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Bench.h"
+#include "RegionAlgebra.h"
+
+using namespace hint_map;
+
+static std::vector<Rect> Occluders(int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<Rect> rects((size_t)count);
+    for (Rect& r : rects) {
+        const int x = (int)(rng() % 3800), y = (int)(rng() % 2100);
+        r = MakeRect(x, y, x + 4 + (int)(rng() % 120), y + 4 + (int)(rng() % 60));
+    }
+    return rects;
+}
+
+int main(int argc, char** argv) {
+    const bench::Options options = bench::ParseOptions(argc, argv);
+    const Region window(MakeRect(0, 0, 3840, 2160));
+    const int counts[] = { 1000, 5000, 20000 };
+    char what[96];
+
+    for (int count : counts) {
+        const std::vector<Rect> occluders = Occluders(count, (unsigned)count);
+
+        Region covered;
+        double ms = bench::BestMs(options, [&]() { covered = Region::FromRects(occluders); });
+        std::snprintf(what, sizeof(what), "FromRects x%d (%d bands)", count, covered.BandCount());
+        bench::Report(what, ms);
+
+        if (count <= 1000) {   // quadratic: the baseline FromRects replaces
+            ms = bench::BestMs(options, [&]() {
+                Region folded;
+                for (const Rect& r : occluders) folded = folded.Union(Region(r));
+                bench::Keep((size_t)folded.BandCount());
+            });
+            std::snprintf(what, sizeof(what), "Union fold x%d", count);
+            bench::Report(what, ms);
+        }
+
+        Region visible;
+        ms = bench::BestMs(options, [&]() { visible = window.Subtract(covered); });
+        std::snprintf(what, sizeof(what), "Subtract from 4K window x%d", count);
+        bench::Report(what, ms);
+
+        const std::vector<Rect> targets = Occluders(5000, 7u);
+        ms = bench::BestMs(options, [&]() {
+            long long total = 0;
+            for (const Rect& t : targets) {
+                total += visible.IntersectArea(MakeRect(t.left, t.top, t.left + 40, t.top + 20));
+            }
+            bench::Keep((size_t)total);
+        });
+        std::snprintf(what, sizeof(what), "IntersectArea x5000 (under %d)", count);
+        bench::Report(what, ms);
+
+        ms = bench::BestMs(options, [&]() { bench::Keep(visible.Rects().size()); });
+        std::snprintf(what, sizeof(what), "Rects of visible (under %d)", count);
+        bench::Report(what, ms);
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+// RegionAlgebraTest.cpp
+//
+// Region operations against a bitmap oracle: random rect sets on a small grid (with a
+// negative origin, so coordinates of both signs are covered) are painted pixel by pixel,
+// and every operation must paint the same pixels as the bitmap version. The rects a
+// region returns must be disjoint, and equal sets must reach the same canonical bands.
+
+#include <random>
+#include <vector>
+#include "RegionAlgebra.h"
+#include "TestCheck.h"
+
+using namespace hint_map;
+
+static const int ORIGIN = -16;          // grid covers [ORIGIN, ORIGIN + SIZE) on both axes
+static const int SIZE = 64;
+
+typedef std::vector<unsigned char> Bitmap;
+
+static bool OnGrid(int x, int y) {
+    return x >= ORIGIN && x < ORIGIN + SIZE && y >= ORIGIN && y < ORIGIN + SIZE;
+}
+
+static size_t Pixel(int x, int y) {
+    return (size_t)(y - ORIGIN) * SIZE + (x - ORIGIN);
+}
+
+static Bitmap PaintRects(const std::vector<Rect>& rects) {
+    Bitmap bitmap((size_t)SIZE * SIZE, 0);
+    for (const Rect& r : rects) {
+        for (int y = r.top; y < r.bottom; ++y) {
+            for (int x = r.left; x < r.right; ++x) bitmap[Pixel(x, y)] = 1;
+        }
+    }
+    return bitmap;
+}
+
+// Paints the region's own rects; any pixel painted twice means they overlap
+static Bitmap PaintRegion(const Region& region) {
+    Bitmap bitmap((size_t)SIZE * SIZE, 0);
+    int outside = 0, overlaps = 0;
+    for (const Rect& r : region.Rects()) {
+        CHECK(!r.Empty());
+        for (int y = r.top; y < r.bottom; ++y) {
+            for (int x = r.left; x < r.right; ++x) {
+                if (!OnGrid(x, y)) {
+                    ++outside;
+                    continue;
+                }
+                if (bitmap[Pixel(x, y)]) ++overlaps;
+                bitmap[Pixel(x, y)] = 1;
+            }
+        }
+    }
+    CHECK_EQ(outside, 0);
+    CHECK_EQ(overlaps, 0);
+    return bitmap;
+}
+
+static long long CountIn(const Bitmap& bitmap, const Rect& rect) {
+    long long count = 0;
+    for (int y = rect.top; y < rect.bottom; ++y) {
+        for (int x = rect.left; x < rect.right; ++x) {
+            if (OnGrid(x, y)) count += bitmap[Pixel(x, y)];
+        }
+    }
+    return count;
+}
+
+// Tight bounds of the set pixels inside rect; empty Rect if none
+static Rect BoundsIn(const Bitmap& bitmap, const Rect& rect) {
+    Rect bounds;
+    bool any = false;
+    for (int y = rect.top; y < rect.bottom; ++y) {
+        for (int x = rect.left; x < rect.right; ++x) {
+            if (!OnGrid(x, y) || !bitmap[Pixel(x, y)]) continue;
+            if (!any) {
+                bounds = MakeRect(x, y, x + 1, y + 1);
+                any = true;
+            }
+            if (x < bounds.left) bounds.left = x;
+            if (y < bounds.top) bounds.top = y;
+            if (x + 1 > bounds.right) bounds.right = x + 1;
+            if (y + 1 > bounds.bottom) bounds.bottom = y + 1;
+        }
+    }
+    return bounds;
+}
+
+static void CheckSameRect(const Rect& a, const Rect& b) {
+    if (a.Empty() && b.Empty()) return;
+    CHECK_EQ(a.left, b.left);
+    CHECK_EQ(a.top, b.top);
+    CHECK_EQ(a.right, b.right);
+    CHECK_EQ(a.bottom, b.bottom);
+}
+
+static void CheckMatches(const Region& region, const Bitmap& expected) {
+    CHECK(PaintRegion(region) == expected);
+    long long count = 0;
+    for (unsigned char p : expected) count += p;
+    CHECK_EQ(region.Area(), count);
+    CHECK_EQ(region.Empty(), count == 0);
+    CheckSameRect(region.Bounds(), BoundsIn(expected, MakeRect(ORIGIN, ORIGIN, ORIGIN + SIZE, ORIGIN + SIZE)));
+}
+
+// Mostly small rects, some degenerate (zero or negative size), a few large
+static Rect RandomRect(std::mt19937& rng) {
+    const int x = ORIGIN + (int)(rng() % SIZE), y = ORIGIN + (int)(rng() % SIZE);
+    const int maxSize = rng() % 8 == 0 ? SIZE : 16;
+    int right = x + (int)(rng() % maxSize), bottom = y + (int)(rng() % maxSize);
+    if (rng() % 16 == 0) right = x - 1;
+    if (right > ORIGIN + SIZE) right = ORIGIN + SIZE;
+    if (bottom > ORIGIN + SIZE) bottom = ORIGIN + SIZE;
+    return MakeRect(x, y, right, bottom);
+}
+
+static std::vector<Rect> RandomRects(std::mt19937& rng, int maxCount) {
+    std::vector<Rect> rects((size_t)(rng() % (maxCount + 1)));
+    for (Rect& r : rects) r = RandomRect(rng);
+    return rects;
+}
+
+static void TestAgainstBitmap() {
+    std::mt19937 rng(43);
+    for (int round = 0; round < 3000; ++round) {
+        const std::vector<Rect> rectsA = RandomRects(rng, round < 1500 ? 4 : 24);
+        const std::vector<Rect> rectsB = RandomRects(rng, round < 1500 ? 4 : 24);
+        const Bitmap a = PaintRects(rectsA), b = PaintRects(rectsB);
+        const Region regionA = Region::FromRects(rectsA), regionB = Region::FromRects(rectsB);
+        CheckMatches(regionA, a);
+        CheckMatches(regionB, b);
+
+        Bitmap unionBits(a.size()), intersectBits(a.size()), subtractBits(a.size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            unionBits[i] = a[i] | b[i];
+            intersectBits[i] = a[i] & b[i];
+            subtractBits[i] = a[i] & !b[i];
+        }
+        const Region unionRegion = regionA.Union(regionB);
+        const Region subtractRegion = regionA.Subtract(regionB);
+        CheckMatches(unionRegion, unionBits);
+        CheckMatches(regionA.Intersect(regionB), intersectBits);
+        CheckMatches(subtractRegion, subtractBits);
+
+        // Canonical form: the same set built another way has the same bands
+        std::vector<Rect> both(rectsA);
+        both.insert(both.end(), rectsB.begin(), rectsB.end());
+        CHECK_EQ(Region::FromRects(both).BandCount(), unionRegion.BandCount());
+        Region folded;
+        for (const Rect& r : rectsA) folded = folded.Union(Region(r));
+        CHECK_EQ(folded.BandCount(), regionA.BandCount());
+        CHECK(PaintRegion(folded) == a);
+
+        for (int q = 0; q < 4; ++q) {
+            const Rect query = RandomRect(rng);
+            CHECK_EQ(subtractRegion.IntersectArea(query), CountIn(subtractBits, query));
+            CheckSameRect(subtractRegion.IntersectBounds(query), BoundsIn(subtractBits, query));
+        }
+    }
+}
+
+static void TestEdgeCases() {
+    const Region empty;
+    CHECK(empty.Empty());
+    CHECK_EQ(empty.Area(), 0);
+    CHECK(empty.Rects().empty());
+    CHECK(Region(MakeRect(5, 5, 5, 10)).Empty());
+    CHECK(Region::FromRects(std::vector<Rect>()).Empty());
+
+    const Region box(MakeRect(0, 0, 10, 10));
+    CHECK_EQ(box.Union(empty).Area(), 100);
+    CHECK(box.Intersect(empty).Empty());
+    CHECK_EQ(box.Subtract(empty).Area(), 100);
+    CHECK(empty.Subtract(box).Empty());
+    CHECK(box.Subtract(box).Empty());
+
+    // Touching rects merge into one band; a hole splits the middle band in two spans
+    const Region side = Region(MakeRect(0, 0, 10, 10)).Union(Region(MakeRect(10, 0, 20, 10)));
+    CHECK_EQ(side.BandCount(), 1);
+    CHECK_EQ((int)side.Rects().size(), 1);
+    const Region stacked = Region(MakeRect(0, 0, 10, 10)).Union(Region(MakeRect(0, 10, 10, 20)));
+    CHECK_EQ(stacked.BandCount(), 1);
+    const Region ring = Region(MakeRect(0, 0, 30, 30)).Subtract(Region(MakeRect(10, 10, 20, 20)));
+    CHECK_EQ(ring.BandCount(), 3);
+    CHECK_EQ(ring.Area(), 800);
+    CHECK_EQ(ring.IntersectArea(MakeRect(5, 5, 25, 25)), 300);
+    CheckSameRect(ring.IntersectBounds(MakeRect(12, 12, 18, 18)), Rect());
+    CheckSameRect(ring.IntersectBounds(MakeRect(15, 0, 16, 30)), MakeRect(15, 0, 16, 30));
+
+    // Far coordinates don't overflow the area
+    const Region huge(MakeRect(-1000000, -1000000, 1000000, 1000000));
+    CHECK_EQ(huge.Area(), 4000000000000LL);
+}
+
+int main() {
+    TestEdgeCases();
+    TestAgainstBitmap();
+    return test::TestExitCode("RegionAlgebraTest");
+}
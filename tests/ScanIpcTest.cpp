@@ -0,0 +1,401 @@
+// ScanIpcTest.cpp
+//
+// Scan worker channel with a stand-in worker: a thread that answers requests the way
+// RunScanWorker does, over a response ring small enough that results keep wrapping. Also
+// checks padding at the ring's end byte for byte, that corrupt and truncated payloads are
+// rejected rather than read past, and that Attach refuses a bad header.
+
+#include <cstddef>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "ScanIpc.h"
+#include "TestCheck.h"
+
+using namespace hint_map;
+
+static const uint32_t STATUS_OK = 0;
+static const uint32_t STATUS_NOT_INVOKED = 3;
+static const uint32_t ROUND_TRIPS = 3000;
+
+// Channel memory, 64-byte aligned like a mapped view
+struct ChannelMemory {
+    explicit ChannelMemory(size_t size) : words(size / 8 + 16), bytes(size) {}
+    void* Base() {
+        const uintptr_t p = (uintptr_t)words.data();
+        return (void*)((p + 63) & ~(uintptr_t)63);
+    }
+    std::vector<uint64_t> words;
+    size_t bytes;
+};
+
+// Deterministic result for a scan request, so the app side can check every field
+static uint32_t TargetCount(uint32_t sequence) { return sequence % 97; }
+
+static std::vector<uint8_t> ScanResult(uint32_t sequence, uint64_t window) {
+    ScanResultWriter writer;
+    writer.SetStageTimes(sequence, sequence * 2, sequence * 3);
+    for (uint32_t i = 0; i < TargetCount(sequence); ++i) {
+        const int32_t runtimeId[3] = { 42, (int32_t)sequence, (int32_t)i };
+        const uint16_t name[6] = { 'n', 'a', 'm', 'e', (uint16_t)('0' + i % 10), (uint16_t)window };
+        const uint16_t automationId[2] = { 'i', 'd' };
+        writer.Add(MakeRect((int)i, -(int)i, (int)i + 10, 5), 50000 + (int)(i % 40),
+            runtimeId, 1 + i % 3, name, i % 7, automationId, i % 3);
+    }
+    return writer.Finish();
+}
+
+// Stand-in for RunScanWorker's loop: payloads are checked for size before use, unknown
+// records are dropped, and every answered request gets one result with its sequence
+static void StandInWorker(ScanChannel channel, uint32_t requests) {
+    uint32_t answered = 0;
+    while (answered < requests) {
+        ScanRecordView record;
+        if (!channel.Peek(SCAN_REQUESTS, record)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ScanRequestPayload scan = {};
+        ScanContainerRequestPayload container = {};
+        ScanInvokeRequestPayload invoke = {};
+        const bool isScan = record.type == SCAN_RECORD_REQUEST && record.size == sizeof(scan);
+        const bool isContainer = record.type == SCAN_RECORD_CONTAINER_REQUEST && record.size == sizeof(container);
+        const bool isInvoke = record.type == SCAN_RECORD_INVOKE_REQUEST && record.size == sizeof(invoke);
+        if (isScan) memcpy(&scan, record.payload, sizeof(scan));
+        if (isContainer) memcpy(&container, record.payload, sizeof(container));
+        if (isInvoke) memcpy(&invoke, record.payload, sizeof(invoke));
+        const uint32_t sequence = record.sequence;
+        channel.Consume(SCAN_REQUESTS, record);
+        if (!isScan && !isContainer && !isInvoke) continue;
+
+        std::vector<uint8_t> payload;
+        if (isScan) {
+            payload = ScanResult(sequence, scan.window);
+        }
+        else if (isContainer) {
+            ScanResultWriter writer;
+            writer.SetBounds(MakeRect(container.x, container.y, container.x + 100, container.y + 50));
+            payload = writer.Finish();
+        }
+        else {
+            // "Finds" the element when its runtime id ends in the request's x
+            ScanResultWriter writer;
+            const bool found = invoke.runtimeIdCount > 0 && invoke.runtimeIdCount <= SCAN_MAX_RUNTIME_ID &&
+                invoke.runtimeId[invoke.runtimeIdCount - 1] == invoke.x;
+            writer.SetStatus(found ? STATUS_OK : STATUS_NOT_INVOKED);
+            payload = writer.Finish();
+        }
+        while (!channel.Write(SCAN_RESPONSES, SCAN_RECORD_RESULT, sequence, payload.data(), (uint32_t)payload.size())) {
+            std::this_thread::yield();
+        }
+        ++answered;
+    }
+}
+
+static bool CheckScanResult(const ScanResultView& view, uint32_t sequence, uint64_t window) {
+    if (view.Count() != TargetCount(sequence) || view.Status() != STATUS_OK) return false;
+    if (view.SetupUs() != sequence || view.FindUs() != sequence * 2 || view.FilterUs() != sequence * 3) return false;
+    for (uint32_t i = 0; i < view.Count(); ++i) {
+        const ScanTargetRecord& r = view.Target(i);
+        if (r.left != (int)i || r.top != -(int)i || r.right != (int)i + 10 || r.bottom != 5) return false;
+        if (r.controlType != 50000 + (int)(i % 40)) return false;
+        if (r.runtimeIdCount != 1 + i % 3 || view.RuntimeId(i)[0] != 42) return false;
+        if (r.runtimeIdCount > 2 && (view.RuntimeId(i)[1] != (int32_t)sequence || view.RuntimeId(i)[2] != (int32_t)i)) return false;
+        if (r.nameLength != i % 7 || r.automationIdLength != i % 3) return false;
+        if (r.nameLength > 4 && view.Name(i)[4] != '0' + i % 10) return false;
+        if (r.nameLength > 5 && view.Name(i)[5] != (uint16_t)window) return false;
+        if (r.automationIdLength > 1 && view.AutomationId(i)[1] != 'd') return false;
+    }
+    return true;
+}
+
+static void TestRoundTrip() {
+    // Response ring smaller than a few results, so records keep wrapping and padding
+    const uint32_t requestCapacity = 512, responseCapacity = 16 * 1024;
+    ChannelMemory memory(ScanChannel::RequiredBytes(requestCapacity, responseCapacity));
+    ScanChannel app = ScanChannel::Create(memory.Base(), memory.bytes, requestCapacity, responseCapacity);
+    ScanChannel worker = ScanChannel::Attach(memory.Base(), memory.bytes);
+    CHECK(app.Valid());
+    CHECK(worker.Valid());
+    CHECK_EQ(app.Capacity(SCAN_RESPONSES), responseCapacity);
+    if (!app.Valid() || !worker.Valid()) return;
+
+    std::thread thread(StandInWorker, worker, ROUND_TRIPS);
+    int wrong = 0, misaligned = 0;
+    for (uint32_t sequence = 1; sequence <= ROUND_TRIPS; ++sequence) {
+        // Garbage the worker must skip without answering
+        if (sequence % 50 == 0) {
+            const uint8_t junk[3] = { 1, 2, 3 };
+            while (!app.Write(SCAN_REQUESTS, 99, 0, junk, sizeof(junk))) std::this_thread::yield();
+            while (!app.Write(SCAN_REQUESTS, SCAN_RECORD_REQUEST, 0, junk, sizeof(junk))) std::this_thread::yield();
+        }
+
+        const uint32_t kind = sequence % 3;
+        bool written = false;
+        while (!written) {
+            if (kind == 0) {
+                const ScanRequestPayload request = { (uint64_t)sequence * 7 };
+                written = app.Write(SCAN_REQUESTS, SCAN_RECORD_REQUEST, sequence, &request, sizeof(request));
+            }
+            else if (kind == 1) {
+                const ScanContainerRequestPayload request = { (int32_t)sequence, -(int32_t)sequence };
+                written = app.Write(SCAN_REQUESTS, SCAN_RECORD_CONTAINER_REQUEST, sequence, &request, sizeof(request));
+            }
+            else {
+                ScanInvokeRequestPayload request = {};
+                request.x = (int32_t)(sequence % 5);
+                request.runtimeIdCount = 1 + sequence % SCAN_MAX_RUNTIME_ID;
+                request.runtimeId[request.runtimeIdCount - 1] = (int32_t)(sequence % 4);
+                written = app.Write(SCAN_REQUESTS, SCAN_RECORD_INVOKE_REQUEST, sequence, &request, sizeof(request));
+            }
+            if (!written) std::this_thread::yield();
+        }
+
+        ScanRecordView record;
+        while (!app.Peek(SCAN_RESPONSES, record)) std::this_thread::yield();
+        if (((uintptr_t)record.payload & 7) != 0) ++misaligned;
+
+        ScanResultView view;
+        bool ok = record.type == SCAN_RECORD_RESULT && record.sequence == sequence && view.Parse(record.payload, record.size);
+        if (ok && kind == 0) ok = CheckScanResult(view, sequence, (uint64_t)sequence * 7);
+        if (ok && kind == 1) {
+            const Rect bounds = view.Bounds();
+            ok = view.Count() == 0 && bounds.left == (int)sequence && bounds.top == -(int)sequence &&
+                bounds.Width() == 100 && bounds.Height() == 50;
+        }
+        if (ok && kind == 2) {
+            ok = view.Count() == 0 && view.Status() == (sequence % 5 == sequence % 4 ? STATUS_OK : STATUS_NOT_INVOKED);
+        }
+        if (!ok) ++wrong;
+        app.Consume(SCAN_RESPONSES, record);
+    }
+    thread.join();
+    CHECK_EQ(wrong, 0);
+    CHECK_EQ(misaligned, 0);
+
+    // Everything was answered exactly once
+    ScanRecordView extra;
+    CHECK(!app.Peek(SCAN_RESPONSES, extra));
+    CHECK(!worker.Peek(SCAN_REQUESTS, extra));
+}
+
+static std::vector<uint8_t> Bytes(uint32_t size, uint8_t seed) {
+    std::vector<uint8_t> bytes(size);
+    for (uint32_t i = 0; i < size; ++i) bytes[i] = (uint8_t)(seed + i);
+    return bytes;
+}
+
+static bool PeekMatches(ScanChannel& channel, uint32_t type, uint32_t sequence, const std::vector<uint8_t>& payload) {
+    ScanRecordView record;
+    if (!channel.Peek(SCAN_REQUESTS, record)) return false;
+    const bool same = record.type == type && record.sequence == sequence && record.size == payload.size() &&
+        (payload.empty() || !memcmp(record.payload, payload.data(), payload.size()));
+    channel.Consume(SCAN_REQUESTS, record);
+    return same;
+}
+
+static void TestWrapAndPad() {
+    // 256-byte request ring; a record is a 16-byte header plus the payload, rounded to 8
+    const uint32_t capacity = 256;
+    ChannelMemory memory(ScanChannel::RequiredBytes(capacity, 64));
+    ScanChannel channel = ScanChannel::Create(memory.Base(), memory.bytes, capacity, 64);
+    CHECK(channel.Valid());
+    if (!channel.Valid()) return;
+
+    // Too big for the ring ever; exactly the ring fits once it's empty
+    CHECK(!channel.Write(SCAN_REQUESTS, 1, 1, Bytes(capacity, 0).data(), capacity));
+    const std::vector<uint8_t> whole = Bytes(capacity - 16, 1);
+    CHECK(channel.Write(SCAN_REQUESTS, 1, 1, whole.data(), (uint32_t)whole.size()));
+    CHECK(!channel.Write(SCAN_REQUESTS, 1, 2, nullptr, 0));   // full
+    CHECK(PeekMatches(channel, 1, 1, whole));
+
+    // At offset 256 (= 0): 200 bytes used, 56 left; a 64-byte record pads the 56 with a
+    // pad record and lands at the start
+    const std::vector<uint8_t> first = Bytes(184, 2), second = Bytes(48, 3);
+    CHECK(channel.Write(SCAN_REQUESTS, 1, 2, first.data(), (uint32_t)first.size()));
+    CHECK(!channel.Write(SCAN_REQUESTS, 1, 3, second.data(), (uint32_t)second.size()));   // pad + record don't fit yet
+    CHECK(PeekMatches(channel, 1, 2, first));
+    CHECK(channel.Write(SCAN_REQUESTS, 1, 3, second.data(), (uint32_t)second.size()));
+    CHECK(PeekMatches(channel, 1, 3, second));
+
+    // Now at 64: leave 8 bytes at the end, shorter than a header, so no pad record is
+    // written and the reader must skip them on its own
+    const std::vector<uint8_t> third = Bytes(168, 4), fourth = Bytes(5, 5);
+    CHECK(channel.Write(SCAN_REQUESTS, 2, 4, third.data(), (uint32_t)third.size()));
+    CHECK(channel.Write(SCAN_REQUESTS, 2, 5, fourth.data(), (uint32_t)fourth.size()));
+    CHECK(PeekMatches(channel, 2, 4, third));
+    CHECK(PeekMatches(channel, 2, 5, fourth));
+
+    // Many odd sizes round and round: order and contents survive every wrap
+    int wrong = 0;
+    uint32_t written = 0, read = 0;
+    for (uint32_t step = 0; step < 4000; ++step) {
+        const uint32_t size = (step * 37) % 120;
+        if (channel.Write(SCAN_REQUESTS, 7, written, Bytes(size, (uint8_t)written).data(), size)) ++written;
+        if (step % 3 != 0) {
+            ScanRecordView record;
+            if (channel.Peek(SCAN_REQUESTS, record)) {
+                const std::vector<uint8_t> expected = Bytes(record.size, (uint8_t)read);
+                if (record.sequence != read || record.type != 7 ||
+                    (record.size && memcmp(record.payload, expected.data(), record.size))) ++wrong;
+                channel.Consume(SCAN_REQUESTS, record);
+                ++read;
+            }
+        }
+    }
+    CHECK_EQ(wrong, 0);
+    CHECK(written > 1000);
+
+    // Drain drops what's left
+    channel.Drain(SCAN_REQUESTS);
+    ScanRecordView record;
+    CHECK(!channel.Peek(SCAN_REQUESTS, record));
+    CHECK(channel.Write(SCAN_REQUESTS, 1, 9, nullptr, 0));
+    CHECK(PeekMatches(channel, 1, 9, std::vector<uint8_t>()));
+}
+
+static void TestCorruptPayloads() {
+    const uint16_t text[4] = { 'a', 'b', 'c', 'd' };
+    const int32_t runtimeId[2] = { 7, 8 };
+    ScanResultWriter writer;
+    writer.Add(MakeRect(0, 0, 1, 1), 1, runtimeId, 2, text, 3, text, 1);
+    writer.Add(MakeRect(1, 1, 2, 2), 2, runtimeId, 1, text, 4, text, 0);
+    const std::vector<uint8_t> good = writer.Finish();
+
+    ScanResultView view;
+    CHECK(view.Parse(good.data(), (uint32_t)good.size()));
+    CHECK_EQ(view.Count(), 2);
+    CHECK(!view.Parse(nullptr, 0));
+    CHECK_EQ(view.Count(), 0);   // a failed parse leaves nothing to read
+    CHECK(!view.Parse(good.data(), sizeof(ScanResultHeader) - 1));
+
+    // Every truncation and one extra byte
+    int accepted = 0;
+    for (uint32_t size = 0; size < good.size(); ++size) {
+        if (view.Parse(good.data(), size)) ++accepted;
+    }
+    CHECK_EQ(accepted, 0);
+    std::vector<uint8_t> longer(good);
+    longer.push_back(0);
+    CHECK(!view.Parse(longer.data(), (uint32_t)longer.size()));
+
+    // Header counts that disagree with the size, including ones that overflow 32 bits
+    const size_t countField = offsetof(ScanResultHeader, count);
+    const size_t idsField = offsetof(ScanResultHeader, runtimeIdInts);
+    const size_t textField = offsetof(ScanResultHeader, textUnits);
+    const uint32_t badCounts[] = { 9, 0xFFFFFFFFu, 0x80000000u };
+    for (size_t field : { countField, idsField, textField }) {
+        for (uint32_t value : badCounts) {
+            std::vector<uint8_t> bad(good);
+            memcpy(bad.data() + field, &value, sizeof(value));
+            CHECK(!view.Parse(bad.data(), (uint32_t)bad.size()));
+        }
+    }
+
+    // Records pointing outside their pools
+    const size_t recordsAt = sizeof(ScanResultHeader);
+    const size_t fields[] = {
+        offsetof(ScanTargetRecord, runtimeIdStart), offsetof(ScanTargetRecord, runtimeIdCount),
+        offsetof(ScanTargetRecord, nameStart), offsetof(ScanTargetRecord, nameLength),
+        offsetof(ScanTargetRecord, automationIdStart), offsetof(ScanTargetRecord, automationIdLength),
+    };
+    const uint32_t badIndices[] = { 9, 0xFFFFFFFFu, 0xFFFFFFF0u };
+    for (int record = 0; record < 2; ++record) {
+        for (size_t field : fields) {
+            for (uint32_t value : badIndices) {
+                std::vector<uint8_t> bad(good);
+                memcpy(bad.data() + recordsAt + record * sizeof(ScanTargetRecord) + field, &value, sizeof(value));
+                CHECK(!view.Parse(bad.data(), (uint32_t)bad.size()));
+            }
+        }
+    }
+    CHECK(view.Parse(good.data(), (uint32_t)good.size()));
+
+    // A record header in the ring that claims more than was written, or more than the ring
+    const uint32_t capacity = 256;
+    ChannelMemory memory(ScanChannel::RequiredBytes(capacity, 64));
+    ScanChannel channel = ScanChannel::Create(memory.Base(), memory.bytes, capacity, 64);
+    CHECK(channel.Write(SCAN_REQUESTS, 1, 1, good.data(), 24));
+    ScanRecordView record;
+    CHECK(channel.Peek(SCAN_REQUESTS, record));
+    uint8_t* header = const_cast<uint8_t*>(record.payload) - sizeof(ScanRecordHeader);
+    const uint32_t claims[] = { 32, 1u << 30, 0xFFFFFFF8u };
+    for (uint32_t size : claims) {
+        memcpy(header + offsetof(ScanRecordHeader, size), &size, sizeof(size));
+        CHECK(!channel.Peek(SCAN_REQUESTS, record));
+    }
+}
+
+// First 32-bit word in the header area equal to value, so the test doesn't hard-code
+// the header's layout
+static uint32_t* FindWord(void* memory, uint32_t value) {
+    uint32_t* words = static_cast<uint32_t*>(memory);
+    for (int i = 0; i < 256; ++i) {
+        if (words[i] == value) return &words[i];
+    }
+    return nullptr;
+}
+
+static void TestAttach() {
+    // Distinctive capacities so their fields can be found
+    const uint32_t requestCapacity = 1096, responseCapacity = 2056;
+    const size_t bytes = ScanChannel::RequiredBytes(requestCapacity, responseCapacity);
+    ChannelMemory memory(bytes);
+    void* base = memory.Base();
+
+    CHECK(!ScanChannel::Attach(nullptr, bytes).Valid());
+    CHECK(!ScanChannel::Attach(base, bytes).Valid());            // all zero: no magic
+    CHECK(!ScanChannel::Create(base, bytes, 32, responseCapacity).Valid());
+    CHECK(!ScanChannel::Create(base, bytes - 1, requestCapacity, responseCapacity).Valid());
+    CHECK(!ScanChannel::Create(nullptr, bytes, requestCapacity, responseCapacity).Valid());
+
+    const std::vector<uint8_t> pristine = [&]() {
+        CHECK(ScanChannel::Create(base, bytes, requestCapacity, responseCapacity).Valid());
+        const uint8_t* p = static_cast<const uint8_t*>(base);
+        return std::vector<uint8_t>(p, p + bytes);
+    }();
+    auto restore = [&]() { memcpy(base, pristine.data(), bytes); };
+
+    CHECK(ScanChannel::Attach(base, bytes).Valid());
+    CHECK(!ScanChannel::Attach(base, 16).Valid());              // shorter than the header
+    CHECK(!ScanChannel::Attach(base, bytes - 64).Valid());      // response ring runs past the end
+
+    // The header starts with the magic and then the version
+    uint32_t* words = static_cast<uint32_t*>(base);
+    words[0] ^= 1;
+    CHECK(!ScanChannel::Attach(base, bytes).Valid());
+    restore();
+    words[1] += 1;
+    CHECK(!ScanChannel::Attach(base, bytes).Valid());
+    restore();
+
+    // Capacities too small or not a multiple of 8, and data offsets past the block
+    const uint32_t capacities[] = { requestCapacity, responseCapacity };
+    for (uint32_t capacity : capacities) {
+        uint32_t* field = FindWord(base, capacity);
+        CHECK(field != nullptr);
+        if (!field) continue;
+        const uint32_t badCapacities[] = { 0, 56, capacity + 4 };
+        for (uint32_t value : badCapacities) {
+            *field = value;
+            CHECK(!ScanChannel::Attach(base, bytes).Valid());
+            restore();
+        }
+        // The data offset follows the capacity
+        const uint32_t badOffsets[] = { (uint32_t)bytes, 0xFFFFFFF0u };
+        for (uint32_t value : badOffsets) {
+            field[1] = value;
+            CHECK(!ScanChannel::Attach(base, bytes).Valid());
+            restore();
+        }
+    }
+    CHECK(ScanChannel::Attach(base, bytes).Valid());
+}
+
+int main() {
+    TestWrapAndPad();
+    TestCorruptPayloads();
+    TestAttach();
+    TestRoundTrip();
+    return test::TestExitCode("ScanIpcTest");
+}
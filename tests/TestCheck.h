@@ -0,0 +1,42 @@
+// TestCheck.h
+#pragma once
+
+#include <cstdio>
+
+// Checks for the core tests: a failed CHECK prints where it is and the test carries on,
+// so one run shows every failure; main returns TestExitCode().
+namespace test {
+
+    inline int& FailureCount() {
+        static int count = 0;
+        return count;
+    }
+
+    inline int TestExitCode(const char* name) {
+        if (FailureCount()) {
+            std::fprintf(stderr, "%s: %d check(s) failed\n", name, FailureCount());
+            return 1;
+        }
+        std::printf("%s: ok\n", name);
+        return 0;
+    }
+
+}
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            ++test::FailureCount(); \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        const long long checkA = (long long)(a), checkB = (long long)(b); \
+        if (checkA != checkB) { \
+            ++test::FailureCount(); \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+                __FILE__, __LINE__, #a, #b, checkA, checkB); \
+        } \
+    } while (0)
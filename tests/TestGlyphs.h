@@ -0,0 +1,42 @@
+// TestGlyphs.h
+#pragma once
+
+#include "LabelRasterizer.h"
+
+namespace test {
+
+    // A-Z atlas with made-up glyphs standing in for GDI's: each is a box outline with an
+    // anti-aliased stroke whose slope depends on the letter, so labels differ visibly and
+    // every coverage level from 0 to 255 turns up. Same bytes on every platform.
+    inline hint_map::GlyphAtlas SyntheticAtlas(int pixelSize) {
+        hint_map::GlyphAtlas atlas;
+        atlas.first = L'A';
+        atlas.ascent = pixelSize;
+        atlas.lineHeight = pixelSize + pixelSize / 3;
+        const int width = (pixelSize * 2) / 3;
+        for (int letter = 0; letter < 26; ++letter) {
+            hint_map::GlyphMask g;
+            g.width = width;
+            g.height = pixelSize;
+            g.offsetX = 1;
+            g.offsetY = -pixelSize;
+            g.advance = width + 2;
+            g.coverage.resize((size_t)g.width * g.height);
+            for (int y = 0; y < g.height; ++y) {
+                for (int x = 0; x < g.width; ++x) {
+                    int value = 0;
+                    if (x == 0 || y == 0 || x == g.width - 1 || y == g.height - 1) value = (letter & 1) ? 255 : 160;
+                    // Stroke from the bottom-left corner, slope (letter + 1) / 8
+                    const int distance = y * 8 - (g.height - 1) * 8 + x * (letter + 1);
+                    const int a = distance < 0 ? -distance : distance;
+                    const int stroke = a >= 16 ? 0 : 255 - a * 16;
+                    if (stroke > value) value = stroke;
+                    g.coverage[(size_t)y * g.width + x] = (uint8_t)value;
+                }
+            }
+            atlas.glyphs.push_back(g);
+        }
+        return atlas;
+    }
+
+}
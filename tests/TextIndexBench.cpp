@@ -0,0 +1,137 @@
+// TextIndexBench.cpp
+//
+// Text-mode index on fixtures/text_large.txt (about 300 KB of code, prose and tables):
+// Build over the whole file and over it repeated to a few MB, then what an activation
+// actually does — Build one visible range of about 4K characters and lay its stops out
+// against the provider's line rects, both one rect per line and soft-wrapped. A copy with
+// accented and CJK letters swapped in checks the non-ASCII path costs the same.
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Bench.h"
+#include "Fixtures.h"
+#include "TextIndex.h"
+
+using namespace hint_map;
+
+static const size_t VISIBLE_RANGE = 4096;
+static const int LINE_HEIGHT = 18;
+
+// Visible ranges cut at line starts, about VISIBLE_RANGE characters each
+static std::vector<std::wstring> SplitRanges(const std::wstring& text) {
+    std::vector<std::wstring> ranges;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = (std::min)(start + VISIBLE_RANGE, text.size());
+        const size_t brk = text.rfind(L'\n', end);
+        if (end < text.size() && brk != std::wstring::npos && brk > start) end = brk + 1;
+        ranges.push_back(text.substr(start, end - start));
+        start = end;
+    }
+    return ranges;
+}
+
+// Reference-font widths: wide for CJK, nothing for line breaks
+static std::vector<int> Advances(const std::wstring& text) {
+    std::vector<int> advance(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        const wchar_t c = text[i];
+        advance[i] = c == L'\n' || c == L'\r' ? 0 : c >= 0x3000 ? 16 : c == L'\t' ? 32 : 8;
+    }
+    return advance;
+}
+
+// One rect per line, as wide as the line, or (wrapWidth > 0) the text wrapped into
+// rects of that width
+static std::vector<Rect> LineRects(const TextIndex& index, const std::vector<int>& advance, int wrapWidth) {
+    std::vector<Rect> rects;
+    int y = 0;
+    for (int line = 0; line < index.LineCount(); ++line) {
+        int width = 0;
+        for (int i = index.LineStart(line); i < index.LineEnd(line); ++i) width += advance[i];
+        if (wrapWidth <= 0) {
+            rects.push_back(MakeRect(0, y, width, y + LINE_HEIGHT));
+            y += LINE_HEIGHT;
+            continue;
+        }
+        do {
+            rects.push_back(MakeRect(0, y, (std::min)(width, wrapWidth), y + LINE_HEIGHT));
+            y += LINE_HEIGHT;
+            width -= wrapWidth;
+        } while (width > 0);
+    }
+    return rects;
+}
+
+// Prose vowels accented and some identifiers in CJK, same length as the original
+static std::wstring Localised(const std::wstring& text) {
+    std::wstring out(text);
+    for (size_t i = 0; i < out.size(); ++i) {
+        if (out[i] == L'e') out[i] = 0x00E9;
+        else if (out[i] == L'o') out[i] = 0x00F6;
+        else if (out[i] == L'x' || out[i] == L'z') out[i] = 0x6587;
+        else if (out[i] == L'q') out[i] = 0x5B57;
+    }
+    return out;
+}
+
+static void RunText(const bench::Options& options, const char* name, const std::wstring& text) {
+    char what[96];
+    TextIndex index;
+    double ms = bench::BestMs(options, [&]() { index.Build(text.data(), text.size()); });
+    std::snprintf(what, sizeof(what), "Build %s (%d KB)", name, (int)(text.size() / 1024));
+    bench::Report(what, ms);
+    bench::Keep(index.Stops().size());
+
+    std::wstring repeated;
+    while (repeated.size() < (4u << 20)) repeated += text;
+    ms = bench::BestMs(options, [&]() { index.Build(repeated.data(), repeated.size()); });
+    std::snprintf(what, sizeof(what), "Build %s x%d (%d KB)", name, (int)(repeated.size() / text.size()),
+        (int)(repeated.size() / 1024));
+    bench::Report(what, ms);
+    bench::Keep(index.Stops().size());
+
+    // Every visible range in the file, per range: one activation's worth of work
+    const std::vector<std::wstring> ranges = SplitRanges(text);
+    std::vector<std::vector<int>> advances;
+    for (const std::wstring& range : ranges) advances.push_back(Advances(range));
+    const double perRange = 1.0 / (double)ranges.size();
+
+    ms = bench::BestMs(options, [&]() {
+        for (const std::wstring& range : ranges) {
+            index.Build(range.data(), range.size());
+            bench::Keep(index.Stops().size());
+        }
+    });
+    std::snprintf(what, sizeof(what), "  Build visible range (%d ranges)", (int)ranges.size());
+    bench::Report(what, ms * perRange);
+
+    const int wraps[] = { 0, 480 };
+    for (int wrap : wraps) {
+        std::vector<TextIndex> indexes(ranges.size());
+        std::vector<std::vector<Rect>> rects(ranges.size());
+        for (size_t r = 0; r < ranges.size(); ++r) {
+            indexes[r].Build(ranges[r].data(), ranges[r].size());
+            rects[r] = LineRects(indexes[r], advances[r], wrap);
+        }
+        ms = bench::BestMs(options, [&]() {
+            for (size_t r = 0; r < ranges.size(); ++r) {
+                bench::Keep(LayoutTextStops(indexes[r], rects[r], advances[r]).size());
+            }
+        });
+        std::snprintf(what, sizeof(what), wrap ? "  LayoutTextStops wrapped at %d px" : "  LayoutTextStops one rect per line",
+            wrap);
+        bench::Report(what, ms * perRange);
+    }
+}
+
+int main(int argc, char** argv) {
+    const bench::Options options = bench::ParseOptions(argc, argv);
+    std::wstring text;
+    if (!test::ReadFixtureText("text_large.txt", text) || text.empty()) return 1;
+    RunText(options, "text_large.txt", text);
+    RunText(options, "text_large.txt localised", Localised(text));
+    return 0;
+}